@@ -1,19 +1,27 @@
+#include "a_cache.hpp"
 #include "bench_helper.hpp"
+#include "dispatch.hpp"
 #include "efrodo1344_kem.hpp"
 #include "efrodo640_kem.hpp"
 #include "efrodo976_kem.hpp"
+#include "frodo1344_aes_kem.hpp"
 #include "frodo1344_kem.hpp"
+#include "frodo640_aes_kem.hpp"
 #include "frodo640_kem.hpp"
+#include "frodo976_aes_kem.hpp"
 #include "frodo976_kem.hpp"
+#include "gen_a.hpp"
 #include "prng.hpp"
 #include <benchmark/benchmark.h>
 #include <cassert>
+#include <string>
+#include <string_view>
 
 namespace utils = frodo_utils;
 
 // Benchmark execution of Frodo key generation algorithm, for some specific
 // parameter set.
-template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t B, size_t D>
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
 inline void
 keygen(benchmark::State& state)
 {
@@ -42,7 +50,7 @@ keygen(benchmark::State& state)
   prng.read(_z);
 
   for (auto _ : state) {
-    kem::keygen<n, n̄, lsec, lSE, lA, B, D>(_s, _seedSE, _z, _pkey, _skey);
+    kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
 
     benchmark::DoNotOptimize(_s);
     benchmark::DoNotOptimize(_seedSE);
@@ -55,9 +63,40 @@ keygen(benchmark::State& state)
   state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark execution of Frodo key generation algorithm, generating 4
+// independent keypairs per call, in lockstep, for some specific parameter set.
+// Reported items are keypairs.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+keygen_x4(benchmark::State& state)
+{
+  constexpr size_t count = 4;
+
+  std::vector<kem::keygen_input_t<lsec, lSE, lA>> inputs(count);
+  std::vector<kem::keypair_t<n, n̄, lsec, lA, D>> keypairs(count);
+
+  prng::prng_t prng;
+
+  for (auto& input : inputs) {
+    prng.read(input.s);
+    prng.read(input.seedSE);
+    prng.read(input.z);
+  }
+
+  for (auto _ : state) {
+    kem::keygen_x4<n, n̄, lsec, lSE, lA, B, D, prg>(std::span<const kem::keygen_input_t<lsec, lSE, lA>, count>(inputs), std::span<kem::keypair_t<n, n̄, lsec, lA, D>, count>(keypairs));
+
+    benchmark::DoNotOptimize(inputs);
+    benchmark::DoNotOptimize(keypairs);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
 // Benchmark execution of Frodo encapsulation algorithm, for some specific
 // parameter set.
-template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D>
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
 inline void
 encaps(benchmark::State& state)
 {
@@ -97,13 +136,13 @@ encaps(benchmark::State& state)
   prng.read(_seedSE);
   prng.read(_z);
 
-  kem::keygen<n, n̄, lsec, lSE, lA, B, D>(_s, _seedSE, _z, _pkey, _skey);
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
 
   prng.read(_μ);
   prng.read(_salt);
 
   for (auto _ : state) {
-    kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D>(_μ, _salt, _pkey, _enc, _ss);
+    kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(_μ, _salt, _pkey, _enc, _ss);
 
     benchmark::DoNotOptimize(_μ);
     benchmark::DoNotOptimize(_salt);
@@ -116,9 +155,175 @@ encaps(benchmark::State& state)
   state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark execution of Frodo encapsulation algorithm, using a public key,
+// which is prepared only once, before the benchmark loop, for some specific
+// parameter set. When `cached` is set, rows of matrix A are read from process
+// -wide cache of expanded matrices A, instead of being generated.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128, bool cached = false>
+inline void
+encaps_prepared(benchmark::State& state)
+{
+  constexpr size_t S_LEN = lsec / 8;
+  constexpr size_t SEED_SE_LEN = lSE / 8;
+  constexpr size_t Z_LEN = lA / 8;
+  constexpr size_t PK_LEN = utils::kem_pub_key_len(n, n̄, lA, D);
+  constexpr size_t SK_LEN = utils::kem_sec_key_len(n, n̄, lsec, lA, D);
+  constexpr size_t μ_LEN = lsec / 8;
+  constexpr size_t SALT_LEN = lsalt / 8;
+  constexpr size_t CT_LEN = utils::kem_cipher_text_len(n, n̄, lsalt, D);
+  constexpr size_t SS_LEN = lsec / 8;
+
+  std::vector<uint8_t> s(S_LEN, 0);
+  std::vector<uint8_t> seedSE(SEED_SE_LEN, 0);
+  std::vector<uint8_t> z(Z_LEN, 0);
+  std::vector<uint8_t> pkey(PK_LEN, 0);
+  std::vector<uint8_t> skey(SK_LEN, 0);
+  std::vector<uint8_t> μ(μ_LEN, 0);
+  std::vector<uint8_t> salt(SALT_LEN, 0);
+  std::vector<uint8_t> enc(CT_LEN, 0);
+  std::vector<uint8_t> ss(SS_LEN, 0);
+
+  std::span<uint8_t, S_LEN> _s{ s };
+  std::span<uint8_t, SEED_SE_LEN> _seedSE{ seedSE };
+  std::span<uint8_t, Z_LEN> _z{ z };
+  std::span<uint8_t, PK_LEN> _pkey{ pkey };
+  std::span<uint8_t, SK_LEN> _skey{ skey };
+  std::span<uint8_t, μ_LEN> _μ{ μ };
+  std::span<uint8_t, SALT_LEN> _salt{ salt };
+  std::span<uint8_t, CT_LEN> _enc{ enc };
+  std::span<uint8_t, SS_LEN> _ss{ ss };
+
+  prng::prng_t prng;
+
+  prng.read(_s);
+  prng.read(_seedSE);
+  prng.read(_z);
+
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  using prepared_public_key = kem::prepared_public_key<n, n̄, lsec, lA, D, prg>;
+  const auto ppk = [&]() {
+    if constexpr (cached) {
+      return prepared_public_key(_pkey, a_cache::global());
+    } else {
+      return prepared_public_key(_pkey);
+    }
+  }();
+
+  prng.read(_μ);
+  prng.read(_salt);
+
+  for (auto _ : state) {
+    kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(_μ, _salt, ppk, _enc, _ss);
+
+    benchmark::DoNotOptimize(_μ);
+    benchmark::DoNotOptimize(_salt);
+    benchmark::DoNotOptimize(_enc);
+    benchmark::DoNotOptimize(_ss);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark execution of Frodo batched encapsulation algorithm, encapsulating
+// `count` -many inputs to a prepared public key, in a single pass over matrix A,
+// for some specific parameter set. Reported items are encapsulations.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, size_t count, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps_batch(benchmark::State& state)
+{
+  constexpr size_t S_LEN = lsec / 8;
+  constexpr size_t SEED_SE_LEN = lSE / 8;
+  constexpr size_t Z_LEN = lA / 8;
+  constexpr size_t PK_LEN = utils::kem_pub_key_len(n, n̄, lA, D);
+  constexpr size_t SK_LEN = utils::kem_sec_key_len(n, n̄, lsec, lA, D);
+
+  std::vector<uint8_t> s(S_LEN, 0);
+  std::vector<uint8_t> seedSE(SEED_SE_LEN, 0);
+  std::vector<uint8_t> z(Z_LEN, 0);
+  std::vector<uint8_t> pkey(PK_LEN, 0);
+  std::vector<uint8_t> skey(SK_LEN, 0);
+
+  std::span<uint8_t, S_LEN> _s{ s };
+  std::span<uint8_t, SEED_SE_LEN> _seedSE{ seedSE };
+  std::span<uint8_t, Z_LEN> _z{ z };
+  std::span<uint8_t, PK_LEN> _pkey{ pkey };
+  std::span<uint8_t, SK_LEN> _skey{ skey };
+
+  prng::prng_t prng;
+
+  prng.read(_s);
+  prng.read(_seedSE);
+  prng.read(_z);
+
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  const kem::prepared_public_key<n, n̄, lsec, lA, D, prg> ppk(_pkey);
+
+  std::vector<kem::encaps_input_t<lsec, lsalt>> inputs(count);
+  std::vector<kem::encaps_output_t<n, n̄, lsec, lsalt, D>> outputs(count);
+
+  for (auto& input : inputs) {
+    prng.read(input.μ);
+    prng.read(input.salt);
+  }
+
+  for (auto _ : state) {
+    kem::batch_encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(ppk, std::span<const kem::encaps_input_t<lsec, lsalt>>(inputs), std::span(outputs));
+
+    benchmark::DoNotOptimize(inputs);
+    benchmark::DoNotOptimize(outputs);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Benchmark execution of Frodo encapsulation algorithm, encapsulating to 4
+// distinct public keys per call, in lockstep, for some specific parameter set.
+// Reported items are encapsulations.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps_x4(benchmark::State& state)
+{
+  constexpr size_t count = 4;
+  constexpr size_t PK_LEN = utils::kem_pub_key_len(n, n̄, lA, D);
+
+  std::vector<kem::keygen_input_t<lsec, lSE, lA>> seeds(count);
+  std::vector<kem::keypair_t<n, n̄, lsec, lA, D>> keypairs(count);
+  std::vector<std::span<const uint8_t, PK_LEN>> pkeys{};
+  std::vector<kem::encaps_input_t<lsec, lsalt>> inputs(count);
+  std::vector<kem::encaps_output_t<n, n̄, lsec, lsalt, D>> outputs(count);
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < count; i++) {
+    prng.read(seeds[i].s);
+    prng.read(seeds[i].seedSE);
+    prng.read(seeds[i].z);
+
+    kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(seeds[i].s, seeds[i].seedSE, seeds[i].z, keypairs[i].pkey, keypairs[i].skey);
+    pkeys.emplace_back(keypairs[i].pkey);
+
+    prng.read(inputs[i].μ);
+    prng.read(inputs[i].salt);
+  }
+
+  for (auto _ : state) {
+    kem::encaps_x4<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(std::span<const std::span<const uint8_t, PK_LEN>, count>(pkeys),
+                                                           std::span<const kem::encaps_input_t<lsec, lsalt>, count>(inputs),
+                                                           std::span<kem::encaps_output_t<n, n̄, lsec, lsalt, D>, count>(outputs));
+
+    benchmark::DoNotOptimize(inputs);
+    benchmark::DoNotOptimize(outputs);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
 // Benchmark execution of Frodo KEM decapsulation algorithm, for some specific
 // parameter set.
-template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D>
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
 inline void
 decaps(benchmark::State& state)
 {
@@ -162,11 +367,11 @@ decaps(benchmark::State& state)
   prng.read(_μ);
   prng.read(_salt);
 
-  kem::keygen<n, n̄, lsec, lSE, lA, B, D>(_s, _seedSE, _z, _pkey, _skey);
-  kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D>(_μ, _salt, _pkey, _enc, _ss0);
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(_μ, _salt, _pkey, _enc, _ss0);
 
   for (auto _ : state) {
-    kem::decaps<n, n̄, lsec, lSE, lA, lsalt, B, D>(_skey, _enc, _ss1);
+    kem::decaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(_skey, _enc, _ss1);
 
     benchmark::DoNotOptimize(_skey);
     benchmark::DoNotOptimize(_enc);
@@ -180,10 +385,156 @@ decaps(benchmark::State& state)
   state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark execution of Frodo KEM decapsulation algorithm, using a secret key,
+// which is prepared only once, before the benchmark loop, for some specific
+// parameter set. When `cached` is set, rows of matrix A are read from process
+// -wide cache of expanded matrices A, instead of being generated.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128, bool cached = false>
+inline void
+decaps_prepared(benchmark::State& state)
+{
+  constexpr size_t S_LEN = lsec / 8;
+  constexpr size_t SEED_SE_LEN = lSE / 8;
+  constexpr size_t Z_LEN = lA / 8;
+  constexpr size_t PK_LEN = utils::kem_pub_key_len(n, n̄, lA, D);
+  constexpr size_t SK_LEN = utils::kem_sec_key_len(n, n̄, lsec, lA, D);
+  constexpr size_t μ_LEN = lsec / 8;
+  constexpr size_t SALT_LEN = lsalt / 8;
+  constexpr size_t CT_LEN = utils::kem_cipher_text_len(n, n̄, lsalt, D);
+  constexpr size_t SS_LEN = lsec / 8;
+
+  std::vector<uint8_t> s(S_LEN, 0);
+  std::vector<uint8_t> seedSE(SEED_SE_LEN, 0);
+  std::vector<uint8_t> z(Z_LEN, 0);
+  std::vector<uint8_t> pkey(PK_LEN, 0);
+  std::vector<uint8_t> skey(SK_LEN, 0);
+  std::vector<uint8_t> μ(μ_LEN, 0);
+  std::vector<uint8_t> salt(SALT_LEN, 0);
+  std::vector<uint8_t> enc(CT_LEN, 0);
+  std::vector<uint8_t> ss0(SS_LEN, 0);
+  std::vector<uint8_t> ss1(SS_LEN, 0);
+
+  std::span<uint8_t, S_LEN> _s{ s };
+  std::span<uint8_t, SEED_SE_LEN> _seedSE{ seedSE };
+  std::span<uint8_t, Z_LEN> _z{ z };
+  std::span<uint8_t, PK_LEN> _pkey{ pkey };
+  std::span<uint8_t, SK_LEN> _skey{ skey };
+  std::span<uint8_t, μ_LEN> _μ{ μ };
+  std::span<uint8_t, SALT_LEN> _salt{ salt };
+  std::span<uint8_t, CT_LEN> _enc{ enc };
+  std::span<uint8_t, SS_LEN> _ss0{ ss0 };
+  std::span<uint8_t, SS_LEN> _ss1{ ss1 };
+
+  prng::prng_t prng;
+
+  prng.read(_s);
+  prng.read(_seedSE);
+  prng.read(_z);
+  prng.read(_μ);
+  prng.read(_salt);
+
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(_μ, _salt, _pkey, _enc, _ss0);
+  using prepared_secret_key = kem::prepared_secret_key<n, n̄, lsec, lA, D, prg>;
+  const auto psk = [&]() {
+    if constexpr (cached) {
+      return prepared_secret_key(_skey, a_cache::global());
+    } else {
+      return prepared_secret_key(_skey);
+    }
+  }();
+
+  for (auto _ : state) {
+    kem::decaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(psk, _enc, _ss1);
+
+    benchmark::DoNotOptimize(_enc);
+    benchmark::DoNotOptimize(_ss1);
+    benchmark::ClobberMemory();
+  }
+
+  // check if both parties arrived at same shared secret or not !
+  assert(std::ranges::equal(_ss0, ss1));
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark execution of Frodo batched decapsulation algorithm, decapsulating
+// `count` -many cipher texts using a prepared secret key, in a single pass over
+// matrix A, for some specific parameter set. Reported items are
+// decapsulations.
+template<size_t n, size_t n̄, size_t lsec, size_t lSE, size_t lA, size_t lsalt, size_t B, size_t D, size_t count, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+decaps_batch(benchmark::State& state)
+{
+  constexpr size_t S_LEN = lsec / 8;
+  constexpr size_t SEED_SE_LEN = lSE / 8;
+  constexpr size_t Z_LEN = lA / 8;
+  constexpr size_t PK_LEN = utils::kem_pub_key_len(n, n̄, lA, D);
+  constexpr size_t SK_LEN = utils::kem_sec_key_len(n, n̄, lsec, lA, D);
+  constexpr size_t μ_LEN = lsec / 8;
+  constexpr size_t SALT_LEN = lsalt / 8;
+  constexpr size_t CT_LEN = utils::kem_cipher_text_len(n, n̄, lsalt, D);
+  constexpr size_t SS_LEN = lsec / 8;
+
+  std::vector<uint8_t> s(S_LEN, 0);
+  std::vector<uint8_t> seedSE(SEED_SE_LEN, 0);
+  std::vector<uint8_t> z(Z_LEN, 0);
+  std::vector<uint8_t> pkey(PK_LEN, 0);
+  std::vector<uint8_t> skey(SK_LEN, 0);
+
+  std::span<uint8_t, S_LEN> _s{ s };
+  std::span<uint8_t, SEED_SE_LEN> _seedSE{ seedSE };
+  std::span<uint8_t, Z_LEN> _z{ z };
+  std::span<uint8_t, PK_LEN> _pkey{ pkey };
+  std::span<uint8_t, SK_LEN> _skey{ skey };
+
+  prng::prng_t prng;
+
+  prng.read(_s);
+  prng.read(_seedSE);
+  prng.read(_z);
+
+  kem::keygen<n, n̄, lsec, lSE, lA, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  const kem::prepared_secret_key<n, n̄, lsec, lA, D, prg> psk(_skey);
+
+  std::vector<std::array<uint8_t, CT_LEN>> encs(count);
+  std::vector<std::array<uint8_t, SS_LEN>> sss0(count), sss1(count);
+
+  for (size_t i = 0; i < count; i++) {
+    std::array<uint8_t, μ_LEN> μ{};
+    std::array<uint8_t, SALT_LEN> salt{};
+
+    prng.read(μ);
+    prng.read(salt);
+
+    kem::encaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(μ, salt, _pkey, encs[i], sss0[i]);
+  }
+
+  std::vector<std::span<const uint8_t, CT_LEN>> _encs(encs.begin(), encs.end());
+  std::vector<std::span<uint8_t, SS_LEN>> _sss1(sss1.begin(), sss1.end());
+
+  for (auto _ : state) {
+    kem::batch_decaps<n, n̄, lsec, lSE, lA, lsalt, B, D, prg>(psk, _encs, _sss1);
+
+    benchmark::DoNotOptimize(encs);
+    benchmark::DoNotOptimize(sss1);
+    benchmark::ClobberMemory();
+  }
+
+  // check if both parties arrived at same shared secret or not !
+  assert(sss0 == sss1);
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
 BENCHMARK(keygen<frodo640_kem::n, frodo640_kem::n̄, frodo640_kem::len_sec, frodo640_kem::len_SE, frodo640_kem::len_A, frodo640_kem::B, frodo640_kem::D>)
   ->Name("frodo640-keygen")
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
+BENCHMARK(keygen_x4<frodo640_kem::n, frodo640_kem::n̄, frodo640_kem::len_sec, frodo640_kem::len_SE, frodo640_kem::len_A, frodo640_kem::B, frodo640_kem::D>)
+  ->Name("frodo640-keygen-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
 BENCHMARK(
   encaps<frodo640_kem::n, frodo640_kem::n̄, frodo640_kem::len_sec, frodo640_kem::len_SE, frodo640_kem::len_A, frodo640_kem::len_salt, frodo640_kem::B, frodo640_kem::D>)
   ->Name("frodo640-encaps")
@@ -195,10 +546,97 @@ BENCHMARK(
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
 
+BENCHMARK(encaps_prepared<frodo640_kem::n,
+                          frodo640_kem::n̄,
+                          frodo640_kem::len_sec,
+                          frodo640_kem::len_SE,
+                          frodo640_kem::len_A,
+                          frodo640_kem::len_salt,
+                          frodo640_kem::B,
+                          frodo640_kem::D>)
+  ->Name("frodo640-encaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_prepared<frodo640_kem::n,
+                          frodo640_kem::n̄,
+                          frodo640_kem::len_sec,
+                          frodo640_kem::len_SE,
+                          frodo640_kem::len_A,
+                          frodo640_kem::len_salt,
+                          frodo640_kem::B,
+                          frodo640_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo640-encaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_batch<frodo640_kem::n,
+                       frodo640_kem::n̄,
+                       frodo640_kem::len_sec,
+                       frodo640_kem::len_SE,
+                       frodo640_kem::len_A,
+                       frodo640_kem::len_salt,
+                       frodo640_kem::B,
+                       frodo640_kem::D,
+                       16>)
+  ->Name("frodo640-encaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_x4<frodo640_kem::n, frodo640_kem::n̄, frodo640_kem::len_sec, frodo640_kem::len_SE, frodo640_kem::len_A, frodo640_kem::len_salt, frodo640_kem::B, frodo640_kem::D>)
+  ->Name("frodo640-encaps-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo640_kem::n,
+                          frodo640_kem::n̄,
+                          frodo640_kem::len_sec,
+                          frodo640_kem::len_SE,
+                          frodo640_kem::len_A,
+                          frodo640_kem::len_salt,
+                          frodo640_kem::B,
+                          frodo640_kem::D>)
+  ->Name("frodo640-decaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo640_kem::n,
+                          frodo640_kem::n̄,
+                          frodo640_kem::len_sec,
+                          frodo640_kem::len_SE,
+                          frodo640_kem::len_A,
+                          frodo640_kem::len_salt,
+                          frodo640_kem::B,
+                          frodo640_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo640-decaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_batch<frodo640_kem::n,
+                       frodo640_kem::n̄,
+                       frodo640_kem::len_sec,
+                       frodo640_kem::len_SE,
+                       frodo640_kem::len_A,
+                       frodo640_kem::len_salt,
+                       frodo640_kem::B,
+                       frodo640_kem::D,
+                       16>)
+  ->Name("frodo640-decaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
 BENCHMARK(keygen<frodo976_kem::n, frodo976_kem::n̄, frodo976_kem::len_sec, frodo976_kem::len_SE, frodo976_kem::len_A, frodo976_kem::B, frodo976_kem::D>)
   ->Name("frodo976-keygen")
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
+BENCHMARK(keygen_x4<frodo976_kem::n, frodo976_kem::n̄, frodo976_kem::len_sec, frodo976_kem::len_SE, frodo976_kem::len_A, frodo976_kem::B, frodo976_kem::D>)
+  ->Name("frodo976-keygen-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
 BENCHMARK(
   encaps<frodo976_kem::n, frodo976_kem::n̄, frodo976_kem::len_sec, frodo976_kem::len_SE, frodo976_kem::len_A, frodo976_kem::len_salt, frodo976_kem::B, frodo976_kem::D>)
   ->Name("frodo976-encaps")
@@ -210,10 +648,97 @@ BENCHMARK(
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
 
+BENCHMARK(encaps_prepared<frodo976_kem::n,
+                          frodo976_kem::n̄,
+                          frodo976_kem::len_sec,
+                          frodo976_kem::len_SE,
+                          frodo976_kem::len_A,
+                          frodo976_kem::len_salt,
+                          frodo976_kem::B,
+                          frodo976_kem::D>)
+  ->Name("frodo976-encaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_prepared<frodo976_kem::n,
+                          frodo976_kem::n̄,
+                          frodo976_kem::len_sec,
+                          frodo976_kem::len_SE,
+                          frodo976_kem::len_A,
+                          frodo976_kem::len_salt,
+                          frodo976_kem::B,
+                          frodo976_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo976-encaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_batch<frodo976_kem::n,
+                       frodo976_kem::n̄,
+                       frodo976_kem::len_sec,
+                       frodo976_kem::len_SE,
+                       frodo976_kem::len_A,
+                       frodo976_kem::len_salt,
+                       frodo976_kem::B,
+                       frodo976_kem::D,
+                       16>)
+  ->Name("frodo976-encaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_x4<frodo976_kem::n, frodo976_kem::n̄, frodo976_kem::len_sec, frodo976_kem::len_SE, frodo976_kem::len_A, frodo976_kem::len_salt, frodo976_kem::B, frodo976_kem::D>)
+  ->Name("frodo976-encaps-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo976_kem::n,
+                          frodo976_kem::n̄,
+                          frodo976_kem::len_sec,
+                          frodo976_kem::len_SE,
+                          frodo976_kem::len_A,
+                          frodo976_kem::len_salt,
+                          frodo976_kem::B,
+                          frodo976_kem::D>)
+  ->Name("frodo976-decaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo976_kem::n,
+                          frodo976_kem::n̄,
+                          frodo976_kem::len_sec,
+                          frodo976_kem::len_SE,
+                          frodo976_kem::len_A,
+                          frodo976_kem::len_salt,
+                          frodo976_kem::B,
+                          frodo976_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo976-decaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_batch<frodo976_kem::n,
+                       frodo976_kem::n̄,
+                       frodo976_kem::len_sec,
+                       frodo976_kem::len_SE,
+                       frodo976_kem::len_A,
+                       frodo976_kem::len_salt,
+                       frodo976_kem::B,
+                       frodo976_kem::D,
+                       16>)
+  ->Name("frodo976-decaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
 BENCHMARK(keygen<frodo1344_kem::n, frodo1344_kem::n̄, frodo1344_kem::len_sec, frodo1344_kem::len_SE, frodo1344_kem::len_A, frodo1344_kem::B, frodo1344_kem::D>)
   ->Name("frodo1344-keygen")
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
+BENCHMARK(keygen_x4<frodo1344_kem::n, frodo1344_kem::n̄, frodo1344_kem::len_sec, frodo1344_kem::len_SE, frodo1344_kem::len_A, frodo1344_kem::B, frodo1344_kem::D>)
+  ->Name("frodo1344-keygen-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
 BENCHMARK(encaps<frodo1344_kem::n,
                  frodo1344_kem::n̄,
                  frodo1344_kem::len_sec,
@@ -237,6 +762,89 @@ BENCHMARK(decaps<frodo1344_kem::n,
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
 
+BENCHMARK(encaps_prepared<frodo1344_kem::n,
+                          frodo1344_kem::n̄,
+                          frodo1344_kem::len_sec,
+                          frodo1344_kem::len_SE,
+                          frodo1344_kem::len_A,
+                          frodo1344_kem::len_salt,
+                          frodo1344_kem::B,
+                          frodo1344_kem::D>)
+  ->Name("frodo1344-encaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_prepared<frodo1344_kem::n,
+                          frodo1344_kem::n̄,
+                          frodo1344_kem::len_sec,
+                          frodo1344_kem::len_SE,
+                          frodo1344_kem::len_A,
+                          frodo1344_kem::len_salt,
+                          frodo1344_kem::B,
+                          frodo1344_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo1344-encaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_batch<frodo1344_kem::n,
+                       frodo1344_kem::n̄,
+                       frodo1344_kem::len_sec,
+                       frodo1344_kem::len_SE,
+                       frodo1344_kem::len_A,
+                       frodo1344_kem::len_salt,
+                       frodo1344_kem::B,
+                       frodo1344_kem::D,
+                       16>)
+  ->Name("frodo1344-encaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(encaps_x4<frodo1344_kem::n, frodo1344_kem::n̄, frodo1344_kem::len_sec, frodo1344_kem::len_SE, frodo1344_kem::len_A, frodo1344_kem::len_salt, frodo1344_kem::B, frodo1344_kem::D>)
+  ->Name("frodo1344-encaps-x4")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo1344_kem::n,
+                          frodo1344_kem::n̄,
+                          frodo1344_kem::len_sec,
+                          frodo1344_kem::len_SE,
+                          frodo1344_kem::len_A,
+                          frodo1344_kem::len_salt,
+                          frodo1344_kem::B,
+                          frodo1344_kem::D>)
+  ->Name("frodo1344-decaps-prepared")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_prepared<frodo1344_kem::n,
+                          frodo1344_kem::n̄,
+                          frodo1344_kem::len_sec,
+                          frodo1344_kem::len_SE,
+                          frodo1344_kem::len_A,
+                          frodo1344_kem::len_salt,
+                          frodo1344_kem::B,
+                          frodo1344_kem::D,
+                          gen_a::prg_t::shake128,
+                          true>)
+  ->Name("frodo1344-decaps-cached")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
+BENCHMARK(decaps_batch<frodo1344_kem::n,
+                       frodo1344_kem::n̄,
+                       frodo1344_kem::len_sec,
+                       frodo1344_kem::len_SE,
+                       frodo1344_kem::len_A,
+                       frodo1344_kem::len_salt,
+                       frodo1344_kem::B,
+                       frodo1344_kem::D,
+                       16>)
+  ->Name("frodo1344-decaps-batch16")
+  ->ComputeStatistics("min", compute_min)
+  ->ComputeStatistics("max", compute_max);
+
 BENCHMARK(keygen<efrodo640_kem::n, efrodo640_kem::n̄, efrodo640_kem::len_sec, efrodo640_kem::len_SE, efrodo640_kem::len_A, efrodo640_kem::B, efrodo640_kem::D>)
   ->Name("efrodo640-keygen")
   ->ComputeStatistics("min", compute_min)
@@ -317,3 +925,87 @@ BENCHMARK(decaps<efrodo1344_kem::n,
   ->Name("efrodo1344-decaps")
   ->ComputeStatistics("min", compute_min)
   ->ComputeStatistics("max", compute_max);
+
+// Benchmark execution of some Frodo KEM algorithm, for some specific parameter
+// set, while forcing use of kernels of given instruction set tier, so that all
+// tiers supported by this CPU can be compared side by side.
+template<void (*bench)(benchmark::State&)>
+inline void
+at_tier(benchmark::State& state, const dispatch::tier_t tier)
+{
+  if (dispatch::force_tier(tier) != tier) {
+    state.SkipWithError("instruction set tier isn't supported by this CPU");
+    return;
+  }
+
+  bench(state);
+  dispatch::reset_tier();
+}
+
+// Registers given benchmark once for each instruction set tier, named like
+// `frodo640-keygen/avx2`.
+template<void (*bench)(benchmark::State&)>
+inline bool
+register_at_all_tiers(std::string_view name)
+{
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    std::string tiered_name(name);
+    tiered_name += '/';
+    tiered_name += dispatch::tier_name(tier);
+
+    benchmark::RegisterBenchmark(tiered_name.c_str(), at_tier<bench>, tier)->ComputeStatistics("min", compute_min)->ComputeStatistics("max", compute_max);
+  }
+
+  return true;
+}
+
+namespace f640 = frodo640_kem;
+namespace f976 = frodo976_kem;
+namespace f1344 = frodo1344_kem;
+
+const bool frodo640_keygen_at_tiers = register_at_all_tiers<keygen<f640::n, f640::n̄, f640::len_sec, f640::len_SE, f640::len_A, f640::B, f640::D>>("frodo640-keygen");
+const bool frodo640_encaps_at_tiers =
+  register_at_all_tiers<encaps<f640::n, f640::n̄, f640::len_sec, f640::len_SE, f640::len_A, f640::len_salt, f640::B, f640::D>>("frodo640-encaps");
+const bool frodo640_decaps_at_tiers =
+  register_at_all_tiers<decaps<f640::n, f640::n̄, f640::len_sec, f640::len_SE, f640::len_A, f640::len_salt, f640::B, f640::D>>("frodo640-decaps");
+
+const bool frodo976_keygen_at_tiers = register_at_all_tiers<keygen<f976::n, f976::n̄, f976::len_sec, f976::len_SE, f976::len_A, f976::B, f976::D>>("frodo976-keygen");
+const bool frodo976_encaps_at_tiers =
+  register_at_all_tiers<encaps<f976::n, f976::n̄, f976::len_sec, f976::len_SE, f976::len_A, f976::len_salt, f976::B, f976::D>>("frodo976-encaps");
+const bool frodo976_decaps_at_tiers =
+  register_at_all_tiers<decaps<f976::n, f976::n̄, f976::len_sec, f976::len_SE, f976::len_A, f976::len_salt, f976::B, f976::D>>("frodo976-decaps");
+
+const bool frodo1344_keygen_at_tiers =
+  register_at_all_tiers<keygen<f1344::n, f1344::n̄, f1344::len_sec, f1344::len_SE, f1344::len_A, f1344::B, f1344::D>>("frodo1344-keygen");
+const bool frodo1344_encaps_at_tiers =
+  register_at_all_tiers<encaps<f1344::n, f1344::n̄, f1344::len_sec, f1344::len_SE, f1344::len_A, f1344::len_salt, f1344::B, f1344::D>>("frodo1344-encaps");
+const bool frodo1344_decaps_at_tiers =
+  register_at_all_tiers<decaps<f1344::n, f1344::n̄, f1344::len_sec, f1344::len_SE, f1344::len_A, f1344::len_salt, f1344::B, f1344::D>>("frodo1344-decaps");
+
+// FrodoKEM-AES variants, at scalar tier, use bitsliced software AES, while at
+// other tiers, they use AES-NI, if this CPU supports it.
+namespace f640a = frodo640_aes_kem;
+namespace f976a = frodo976_aes_kem;
+namespace f1344a = frodo1344_aes_kem;
+constexpr auto aes = gen_a::prg_t::aes128;
+
+const bool frodo640_aes_keygen_at_tiers =
+  register_at_all_tiers<keygen<f640a::n, f640a::n̄, f640a::len_sec, f640a::len_SE, f640a::len_A, f640a::B, f640a::D, aes>>("frodo640-aes-keygen");
+const bool frodo640_aes_encaps_at_tiers =
+  register_at_all_tiers<encaps<f640a::n, f640a::n̄, f640a::len_sec, f640a::len_SE, f640a::len_A, f640a::len_salt, f640a::B, f640a::D, aes>>("frodo640-aes-encaps");
+const bool frodo640_aes_decaps_at_tiers =
+  register_at_all_tiers<decaps<f640a::n, f640a::n̄, f640a::len_sec, f640a::len_SE, f640a::len_A, f640a::len_salt, f640a::B, f640a::D, aes>>("frodo640-aes-decaps");
+
+const bool frodo976_aes_keygen_at_tiers =
+  register_at_all_tiers<keygen<f976a::n, f976a::n̄, f976a::len_sec, f976a::len_SE, f976a::len_A, f976a::B, f976a::D, aes>>("frodo976-aes-keygen");
+const bool frodo976_aes_encaps_at_tiers =
+  register_at_all_tiers<encaps<f976a::n, f976a::n̄, f976a::len_sec, f976a::len_SE, f976a::len_A, f976a::len_salt, f976a::B, f976a::D, aes>>("frodo976-aes-encaps");
+const bool frodo976_aes_decaps_at_tiers =
+  register_at_all_tiers<decaps<f976a::n, f976a::n̄, f976a::len_sec, f976a::len_SE, f976a::len_A, f976a::len_salt, f976a::B, f976a::D, aes>>("frodo976-aes-decaps");
+
+const bool frodo1344_aes_keygen_at_tiers =
+  register_at_all_tiers<keygen<f1344a::n, f1344a::n̄, f1344a::len_sec, f1344a::len_SE, f1344a::len_A, f1344a::B, f1344a::D, aes>>("frodo1344-aes-keygen");
+const bool frodo1344_aes_encaps_at_tiers = register_at_all_tiers<
+  encaps<f1344a::n, f1344a::n̄, f1344a::len_sec, f1344a::len_SE, f1344a::len_A, f1344a::len_salt, f1344a::B, f1344a::D, aes>>("frodo1344-aes-encaps");
+const bool frodo1344_aes_decaps_at_tiers = register_at_all_tiers<
+  decaps<f1344a::n, f1344a::n̄, f1344a::len_sec, f1344a::len_SE, f1344a::len_A, f1344a::len_salt, f1344a::B, f1344a::D, aes>>("frodo1344-aes-decaps");
@@ -0,0 +1,582 @@
+#pragma once
+#include "gen_a.hpp"
+#include "zq.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Bounded, thread-safe cache of fully expanded pseudorandom matrices A
+//
+// Expanding seedA into n x n matrix A dominates cost of encapsulation and
+// decapsulation, while a server's own key or a popular peer key keeps
+// expanding the very same A. This cache keeps recently used matrices A,
+// keyed by ( n, D, PRG, seedA ), within a configurable byte budget, evicting
+// least recently used ones first.
+//
+// Cached matrices are indexed by an immutable table, which insertion and
+// eviction ( serialized among themselves, by a mutex ) replace by a modified
+// copy, moving an atomic generation counter on. Each thread keeps its own
+// snapshot of the table, which lookups reuse, for as long as the generation
+// stays same. So a hit takes no lock and doesn't touch reference count of the
+// table; it only reads the generation and the table, while writing the hit
+// counter shard of its thread, recency stamp of the matrix it hits and
+// reference count of that matrix, as it's handed out. Only the first lookup
+// after an insertion or an eviction retakes the snapshot, by atomically loading
+// a `std::shared_ptr` to the table, which common standard libraries implement
+// with a short, internal spin lock, rather than a lock-free sequence.
+//
+// A looked up matrix is handed out as a reference counted, immutable view,
+// which stays valid even after it gets evicted, so reading its rows needs no
+// locking at all. Note, a thread's snapshot keeps the table it was taken of
+// alive, so storage of an evicted matrix is only released once every thread,
+// which looked the cache up before eviction, either looks it up again or
+// exits.
+namespace a_cache {
+
+// Alignment of storage of each cached matrix, in bytes, matching cache line
+// size and widest SIMD register.
+constexpr size_t ALIGNMENT = 64;
+
+// Cache configuration.
+struct config_t
+{
+  // Upper bound on total bytes of cached matrices. A matrix A takes 2n^2
+  // -bytes i.e. 0.8, 1.9 and 3.6 MB, for n = 640, 976 and 1344, respectively.
+  size_t budget_bytes = 64ul << 20;
+
+  // Whether to ask the operating system for backing storage with transparent
+  // huge pages, reducing TLB misses, while streaming rows of A. Only honoured
+  // on Linux, elsewhere it's ignored.
+  bool huge_pages = false;
+};
+
+// Snapshot of cache counters.
+struct stats_t
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+};
+
+namespace internal {
+
+// Allocates 64 -bytes aligned storage of given byte length, which is released
+// once last reference to it is dropped.
+inline std::shared_ptr<void>
+allocate(const size_t bytes, const bool huge_pages)
+{
+#if defined(__linux__)
+  if (huge_pages) {
+    void* const ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED) {
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+      return std::shared_ptr<void>(ptr, [bytes](void* mem) { munmap(mem, bytes); });
+    }
+  }
+#else
+  (void)huge_pages;
+#endif
+
+  void* const ptr = ::operator new(bytes, std::align_val_t{ ALIGNMENT });
+  return std::shared_ptr<void>(ptr, [](void* mem) { ::operator delete(mem, std::align_val_t{ ALIGNMENT }); });
+}
+
+// Returns a recency stamp, in nanoseconds, off a monotonic clock. Each cached
+// matrix keeps the stamp of its last use, so that lookups of distinct matrices
+// don't contend on a shared counter.
+inline uint64_t
+now()
+{
+  const auto ticks = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ticks).count());
+}
+
+// A cached matrix A, along with the stamp of its last use, which is what
+// eviction looks at.
+struct entry_t
+{
+  std::shared_ptr<const void> storage{};
+  size_t bytes = 0;
+  std::atomic<uint64_t> last_use{ 0 };
+
+  entry_t(std::shared_ptr<const void> storage, const size_t bytes)
+    : storage(std::move(storage))
+    , bytes(bytes)
+    , last_use(now())
+  {
+  }
+
+  // Marks this matrix as just used.
+  inline void touch() { this->last_use.store(now(), std::memory_order_relaxed); }
+};
+
+// Maximum byte length of seedA, a cache can be keyed by.
+constexpr size_t MAX_SEED_LEN = 32;
+
+// Fixed-size key identifying matrix A, of dimension n x n, expanded from a
+// seed, using chosen PRG. It's built on stack, so a lookup never allocates.
+struct key_t
+{
+  uint32_t n = 0;
+  uint32_t d = 0;
+  uint32_t prg = 0;
+  uint32_t seed_len = 0;
+  std::array<uint8_t, MAX_SEED_LEN> seed{};
+
+  auto operator<=>(const key_t&) const = default;
+};
+
+// Key identifying matrix A, of dimension n x n, expanded from given seed,
+// using chosen PRG.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg>
+inline key_t
+key_of(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+  requires(((len_seed_A + 7) / 8) <= MAX_SEED_LEN)
+{
+  key_t key{
+    .n = static_cast<uint32_t>(n),
+    .d = static_cast<uint32_t>(D),
+    .prg = static_cast<uint32_t>(prg),
+    .seed_len = static_cast<uint32_t>(seed.size()),
+  };
+
+  std::copy(seed.begin(), seed.end(), key.seed.begin());
+  return key;
+}
+
+// Table of cached matrices, which is never modified once published, see
+// `cache_t`.
+using table_t = std::map<key_t, std::shared_ptr<entry_t>>;
+
+// Atomically loaded and published pointer to the current table of cached
+// matrices, along with generation of the table, which moves on, every time a
+// table is published. Falls back to atomic free functions on
+// `std::shared_ptr`, when the standard library doesn't provide
+// `std::atomic<std::shared_ptr>`.
+struct table_ptr_t
+{
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+  std::atomic<std::shared_ptr<const table_t>> ptr{ std::make_shared<const table_t>() };
+#else
+  std::shared_ptr<const table_t> ptr{ std::make_shared<const table_t>() };
+#endif
+  std::atomic<uint64_t> gen{ 0 };
+
+public:
+  // Returns generation of the current table. A table loaded after reading
+  // generation g is at least as recent as the one of generation g.
+  inline uint64_t generation() const { return this->gen.load(std::memory_order_acquire); }
+
+  inline std::shared_ptr<const table_t> load() const
+  {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    return this->ptr.load(std::memory_order_acquire);
+#else
+    return std::atomic_load_explicit(&this->ptr, std::memory_order_acquire);
+#endif
+  }
+
+  inline void store(std::shared_ptr<const table_t> table)
+  {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    this->ptr.store(std::move(table), std::memory_order_release);
+#else
+    std::atomic_store_explicit(&this->ptr, std::move(table), std::memory_order_release);
+#endif
+    this->gen.fetch_add(1, std::memory_order_release);
+  }
+};
+
+// Returns a unique id, for a newly constructed cache, which is never reused, so
+// that a snapshot of the table of a destroyed cache is never mistaken for one
+// of a new cache, living at the same address.
+inline uint64_t
+next_cache_id()
+{
+  static std::atomic<uint64_t> next{ 1 };
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A thread's snapshot of the table of a cache, which is current, as long as
+// generation of that cache's table stays same.
+struct snapshot_t
+{
+  uint64_t cache_id = 0;
+  uint64_t generation = 0;
+  std::shared_ptr<const table_t> table{};
+};
+
+// # -of snapshots, each thread keeps, for as many caches, it looks up. Caches
+// are mapped to snapshots by their id, so a thread alternating between more
+// caches than this, only keeps retaking snapshots. A snapshot of a destroyed
+// cache is dropped, once its slot is taken by some other cache.
+constexpr size_t SNAPSHOT_SLOTS = 4;
+
+// Returns snapshot slot of calling thread, for cache of given id.
+inline snapshot_t&
+snapshot_slot(const uint64_t cache_id)
+{
+  static thread_local std::array<snapshot_t, SNAPSHOT_SLOTS> slots{};
+  return slots[cache_id % SNAPSHOT_SLOTS];
+}
+
+// # -of shards, hits are counted in. Each lookup bumps the shard picked by its
+// thread, so that concurrent lookups don't keep bouncing one cache line.
+constexpr size_t HIT_SHARDS = 16;
+
+// A counter occupying a whole cache line.
+struct alignas(ALIGNMENT) counter_t
+{
+  std::atomic<uint64_t> value{ 0 };
+};
+
+// Returns index of the shard of hit counters, calling thread bumps.
+inline size_t
+hit_shard()
+{
+  static thread_local const size_t shard = std::hash<std::thread::id>{}(std::this_thread::get_id()) % HIT_SHARDS;
+  return shard;
+}
+
+}
+
+// Immutable view of an expanded matrix A, of dimension n x n, which can be used
+// as a `gen_a::row_source`. Holding a view keeps the matrix alive, even if it
+// gets evicted from the cache ( or unmapped, see `a_file` ) in the meantime. An
+// empty view holds no matrix.
+template<size_t n, size_t D>
+struct view_t
+{
+private:
+  std::shared_ptr<const zq::zq_t<D>> elements{};
+
+public:
+  view_t() = default;
+
+  // Given reference counted storage of n x n row-major elements of matrix A,
+  // returns a view of it, sharing ownership of the storage.
+  explicit view_t(std::shared_ptr<const void> storage)
+    : elements(storage, static_cast<const zq::zq_t<D>*>(storage.get()))
+  {
+  }
+
+  // Returns whether this view holds a matrix.
+  inline explicit operator bool() const { return this->elements != nullptr; }
+
+  // Returns reference counted storage of matrix A.
+  inline std::shared_ptr<const void> storage() const { return this->elements; }
+
+  // Returns pointer to row-major elements of matrix A.
+  inline const zq::zq_t<D>* data() const { return this->elements.get(); }
+
+  // Given a row index i ∈ [0, n), returns view of `count` -many consecutive
+  // rows of A, starting at row i, without touching the scratch space.
+  template<size_t count>
+  inline std::span<const zq::zq_t<D>, count * n> rows(const size_t ridx, std::span<zq::zq_t<D>, count * n>) const
+  {
+    return std::span<const zq::zq_t<D>, count * n>(this->data() + ridx * n, count * n);
+  }
+};
+
+// Thread-safe, least recently used cache of expanded matrices A, bounded by a
+// byte budget.
+struct cache_t
+{
+private:
+  internal::table_ptr_t table;
+  const uint64_t id = internal::next_cache_id();
+  mutable std::mutex write_lock; // Serializes insertion and eviction.
+  config_t config;
+  size_t bytes = 0;
+
+  std::array<internal::counter_t, internal::HIT_SHARDS> hits{};
+  std::atomic<uint64_t> misses{ 0 };
+  std::atomic<uint64_t> evictions{ 0 };
+
+  // Evicts least recently used matrices from given copy of the table, until
+  // cached bytes + `incoming` fit within byte budget. Must be called while
+  // holding write lock.
+  inline void evict_for(internal::table_t& entries, const size_t incoming)
+  {
+    while (!entries.empty() && (this->bytes + incoming > this->config.budget_bytes)) {
+      auto victim = entries.begin();
+      for (auto it = entries.begin(); it != entries.end(); it++) {
+        if (it->second->last_use.load(std::memory_order_relaxed) < victim->second->last_use.load(std::memory_order_relaxed)) {
+          victim = it;
+        }
+      }
+
+      this->bytes -= victim->second->bytes;
+      entries.erase(victim);
+      this->evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns calling thread's snapshot of the current table, retaking it, only
+  // if some other table got published since it was last taken.
+  inline const internal::table_t& snapshot() const
+  {
+    auto& slot = internal::snapshot_slot(this->id);
+    const uint64_t gen = this->table.generation();
+
+    if ((slot.cache_id != this->id) || (slot.generation != gen)) {
+      slot.table = this->table.load();
+      slot.cache_id = this->id;
+      slot.generation = gen;
+    }
+
+    return *slot.table;
+  }
+
+  // Returns byte budget, which may be concurrently updated, see `set_budget`.
+  inline size_t budget() const
+  {
+    std::lock_guard guard(this->write_lock);
+    return this->config.budget_bytes;
+  }
+
+  // Inserts storage of an expanded matrix A under given key, evicting least
+  // recently used matrices, if needed, unless some other thread has already
+  // inserted the same matrix, in which case that one is kept. Returns a view of
+  // the cached matrix.
+  template<size_t n, size_t D>
+  inline view_t<n, D> insert_entry(const internal::key_t& key, std::shared_ptr<const void> storage)
+  {
+    constexpr size_t mat_bytes = n * n * sizeof(zq::zq_t<D>);
+
+    std::lock_guard guard(this->write_lock);
+
+    const auto current = this->table.load();
+    if (const auto it = current->find(key); it != current->end()) {
+      it->second->touch();
+      return view_t<n, D>(it->second->storage);
+    }
+
+    auto next = std::make_shared<internal::table_t>(*current);
+    this->evict_for(*next, mat_bytes);
+
+    auto entry = std::make_shared<internal::entry_t>(std::move(storage), mat_bytes);
+
+    next->emplace(key, entry);
+    this->bytes += mat_bytes;
+    this->table.store(std::move(next));
+
+    return view_t<n, D>(entry->storage);
+  }
+
+public:
+  explicit cache_t(const config_t config = {})
+    : config(config)
+  {
+  }
+
+  cache_t(const cache_t&) = delete;
+  cache_t& operator=(const cache_t&) = delete;
+
+  // Given a seed of length len_seed_A -bits, this routine returns a view of
+  // matrix A, of dimension n x n, expanded from it, using chosen PRG. A hit
+  // takes no lock and allocates nothing, looking A up in calling thread's
+  // snapshot of the table. On a miss, A is expanded, without holding any lock,
+  // and then inserted, evicting least recently used matrices, if needed. If A
+  // alone doesn't fit within byte budget, an empty view is returned, so that
+  // the caller falls back to streaming rows of A.
+  template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+  inline view_t<n, D> get(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+  {
+    constexpr size_t mat_bytes = n * n * sizeof(zq::zq_t<D>);
+
+    const auto key = internal::key_of<n, len_seed_A, D, prg>(seed);
+
+    {
+      const auto& current = this->snapshot();
+
+      if (const auto it = current.find(key); it != current.end()) {
+        it->second->touch();
+        this->hits[internal::hit_shard()].value.fetch_add(1, std::memory_order_relaxed);
+
+        return view_t<n, D>(it->second->storage);
+      }
+    }
+
+    this->misses.fetch_add(1, std::memory_order_relaxed);
+
+    if (mat_bytes > this->budget()) {
+      return view_t<n, D>();
+    }
+
+    auto storage = internal::allocate(mat_bytes, this->config.huge_pages);
+
+    auto elements = static_cast<zq::zq_t<D>*>(storage.get());
+    std::uninitialized_default_construct_n(elements, n * n);
+
+    const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(seed);
+    rowgen.template generate<n>(0, std::span<zq::zq_t<D>, n * n>(elements, n * n));
+
+    return this->insert_entry<n, D>(key, std::move(storage));
+  }
+
+  // Given a seed of length len_seed_A -bits and a view of matrix A, already
+  // expanded from it, using chosen PRG ( say, mapped from a file, see `a_file`
+  // ), this routine inserts the matrix in the cache, without copying it, so
+  // that later lookups of same seed hit it. If the seed is already cached, the
+  // cached matrix is kept. Returns a view of the cached matrix, or an empty
+  // view, if matrix A alone doesn't fit within byte budget.
+  template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+  inline view_t<n, D> insert(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const view_t<n, D>& view)
+  {
+    constexpr size_t mat_bytes = n * n * sizeof(zq::zq_t<D>);
+
+    if (!view || (mat_bytes > this->budget())) {
+      return view_t<n, D>();
+    }
+
+    const auto key = internal::key_of<n, len_seed_A, D, prg>(seed);
+    return this->insert_entry<n, D>(key, view.storage());
+  }
+
+  // Given a seed of length len_seed_A -bits, this routine drops matrix A, of
+  // dimension n x n, expanded from it, using chosen PRG, from the cache ( say,
+  // once a mapped matrix fails verification, see `a_file::load` ). Already
+  // handed out views stay valid. Returns whether the matrix was cached.
+  template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+  inline bool erase(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+  {
+    const auto key = internal::key_of<n, len_seed_A, D, prg>(seed);
+
+    std::lock_guard guard(this->write_lock);
+
+    const auto current = this->table.load();
+    const auto it = current->find(key);
+    if (it == current->end()) {
+      return false;
+    }
+
+    auto next = std::make_shared<internal::table_t>(*current);
+    next->erase(key);
+
+    this->bytes -= it->second->bytes;
+    this->table.store(std::move(next));
+
+    return true;
+  }
+
+  // Updates byte budget, evicting least recently used matrices, if they don't
+  // fit anymore. Already handed out views stay valid.
+  inline void set_budget(const size_t budget_bytes)
+  {
+    std::lock_guard guard(this->write_lock);
+
+    this->config.budget_bytes = budget_bytes;
+
+    auto next = std::make_shared<internal::table_t>(*this->table.load());
+    this->evict_for(*next, 0);
+    this->table.store(std::move(next));
+  }
+
+  // Drops all cached matrices. Already handed out views stay valid.
+  inline void clear()
+  {
+    std::lock_guard guard(this->write_lock);
+
+    this->table.store(std::make_shared<const internal::table_t>());
+    this->bytes = 0;
+  }
+
+  // Returns a snapshot of cache counters.
+  inline stats_t stats() const
+  {
+    std::lock_guard guard(this->write_lock);
+
+    uint64_t hit_cnt = 0;
+    for (const auto& shard : this->hits) {
+      hit_cnt += shard.value.load(std::memory_order_relaxed);
+    }
+
+    return stats_t{
+      .hits = hit_cnt,
+      .misses = this->misses.load(std::memory_order_relaxed),
+      .evictions = this->evictions.load(std::memory_order_relaxed),
+      .entries = this->table.load()->size(),
+      .bytes = this->bytes,
+    };
+  }
+};
+
+// Returns process-wide cache of expanded matrices A, created with default
+// configuration, on first use.
+inline cache_t&
+global()
+{
+  static cache_t cache{};
+  return cache;
+}
+
+// Source of rows of matrix A, for a fixed seedA, which reads them from an
+// already expanded ( cached or memory-mapped ) matrix A, when one is available,
+// falling back to generating them, one block at a time, otherwise.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+struct row_source_t
+{
+private:
+  gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen;
+  view_t<n, D> view{};
+
+public:
+  // Given a seed, prepares to generate rows of A from it, without any cache.
+  explicit row_source_t(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+    : rowgen(seed)
+  {
+  }
+
+  // Given a seed and a cache, looks up ( or expands and inserts ) matrix A in
+  // the cache, reading rows from it, from now on.
+  row_source_t(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, cache_t& cache)
+    : rowgen(seed)
+    , view(cache.template get<n, len_seed_A, D, prg>(seed))
+  {
+  }
+
+  // Given a seed and a view of matrix A, already expanded from it ( say,
+  // mapped from a file, see `a_file` ), reads rows from the view, from now on.
+  row_source_t(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, view_t<n, D> view)
+    : rowgen(seed)
+    , view(std::move(view))
+  {
+  }
+
+  // Returns whether rows are read from an expanded matrix A.
+  inline bool cached() const { return static_cast<bool>(this->view); }
+
+  // Given a row index i ∈ [0, n) and scratch space, returns view of `count`
+  // -many consecutive rows of A, starting at row i.
+  template<size_t count>
+  inline std::span<const zq::zq_t<D>, count * n> rows(const size_t ridx, std::span<zq::zq_t<D>, count * n> scratch) const
+  {
+    if (this->view) {
+      return this->view.template rows<count>(ridx, scratch);
+    }
+
+    return this->rowgen.template rows<count>(ridx, scratch);
+  }
+};
+
+}
@@ -0,0 +1,436 @@
+#pragma once
+#include "a_cache.hpp"
+#include "gen_a.hpp"
+#include "zq.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Persisting expanded pseudorandom matrix A to a file, for fast warm start
+//
+// A file holds a fixed size header, identifying matrix A ( n, D, PRG and seedA,
+// along with a checksum of its elements ), followed by n x n row-major elements
+// of A, as little-endian 16 -bit words, which is exactly the in-memory layout
+// of `matrix::generate`, on little-endian hosts. Header occupies a whole page,
+// so that elements start page aligned and can be mapped read-only and consumed
+// by the KEM, with zero copies. As the mapping is shared, all processes on a
+// host mapping same file share a single page cached copy of A.
+//
+// File layout of header, with all integers little-endian
+//
+// offset | length | field
+// -------|--------|------
+// 0      | 8      | magic "FRODO-A\0"
+// 8      | 4      | format version
+// 12     | 4      | n
+// 16     | 4      | D
+// 20     | 4      | PRG, see `gen_a::prg_t`
+// 24     | 4      | len_seed_A, in bits
+// 28     | 4      | reserved, zero
+// 32     | 8      | checksum of elements, see `checksum`
+// 40     | 64     | seedA, zero padded
+// 104    | 3992   | reserved, zero
+namespace a_file {
+
+constexpr std::array<uint8_t, 8> MAGIC = { 'F', 'R', 'O', 'D', 'O', '-', 'A', '\0' };
+constexpr uint32_t VERSION = 1;
+
+// Byte length of header, elements of A start right after it.
+constexpr size_t HEADER_LEN = 4096;
+
+// Maximum byte length of seedA, which can be stored in header.
+constexpr size_t MAX_SEED_LEN = 64;
+
+// Byte length of a file holding matrix A, of dimension n x n.
+constexpr size_t
+file_len(const size_t n)
+{
+  return HEADER_LEN + n * n * sizeof(uint16_t);
+}
+
+// Incremental 64 -bit FNV-1a hash over little-endian 64 -bit words, used for
+// detecting accidental corruption of stored elements of A. It's not meant to
+// withstand deliberate tampering, use `mapped_t::verify` for that.
+struct checksum_t
+{
+private:
+  uint64_t state = 0xcbf29ce484222325ul;
+
+public:
+  // Given bytes, whose length is a multiple of 8, absorbs them into the hash.
+  inline void absorb(std::span<const uint8_t> bytes)
+  {
+    for (size_t off = 0; off < bytes.size(); off += sizeof(uint64_t)) {
+      uint64_t word = 0;
+      for (size_t i = 0; i < sizeof(word); i++) {
+        word |= static_cast<uint64_t>(bytes[off + i]) << (i * 8);
+      }
+
+      this->state = (this->state ^ word) * 0x100000001b3ul;
+    }
+  }
+
+  inline uint64_t digest() const { return this->state; }
+};
+
+// Given bytes, whose length is a multiple of 8, returns their checksum.
+inline uint64_t
+checksum(std::span<const uint8_t> bytes)
+{
+  checksum_t hasher{};
+  hasher.absorb(bytes);
+  return hasher.digest();
+}
+
+namespace internal {
+
+inline void
+store_le(uint8_t* const dst, const uint64_t v, const size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = static_cast<uint8_t>(v >> (i * 8));
+  }
+}
+
+inline uint64_t
+load_le(const uint8_t* const src, const size_t len)
+{
+  uint64_t v = 0;
+  for (size_t i = 0; i < len; i++) {
+    v |= static_cast<uint64_t>(src[i]) << (i * 8);
+  }
+
+  return v;
+}
+
+// Serializes header of a file, holding matrix A of dimension n x n, expanded
+// from given seed, using chosen PRG, whose elements hash to given checksum.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg>
+inline void
+encode_header(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const uint64_t sum, std::span<uint8_t, HEADER_LEN> header)
+  requires(((len_seed_A + 7) / 8) <= MAX_SEED_LEN)
+{
+  std::fill(header.begin(), header.end(), 0);
+
+  std::copy(MAGIC.begin(), MAGIC.end(), header.begin());
+  store_le(header.data() + 8, VERSION, 4);
+  store_le(header.data() + 12, n, 4);
+  store_le(header.data() + 16, D, 4);
+  store_le(header.data() + 20, static_cast<uint32_t>(prg), 4);
+  store_le(header.data() + 24, len_seed_A, 4);
+  store_le(header.data() + 32, sum, 8);
+  std::copy(seed.begin(), seed.end(), header.begin() + 40);
+}
+
+// Given header of a file, checks whether it identifies matrix A of dimension
+// n x n, expanded from given seed, using chosen PRG. Returns checksum of
+// elements, recorded in header, if so.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg>
+inline std::optional<uint64_t>
+decode_header(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, std::span<const uint8_t, HEADER_LEN> header)
+{
+  std::array<uint8_t, HEADER_LEN> expected{};
+  encode_header<n, len_seed_A, D, prg>(seed, 0, expected);
+
+  // All fields, but checksum, must match.
+  store_le(expected.data() + 32, load_le(header.data() + 32, 8), 8);
+  if (!std::equal(header.begin(), header.end(), expected.begin())) {
+    return std::nullopt;
+  }
+
+  return load_le(header.data() + 32, 8);
+}
+
+// A read-only, shared mapping of a file, holding matrix A, along with memoized
+// outcomes of verifying it.
+struct mapping_t
+{
+  const uint8_t* base = nullptr;
+  size_t len = 0;
+
+  // 0 = not yet verified, 1 = verified ok, 2 = verification failed
+  std::atomic<uint32_t> checksum_state{ 0 };
+  std::atomic<uint32_t> seed_state{ 0 };
+
+  mapping_t(const uint8_t* const base, const size_t len)
+    : base(base)
+    , len(len)
+  {
+  }
+
+  mapping_t(const mapping_t&) = delete;
+  mapping_t& operator=(const mapping_t&) = delete;
+
+  ~mapping_t()
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(const_cast<uint8_t*>(this->base), this->len);
+#endif
+  }
+};
+
+// Runs given check, unless its outcome is already memoized in `state`, and
+// memoizes its outcome. Concurrent callers may run the check more than once,
+// but all of them agree on its outcome.
+template<typename check_t>
+inline bool
+memoized(std::atomic<uint32_t>& state, check_t check)
+{
+  const auto prev = state.load(std::memory_order_acquire);
+  if (prev != 0) {
+    return prev == 1;
+  }
+
+  const bool ok = check();
+  state.store(ok ? 1 : 2, std::memory_order_release);
+  return ok;
+}
+
+}
+
+// Given a seed of length len_seed_A -bits, this routine expands matrix A, of
+// dimension n x n, from it, using chosen PRG, and writes it to a file, at given
+// path. Matrix A is generated and written a few rows at a time, never held in
+// memory as a whole. The file is first written next to the destination and then
+// atomically renamed, so that concurrent readers never map a partially written
+// file. Returns whether the file got written.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline bool
+write(const std::filesystem::path& path, std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+  requires(((len_seed_A + 7) / 8) <= MAX_SEED_LEN)
+{
+#if defined(__unix__) || defined(__APPLE__)
+  constexpr size_t rows_per_chunk = 8;
+  static_assert(n % rows_per_chunk == 0, "n must be a multiple of rows written at a time");
+
+  const std::filesystem::path tmp_path = path.string() + ".tmp." + std::to_string(getpid());
+
+  const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  // Writes all of given bytes, at given offset, retrying short writes.
+  const auto write_all = [fd](std::span<const uint8_t> bytes, const size_t offset) {
+    size_t done = 0;
+    while (done < bytes.size()) {
+      const auto res = pwrite(fd, bytes.data() + done, bytes.size() - done, static_cast<off_t>(offset + done));
+      if (res <= 0) {
+        return false;
+      }
+
+      done += static_cast<size_t>(res);
+    }
+
+    return true;
+  };
+
+  const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(seed);
+
+  std::vector<zq::zq_t<D>> rows(rows_per_chunk * n);
+  std::vector<uint8_t> bytes(rows.size() * sizeof(uint16_t));
+  checksum_t hasher{};
+
+  bool ok = true;
+  for (size_t ridx = 0; ok && (ridx < n); ridx += rows_per_chunk) {
+    rowgen.template generate<rows_per_chunk>(ridx, std::span<zq::zq_t<D>, rows_per_chunk * n>(rows));
+
+    for (size_t i = 0; i < rows.size(); i++) {
+      internal::store_le(bytes.data() + i * sizeof(uint16_t), rows[i].to_raw(), sizeof(uint16_t));
+    }
+
+    hasher.absorb(bytes);
+    ok = write_all(bytes, HEADER_LEN + ridx * n * sizeof(uint16_t));
+  }
+
+  std::array<uint8_t, HEADER_LEN> header{};
+  internal::encode_header<n, len_seed_A, D, prg>(seed, hasher.digest(), header);
+
+  ok = ok && write_all(header, 0);
+  ok = (fsync(fd) == 0) && ok;
+  ok = (close(fd) == 0) && ok;
+  ok = ok && (std::rename(tmp_path.c_str(), path.c_str()) == 0);
+
+  if (!ok) {
+    unlink(tmp_path.c_str());
+  }
+
+  return ok;
+#else
+  (void)path;
+  (void)seed;
+  return false;
+#endif
+}
+
+// Read-only mapping of a file, holding matrix A, of dimension n x n, expanded
+// from a known seed of length len_seed_A -bits, using chosen PRG. Elements of A
+// are consumed right out of the mapping, with zero copies, either through a
+// `view`, which can be fed to a cache ( see `a_cache::cache_t::insert` ) or to
+// a source of rows ( see `a_cache::row_source_t` ).
+//
+// Mapping a file only checks its header. Elements of A can be verified later,
+// on demand, say from a background thread, once the process has started
+// serving. Outcome of each verification is memoized, so it's paid for at most
+// once per mapping. Copies of a mapping share it.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+struct mapped_t
+{
+private:
+  std::shared_ptr<internal::mapping_t> mapping{};
+  std::array<uint8_t, (len_seed_A + 7) / 8> seed{};
+  uint64_t sum = 0;
+
+  inline std::span<const uint8_t> body() const { return std::span(this->mapping->base + HEADER_LEN, n * n * sizeof(uint16_t)); }
+
+public:
+  mapped_t(std::shared_ptr<internal::mapping_t> mapping, std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const uint64_t sum)
+    : mapping(std::move(mapping))
+    , sum(sum)
+  {
+    std::copy(seed.begin(), seed.end(), this->seed.begin());
+  }
+
+  // Returns a view of mapped matrix A, which keeps the file mapped, as long as
+  // it's alive.
+  inline a_cache::view_t<n, D> view() const
+  {
+    return a_cache::view_t<n, D>(std::shared_ptr<const void>(this->mapping, this->mapping->base + HEADER_LEN));
+  }
+
+  // Checks whether mapped elements of A hash to checksum recorded in header,
+  // detecting accidental corruption ( e.g. truncated or partially overwritten
+  // file ). It's as cheap as reading the file once, which also warms page
+  // cache.
+  inline bool verify_checksum() const
+  {
+    return internal::memoized(this->mapping->checksum_state, [&]() { return checksum(this->body()) == this->sum; });
+  }
+
+  // Checks whether mapped matrix A is exactly the one expanded from seedA, by
+  // generating it again, a few rows at a time, and comparing. It costs as much
+  // as generating A, but it's the only check which rules out a tampered file.
+  inline bool verify() const
+  {
+    return internal::memoized(this->mapping->seed_state, [&]() {
+      constexpr size_t rows_per_chunk = 8;
+
+      const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(this->seed);
+      const auto view = this->view();
+
+      std::vector<zq::zq_t<D>> scratch(rows_per_chunk * n);
+      std::span<zq::zq_t<D>, rows_per_chunk * n> rows(scratch);
+
+      bool ok = true;
+      for (size_t ridx = 0; ridx < n; ridx += rows_per_chunk) {
+        const auto expected = rowgen.template rows<rows_per_chunk>(ridx, rows);
+        const auto actual = view.template rows<rows_per_chunk>(ridx, rows);
+
+        ok &= std::memcmp(expected.data(), actual.data(), expected.size_bytes()) == 0;
+      }
+
+      return ok;
+    });
+  }
+};
+
+// Given path to a file, written by `write`, and seed of length len_seed_A
+// -bits, this routine maps the file read-only, after checking that its header
+// identifies matrix A, of dimension n x n, expanded from that seed, using
+// chosen PRG, and that the file is long enough to hold it. Elements of A are not
+// touched, see `mapped_t::verify_checksum` and `mapped_t::verify`.
+//
+// Elements are consumed in place, so this works only on little-endian hosts.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline std::optional<mapped_t<n, len_seed_A, D, prg>>
+map(const std::filesystem::path& path, std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+  requires(((len_seed_A + 7) / 8) <= MAX_SEED_LEN)
+{
+#if defined(__unix__) || defined(__APPLE__)
+  if constexpr (std::endian::native != std::endian::little) {
+    return std::nullopt;
+  }
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  struct stat st{};
+  if ((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) != file_len(n))) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  void* const ptr = mmap(nullptr, file_len(n), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (ptr == MAP_FAILED) {
+    return std::nullopt;
+  }
+
+  auto mapping = std::make_shared<internal::mapping_t>(static_cast<const uint8_t*>(ptr), file_len(n));
+
+  const auto sum = internal::decode_header<n, len_seed_A, D, prg>(seed, std::span<const uint8_t, HEADER_LEN>(mapping->base, HEADER_LEN));
+  if (!sum.has_value()) {
+    return std::nullopt;
+  }
+
+  return mapped_t<n, len_seed_A, D, prg>(std::move(mapping), seed, *sum);
+#else
+  (void)path;
+  (void)seed;
+  return std::nullopt;
+#endif
+}
+
+// Given path to a file, written by `write`, seed of length len_seed_A -bits and
+// a cache, this routine maps the file and inserts mapped matrix A in the cache,
+// so that KEM operations using prepared keys ( see
+// `kem::prepared_public_key` and `kem::prepared_secret_key` ), constructed with
+// that cache, read rows of A straight out of the mapping. Unless
+// `verify_checksum` is unset, checksum of elements is verified before
+// insertion.
+//
+// Returns the mapping, if it's what the cache now holds, so that the caller can
+// still verify it against seed, later on, say from a background thread ( see
+// `mapped_t::verify` ), evicting it from the cache ( see
+// `a_cache::cache_t::erase` ), if that fails. Returns nothing, if matrix A
+// didn't get cached or the cache already held a copy of it.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline std::optional<mapped_t<n, len_seed_A, D, prg>>
+load(const std::filesystem::path& path, std::span<const uint8_t, (len_seed_A + 7) / 8> seed, a_cache::cache_t& cache, const bool verify_checksum = true)
+  requires(((len_seed_A + 7) / 8) <= MAX_SEED_LEN)
+{
+  auto mapped = map<n, len_seed_A, D, prg>(path, seed);
+  if (!mapped.has_value() || (verify_checksum && !mapped->verify_checksum())) {
+    return std::nullopt;
+  }
+
+  const auto view = mapped->view();
+  if (cache.template insert<n, len_seed_A, D, prg>(seed, view).data() != view.data()) {
+    return std::nullopt;
+  }
+
+  return mapped;
+}
+
+}
@@ -0,0 +1,394 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Constant-time, bitsliced software implementation of AES-128 encryption
+//
+// Four 16 -bytes blocks are encrypted in parallel. Their 64 bytes are
+// bitsliced into eight 64 -bit planes s.t. bit b of byte p ( = 16 * block +
+// 4 * column + row, i.e. byte order of AES state ) lives at bit p of plane b.
+// Every step of a round is then computed using only bitwise logic and fixed
+// shifts, without any secret dependent table lookup or branch, following
+// FIPS 197 https://doi.org/10.6028/NIST.FIPS.197-upd1.
+//
+// This is the portable fallback for AES128 based generation of matrix A, when
+// AES-NI isn't available.
+namespace aes128 {
+
+// Byte length of AES-128 key.
+constexpr size_t KEY_LEN = 16;
+
+// Byte length of AES block.
+constexpr size_t BLOCK_LEN = 16;
+
+// # -of rounds of AES-128.
+constexpr size_t ROUNDS = 10;
+
+// # -of blocks encrypted in parallel, by bitsliced implementation.
+constexpr size_t PAR_BLOCKS = 4;
+
+// Eight bit planes of four bitsliced blocks.
+using planes_t = std::array<uint64_t, 8>;
+
+// Given eight bit planes, this routine applies AES S-box on each of the 64
+// bitsliced bytes, using Boyar-Peralta circuit of 113 logic gates, from
+// https://eprint.iacr.org/2011/332.pdf. Plane 0 holds least significant bits.
+inline constexpr void
+sub_bytes(planes_t& q)
+{
+  const uint64_t x0 = q[7];
+  const uint64_t x1 = q[6];
+  const uint64_t x2 = q[5];
+  const uint64_t x3 = q[4];
+  const uint64_t x4 = q[3];
+  const uint64_t x5 = q[2];
+  const uint64_t x6 = q[1];
+  const uint64_t x7 = q[0];
+
+  // Top linear transformation
+  const uint64_t y14 = x3 ^ x5;
+  const uint64_t y13 = x0 ^ x6;
+  const uint64_t y9 = x0 ^ x3;
+  const uint64_t y8 = x0 ^ x5;
+  const uint64_t t0 = x1 ^ x2;
+  const uint64_t y1 = t0 ^ x7;
+  const uint64_t y4 = y1 ^ x3;
+  const uint64_t y12 = y13 ^ y14;
+  const uint64_t y2 = y1 ^ x0;
+  const uint64_t y5 = y1 ^ x6;
+  const uint64_t y3 = y5 ^ y8;
+  const uint64_t t1 = x4 ^ y12;
+  const uint64_t y15 = t1 ^ x5;
+  const uint64_t y20 = t1 ^ x1;
+  const uint64_t y6 = y15 ^ x7;
+  const uint64_t y10 = y15 ^ t0;
+  const uint64_t y11 = y20 ^ y9;
+  const uint64_t y7 = x7 ^ y11;
+  const uint64_t y17 = y10 ^ y11;
+  const uint64_t y19 = y10 ^ y8;
+  const uint64_t y16 = t0 ^ y11;
+  const uint64_t y21 = y13 ^ y16;
+  const uint64_t y18 = x0 ^ y16;
+
+  // Non-linear section
+  const uint64_t t2 = y12 & y15;
+  const uint64_t t3 = y3 & y6;
+  const uint64_t t4 = t3 ^ t2;
+  const uint64_t t5 = y4 & x7;
+  const uint64_t t6 = t5 ^ t2;
+  const uint64_t t7 = y13 & y16;
+  const uint64_t t8 = y5 & y1;
+  const uint64_t t9 = t8 ^ t7;
+  const uint64_t t10 = y2 & y7;
+  const uint64_t t11 = t10 ^ t7;
+  const uint64_t t12 = y9 & y11;
+  const uint64_t t13 = y14 & y17;
+  const uint64_t t14 = t13 ^ t12;
+  const uint64_t t15 = y8 & y10;
+  const uint64_t t16 = t15 ^ t12;
+  const uint64_t t17 = t4 ^ t14;
+  const uint64_t t18 = t6 ^ t16;
+  const uint64_t t19 = t9 ^ t14;
+  const uint64_t t20 = t11 ^ t16;
+  const uint64_t t21 = t17 ^ y20;
+  const uint64_t t22 = t18 ^ y19;
+  const uint64_t t23 = t19 ^ y21;
+  const uint64_t t24 = t20 ^ y18;
+
+  const uint64_t t25 = t21 ^ t22;
+  const uint64_t t26 = t21 & t23;
+  const uint64_t t27 = t24 ^ t26;
+  const uint64_t t28 = t25 & t27;
+  const uint64_t t29 = t28 ^ t22;
+  const uint64_t t30 = t23 ^ t24;
+  const uint64_t t31 = t22 ^ t26;
+  const uint64_t t32 = t31 & t30;
+  const uint64_t t33 = t32 ^ t24;
+  const uint64_t t34 = t23 ^ t33;
+  const uint64_t t35 = t27 ^ t33;
+  const uint64_t t36 = t24 & t35;
+  const uint64_t t37 = t36 ^ t34;
+  const uint64_t t38 = t27 ^ t36;
+  const uint64_t t39 = t29 & t38;
+  const uint64_t t40 = t25 ^ t39;
+
+  const uint64_t t41 = t40 ^ t37;
+  const uint64_t t42 = t29 ^ t33;
+  const uint64_t t43 = t29 ^ t40;
+  const uint64_t t44 = t33 ^ t37;
+  const uint64_t t45 = t42 ^ t41;
+  const uint64_t z0 = t44 & y15;
+  const uint64_t z1 = t37 & y6;
+  const uint64_t z2 = t33 & x7;
+  const uint64_t z3 = t43 & y16;
+  const uint64_t z4 = t40 & y1;
+  const uint64_t z5 = t29 & y7;
+  const uint64_t z6 = t42 & y11;
+  const uint64_t z7 = t45 & y17;
+  const uint64_t z8 = t41 & y10;
+  const uint64_t z9 = t44 & y12;
+  const uint64_t z10 = t37 & y3;
+  const uint64_t z11 = t33 & y4;
+  const uint64_t z12 = t43 & y13;
+  const uint64_t z13 = t40 & y5;
+  const uint64_t z14 = t29 & y2;
+  const uint64_t z15 = t42 & y9;
+  const uint64_t z16 = t45 & y14;
+  const uint64_t z17 = t41 & y8;
+
+  // Bottom linear transformation
+  const uint64_t t46 = z15 ^ z16;
+  const uint64_t t47 = z10 ^ z11;
+  const uint64_t t48 = z5 ^ z13;
+  const uint64_t t49 = z9 ^ z10;
+  const uint64_t t50 = z2 ^ z12;
+  const uint64_t t51 = z2 ^ z5;
+  const uint64_t t52 = z7 ^ z8;
+  const uint64_t t53 = z0 ^ z3;
+  const uint64_t t54 = z6 ^ z7;
+  const uint64_t t55 = z16 ^ z17;
+  const uint64_t t56 = z12 ^ t48;
+  const uint64_t t57 = t50 ^ t53;
+  const uint64_t t58 = z4 ^ t46;
+  const uint64_t t59 = z3 ^ t54;
+  const uint64_t t60 = t46 ^ t57;
+  const uint64_t t61 = z14 ^ t57;
+  const uint64_t t62 = t52 ^ t58;
+  const uint64_t t63 = t49 ^ t58;
+  const uint64_t t64 = z4 ^ t59;
+  const uint64_t t65 = t61 ^ t62;
+  const uint64_t t66 = z1 ^ t63;
+  const uint64_t s0 = t59 ^ t63;
+  const uint64_t s6 = t56 ^ ~t62;
+  const uint64_t s7 = t48 ^ ~t60;
+  const uint64_t t67 = t64 ^ t65;
+  const uint64_t s3 = t53 ^ t66;
+  const uint64_t s4 = t51 ^ t66;
+  const uint64_t s5 = t47 ^ t65;
+  const uint64_t s1 = t64 ^ ~s3;
+  const uint64_t s2 = t55 ^ ~t67;
+
+  q[7] = s0;
+  q[6] = s1;
+  q[5] = s2;
+  q[4] = s3;
+  q[3] = s4;
+  q[2] = s5;
+  q[1] = s6;
+  q[0] = s7;
+}
+
+// Compile-time computes a mask, selecting bits of each bitsliced block, which
+// belong to given row of AES state and whose column index ∈ [cbeg, cend).
+inline constexpr uint64_t
+row_mask(const size_t row, const size_t cbeg, const size_t cend)
+{
+  uint64_t mask = 0;
+
+  for (size_t blk = 0; blk < PAR_BLOCKS; blk++) {
+    for (size_t col = cbeg; col < cend; col++) {
+      mask |= 1ul << (blk * BLOCK_LEN + col * 4 + row);
+    }
+  }
+
+  return mask;
+}
+
+// Given eight bit planes, this routine cyclically shifts row r of each
+// bitsliced AES state left by r bytes, i.e. byte at column c moves to column
+// (c - r) mod 4. Within each 16 -bit group of a plane, that's a rotation of
+// bits of row r, right by 4r bits.
+inline constexpr void
+shift_rows(planes_t& q)
+{
+  for (size_t b = 0; b < q.size(); b++) {
+    const uint64_t x = q[b];
+    uint64_t res = x & row_mask(0, 0, 4);
+
+    res |= ((x & row_mask(1, 1, 4)) >> 4) | ((x & row_mask(1, 0, 1)) << 12);
+    res |= ((x & row_mask(2, 2, 4)) >> 8) | ((x & row_mask(2, 0, 2)) << 8);
+    res |= ((x & row_mask(3, 3, 4)) >> 12) | ((x & row_mask(3, 0, 3)) << 4);
+
+    q[b] = res;
+  }
+}
+
+// Given a bit plane, this routine replaces byte at row r of each column with the
+// one at row (r + k) mod 4, i.e. rotates each 4 -bit group right by k bits.
+template<size_t k>
+inline constexpr uint64_t
+rotate_column(const uint64_t x)
+  requires((k > 0) && (k < 4))
+{
+  constexpr uint64_t mask = 0x1111111111111111ul * (0xful >> k);
+  return ((x >> k) & mask) | ((x << (4 - k)) & ~mask);
+}
+
+// Given eight bit planes, this routine mixes each column of each bitsliced AES
+// state, computing 2 * a_r + 3 * a_{r+1} + a_{r+2} + a_{r+3} over GF(2^8), as
+// 2 * (a_r + a_{r+1}) + a_{r+1} + a_{r+2} + a_{r+3}, where multiplication by 2
+// ( i.e. xtime ) is a fixed linear map on bit planes.
+inline constexpr void
+mix_columns(planes_t& q)
+{
+  planes_t t{};
+  planes_t u{};
+
+  for (size_t b = 0; b < q.size(); b++) {
+    const uint64_t r1 = rotate_column<1>(q[b]);
+
+    t[b] = q[b] ^ r1;
+    u[b] = r1 ^ rotate_column<2>(q[b]) ^ rotate_column<3>(q[b]);
+  }
+
+  // xtime, reducing by x^8 + x^4 + x^3 + x + 1
+  q[0] = t[7] ^ u[0];
+  q[1] = t[0] ^ t[7] ^ u[1];
+  q[2] = t[1] ^ u[2];
+  q[3] = t[2] ^ t[7] ^ u[3];
+  q[4] = t[3] ^ t[7] ^ u[4];
+  q[5] = t[4] ^ u[5];
+  q[6] = t[5] ^ u[6];
+  q[7] = t[6] ^ u[7];
+}
+
+// Given eight bit planes of state and round key, this routine xors them.
+inline constexpr void
+add_round_key(planes_t& q, const planes_t& k)
+{
+  for (size_t b = 0; b < q.size(); b++) {
+    q[b] ^= k[b];
+  }
+}
+
+// Given 64 bytes ( i.e. four AES blocks ), this routine bitslices them into
+// eight bit planes. Bit b of each of the eight bytes of a 64 -bit word is
+// gathered into a single byte, using a multiplication by a magic constant.
+inline constexpr void
+bitslice(const uint8_t* const bytes, planes_t& q)
+{
+  q.fill(0);
+
+  for (size_t w = 0; w < 8; w++) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; i++) {
+      word |= static_cast<uint64_t>(bytes[w * 8 + i]) << (i * 8);
+    }
+
+    for (size_t b = 0; b < q.size(); b++) {
+      const uint64_t bits = (word >> b) & 0x0101010101010101ul;
+      q[b] |= ((bits * 0x0102040810204080ul) >> 56) << (w * 8);
+    }
+  }
+}
+
+// Given eight bit planes, this routine converts them back to 64 bytes, i.e. it's
+// inverse of `bitslice`. Eight bits of a plane are spread over least
+// significant bits of eight bytes, by selecting bit i of i -th replica of them.
+inline constexpr void
+unbitslice(const planes_t& q, uint8_t* const bytes)
+{
+  for (size_t w = 0; w < 8; w++) {
+    uint64_t word = 0;
+
+    for (size_t b = 0; b < q.size(); b++) {
+      const uint64_t bits = ((q[b] >> (w * 8)) & 0xff) * 0x0101010101010101ul;
+      const uint64_t selected = bits & 0x8040201008040201ul;
+      const uint64_t spread = ((selected + 0x7f7f7f7f7f7f7f7ful) >> 7) & 0x0101010101010101ul;
+
+      word |= spread << b;
+    }
+
+    for (size_t i = 0; i < 8; i++) {
+      bytes[w * 8 + i] = static_cast<uint8_t>(word >> (i * 8));
+    }
+  }
+}
+
+// Expanded AES-128 key, both as round key bytes ( as used by AES-NI ) and
+// bitsliced round keys, replicated over all four blocks.
+struct round_keys_t
+{
+  std::array<uint8_t, (ROUNDS + 1) * BLOCK_LEN> bytes{};
+  std::array<planes_t, ROUNDS + 1> planes{};
+};
+
+// Given a 16 -bytes key, this routine expands it into 11 round keys, following
+// section 5.2 of FIPS 197. S-box in SubWord is computed using the bitsliced
+// circuit, so that key expansion also runs in constant-time.
+inline constexpr round_keys_t
+expand_key(std::span<const uint8_t, KEY_LEN> key)
+{
+  constexpr std::array<uint8_t, ROUNDS> rcon = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+  round_keys_t rk{};
+  auto& w = rk.bytes;
+
+  for (size_t i = 0; i < KEY_LEN; i++) {
+    w[i] = key[i];
+  }
+
+  for (size_t i = 4; i < 4 * (ROUNDS + 1); i++) {
+    std::array<uint8_t, 4> tmp = { w[4 * i - 4], w[4 * i - 3], w[4 * i - 2], w[4 * i - 1] };
+
+    if (i % 4 == 0) {
+      // RotWord and then SubWord
+      std::array<uint8_t, PAR_BLOCKS * BLOCK_LEN> buf{};
+      buf[0] = tmp[1];
+      buf[1] = tmp[2];
+      buf[2] = tmp[3];
+      buf[3] = tmp[0];
+
+      planes_t q{};
+      bitslice(buf.data(), q);
+      sub_bytes(q);
+      unbitslice(q, buf.data());
+
+      tmp = { static_cast<uint8_t>(buf[0] ^ rcon[i / 4 - 1]), buf[1], buf[2], buf[3] };
+    }
+
+    for (size_t j = 0; j < 4; j++) {
+      w[4 * i + j] = w[4 * i - 16 + j] ^ tmp[j];
+    }
+  }
+
+  for (size_t r = 0; r <= ROUNDS; r++) {
+    std::array<uint8_t, PAR_BLOCKS * BLOCK_LEN> buf{};
+    for (size_t blk = 0; blk < PAR_BLOCKS; blk++) {
+      for (size_t i = 0; i < BLOCK_LEN; i++) {
+        buf[blk * BLOCK_LEN + i] = w[r * BLOCK_LEN + i];
+      }
+    }
+
+    bitslice(buf.data(), rk.planes[r]);
+  }
+
+  return rk;
+}
+
+// Given expanded key, this routine encrypts four consecutive 16 -bytes blocks,
+// in parallel, following section 5.1 of FIPS 197. Input and output may alias.
+inline constexpr void
+encrypt(const round_keys_t& rk, const uint8_t* const in, uint8_t* const out)
+{
+  planes_t q{};
+  bitslice(in, q);
+
+  add_round_key(q, rk.planes[0]);
+  for (size_t r = 1; r < ROUNDS; r++) {
+    sub_bytes(q);
+    shift_rows(q);
+    mix_columns(q);
+    add_round_key(q, rk.planes[r]);
+  }
+
+  sub_bytes(q);
+  shift_rows(q);
+  add_round_key(q, rk.planes[ROUNDS]);
+
+  unbitslice(q, out);
+}
+
+}
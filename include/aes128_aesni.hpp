@@ -0,0 +1,53 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include "aes128.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AES-NI kernel for encrypting 8 independent AES-128 blocks in parallel
+//
+// AES round instructions have a latency of several cycles, but a throughput of
+// one ( or more ) per cycle, so 8 independent blocks are interleaved, keeping
+// the pipeline full. Blocks of matrix A, in FrodoKEM-AES, are independent of
+// each other, making it a perfect fit.
+//
+// Kernel is compiled for AES-NI, irrespective of flags used for compiling rest
+// of the library, so it must only be invoked when `dispatch::use_aesni()` says
+// the CPU supports it.
+namespace aes128_aesni {
+
+// # -of blocks encrypted in parallel.
+constexpr size_t PAR_BLOCKS = 8;
+
+// Given expanded key and 8 consecutive 16 -bytes blocks, this routine encrypts
+// them, in parallel. Input and output may alias.
+__attribute__((target("aes"))) inline void
+encrypt(const aes128::round_keys_t& rk, const uint8_t* const in, uint8_t* const out)
+{
+  __m128i k[aes128::ROUNDS + 1];
+  __m128i s[PAR_BLOCKS];
+
+  for (size_t r = 0; r <= aes128::ROUNDS; r++) {
+    k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rk.bytes.data() + r * aes128::BLOCK_LEN));
+  }
+
+  for (size_t i = 0; i < PAR_BLOCKS; i++) {
+    s[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * aes128::BLOCK_LEN)), k[0]);
+  }
+
+  for (size_t r = 1; r < aes128::ROUNDS; r++) {
+    for (size_t i = 0; i < PAR_BLOCKS; i++) {
+      s[i] = _mm_aesenc_si128(s[i], k[r]);
+    }
+  }
+
+  for (size_t i = 0; i < PAR_BLOCKS; i++) {
+    s[i] = _mm_aesenclast_si128(s[i], k[aes128::ROUNDS]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * aes128::BLOCK_LEN), s[i]);
+  }
+}
+
+}
+#endif
@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+
+// Runtime selection of SIMD kernels, based on CPU features
+namespace dispatch {
+
+// Instruction set tiers, for which hot kernels ( matrix multiplication with
+// A, packing/ unpacking etc. ) are specialized. Tiers are ordered s.t. a CPU
+// supporting some tier also supports all lower tiers.
+enum class tier_t : uint32_t
+{
+  scalar = 0,
+  avx2 = 1,
+  avx512bw = 2,
+};
+
+// Name of environment variable, which can be used for forcing a specific tier
+// at startup. Accepted values are "scalar", "avx2" and "avx512bw".
+constexpr const char* TIER_ENV_VAR = "FRODOKEM_TIER";
+
+// Returns human readable name of given tier, which is also the value accepted
+// by `FRODOKEM_TIER` environment variable.
+constexpr std::string_view
+tier_name(const tier_t tier)
+{
+  switch (tier) {
+    case tier_t::avx2:
+      return "avx2";
+    case tier_t::avx512bw:
+      return "avx512bw";
+    default:
+      return "scalar";
+  }
+}
+
+// Given name of a tier, returns that tier, if the name is known.
+constexpr std::optional<tier_t>
+parse_tier(std::string_view name)
+{
+  for (const auto tier : { tier_t::scalar, tier_t::avx2, tier_t::avx512bw }) {
+    if (name == tier_name(tier)) {
+      return tier;
+    }
+  }
+
+  return std::nullopt;
+}
+
+// Detects best tier supported by both the CPU and the operating system ( i.e.
+// it has enabled saving of extended register state ), using cpuid.
+inline tier_t
+detect_tier()
+{
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return tier_t::avx512bw;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return tier_t::avx2;
+  }
+#endif
+
+  return tier_t::scalar;
+}
+
+namespace internal {
+
+// Tier selected at startup : the detected one, unless `FRODOKEM_TIER`
+// environment variable asks for a lower tier. Asking for a tier, which isn't
+// supported by this CPU, falls back to the best supported one.
+inline tier_t
+startup_tier()
+{
+  const auto detected = detect_tier();
+  const char* const requested = std::getenv(TIER_ENV_VAR);
+
+  if (requested != nullptr) {
+    if (const auto tier = parse_tier(requested); tier.has_value()) {
+      return std::min(*tier, detected);
+    }
+  }
+
+  return detected;
+}
+
+inline std::atomic<tier_t>&
+active()
+{
+  static std::atomic<tier_t> tier{ startup_tier() };
+  return tier;
+}
+
+}
+
+// Returns tier, whose kernels are currently being used. It's selected once, on
+// first use, and stays the same unless explicitly overridden.
+inline tier_t
+active_tier()
+{
+  return internal::active().load(std::memory_order_relaxed);
+}
+
+// Forces use of kernels of given tier, returning the tier which actually got
+// activated. Requesting a tier, which isn't supported by this CPU, activates
+// the best supported tier instead, so that we never execute an illegal
+// instruction. Useful for testing/ benchmarking all tiers side by side.
+inline tier_t
+force_tier(const tier_t tier)
+{
+  const auto effective = std::min(tier, detect_tier());
+  internal::active().store(effective, std::memory_order_relaxed);
+  return effective;
+}
+
+// Restores the tier, which was selected at startup.
+inline tier_t
+reset_tier()
+{
+  const auto tier = internal::startup_tier();
+  internal::active().store(tier, std::memory_order_relaxed);
+  return tier;
+}
+
+// Detects whether the CPU supports AES-NI instructions, using cpuid.
+inline bool
+detect_aesni()
+{
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("aes");
+#else
+  return false;
+#endif
+}
+
+// Returns whether AES-NI kernel should be used for AES128 based generation of
+// matrix A. AES-NI isn't an instruction set tier of its own, it's used along
+// with any vector tier, while forcing scalar tier also falls back to portable,
+// bitsliced AES implementation, so that it can be tested on any machine.
+inline bool
+use_aesni()
+{
+  static const bool supported = detect_aesni();
+  return supported && (active_tier() != tier_t::scalar);
+}
+
+}
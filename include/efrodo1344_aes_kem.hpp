@@ -0,0 +1,244 @@
+#pragma once
+#include "kem.hpp"
+
+// eFrodo-1344-AES Key Encapsulation Mechanism
+namespace efrodo1344_aes_kem {
+
+// See table A.1, A.2 of FrodoKEM specification. Matrix A is generated using
+// AES128, while all other parameters are same as SHAKE variant.
+constexpr size_t D = 16;
+constexpr size_t n = 1344;
+constexpr size_t n̄ = 8;
+constexpr size_t B = 4;
+constexpr size_t len_A = 128;
+constexpr size_t len_sec = 256;
+constexpr size_t len_SE = 256;
+constexpr size_t len_salt = 0;
+
+// = 21520 -bytes public key
+constexpr auto PUB_KEY_LEN = kem::kem_pub_key_len(n, n̄, len_A, D);
+
+// = 43088 -bytes secret key
+constexpr auto SEC_KEY_LEN = kem::kem_sec_key_len(n, n̄, len_sec, len_A, D);
+
+// = 21632 -bytes cipher text
+constexpr auto CIPHER_LEN = kem::kem_cipher_text_len(n, n̄, len_salt, D);
+
+// Byte length of caller-owned workspaces, which `keygen`, `encaps` and
+// `decaps` overloads, taking one, use for keeping all intermediate matrices
+// off stack. A workspace must be aligned to `kem::WORKSPACE_ALIGNMENT`.
+constexpr auto KEYGEN_WORKSPACE_LEN = kem::keygen_workspace_len<n, n̄, D>();
+constexpr auto ENCAPS_WORKSPACE_LEN = kem::encaps_workspace_len<n, n̄, D>();
+constexpr auto DECAPS_WORKSPACE_LEN = kem::decaps_workspace_len<n, n̄, len_sec, len_A, D, gen_a::prg_t::aes128>();
+
+// Given 32 -bytes seed s ( secret part of private key ), 32 -bytes seed seedSE
+// ( used for sampling error matrices ) and 16 -bytes seed z ( used for deriving
+// pseudo-random seed seedA, which is used for generating matrix A ), this
+// routine can be used for deterministic generation of an eFrodo-1344-AES public/
+// private keypair, following algorithm described in section 8.1 of FrodoKEM
+// specification.
+inline void
+keygen(std::span<const uint8_t, len_sec / 8> s,
+       std::span<const uint8_t, len_SE / 8> seedSE,
+       std::span<const uint8_t, len_A / 8> z,
+       std::span<uint8_t, PUB_KEY_LEN> pkey,
+       std::span<uint8_t, SEC_KEY_LEN> skey)
+{
+  kem::keygen<n, n̄, len_sec, len_SE, len_A, B, D, gen_a::prg_t::aes128>(s, seedSE, z, pkey, skey);
+}
+
+// Given seeds ( s, seedSE, z ) and a workspace of `KEYGEN_WORKSPACE_LEN`
+// -bytes, this routine generates an eFrodo-1344-AES public/ private keypair, exactly
+// as `keygen` does, while keeping all intermediate matrices in the workspace,
+// which can be reused across calls.
+inline void
+keygen(std::span<const uint8_t, len_sec / 8> s,
+       std::span<const uint8_t, len_SE / 8> seedSE,
+       std::span<const uint8_t, len_A / 8> z,
+       std::span<uint8_t, PUB_KEY_LEN> pkey,
+       std::span<uint8_t, SEC_KEY_LEN> skey,
+       std::span<uint8_t, KEYGEN_WORKSPACE_LEN> workspace)
+{
+  kem::keygen<n, n̄, len_sec, len_SE, len_A, B, D, gen_a::prg_t::aes128>(s, seedSE, z, pkey, skey, workspace);
+}
+
+// Seeds ( s, seedSE, z ) and serialized public/ private keypair of one keygen,
+// in a batch.
+using keygen_input = kem::keygen_input_t<len_sec, len_SE, len_A>;
+using keypair = kem::keypair_t<n, n̄, len_sec, len_A, D>;
+
+// Given seeds of 4 independent keypairs, this routine can be used for
+// generating 4 eFrodo-1344-AES public/ private keypairs, exactly as calling `keygen`
+// for each of them, one by one, while running their hashing in SIMD lanes.
+inline void
+keygen_x4(std::span<const keygen_input, 4> inputs, std::span<keypair, 4> keypairs)
+{
+  kem::keygen_x4<n, n̄, len_sec, len_SE, len_A, B, D, gen_a::prg_t::aes128>(inputs, keypairs);
+}
+
+// Given seeds of a batch of independent keypairs, this routine can be used for
+// generating eFrodo-1344-AES public/ private keypair for each of them, exactly as
+// calling `keygen` for each of them, one by one, 4 at a time. Returns how many
+// of them got generated, which is the lesser of both spans' lengths.
+inline size_t
+batch_keygen(std::span<const keygen_input> inputs, std::span<keypair> keypairs)
+{
+  return kem::batch_keygen<n, n̄, len_sec, len_SE, len_A, B, D, gen_a::prg_t::aes128>(inputs, keypairs);
+}
+
+// Given a 32 -bytes key μ ( which is actually encrypted using underlying PKE
+// scheme ) and an eFrodo-1344-AES KEM public key, this routine can be used for
+// computing a cipher text ( which can only be decrypted using corresponding
+// eFrodo-1344-AES KEM private key ) and a 32 -bytes shared secret, following
+// algorithm described in section 8.2 of FrodoKEM specification.
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ, std::span<const uint8_t, PUB_KEY_LEN> pkey, std::span<uint8_t, CIPHER_LEN> enc, std::span<uint8_t, len_sec / 8> ss)
+{
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(μ, std::span<uint8_t, len_salt / 8>{}, pkey, enc, ss);
+}
+
+// Given key μ, an eFrodo-1344-AES KEM public key and a workspace of
+// `ENCAPS_WORKSPACE_LEN` -bytes, this routine computes a cipher text and a
+// shared secret, exactly as `encaps` does, while keeping all intermediate
+// matrices in the workspace, which can be reused across calls.
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       std::span<const uint8_t, PUB_KEY_LEN> pkey,
+       std::span<uint8_t, CIPHER_LEN> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, ENCAPS_WORKSPACE_LEN> workspace)
+{
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(μ, std::span<uint8_t, len_salt / 8>{}, pkey, enc, ss, workspace);
+}
+
+// eFrodo-1344-AES KEM public key, parsed once, for repeated encapsulation to the same
+// peer. Construct it from a serialized public key. It's immutable, so it can be
+// shared across threads.
+using prepared_public_key = kem::prepared_public_key<n, n̄, len_sec, len_A, D, gen_a::prg_t::aes128>;
+
+// Given a 32 -bytes key μ and a prepared eFrodo-1344-AES KEM public key, this
+// routine can be used for computing a cipher text and a 32 -bytes shared
+// secret, exactly as `encaps` does with serialized public key, while skipping
+// per-call parsing of the public key.
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ, const prepared_public_key& ppk, std::span<uint8_t, CIPHER_LEN> enc, std::span<uint8_t, len_sec / 8> ss)
+{
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(μ, std::span<uint8_t, len_salt / 8>{}, ppk, enc, ss);
+}
+
+// Given key μ, a prepared eFrodo-1344-AES KEM public key and a workspace of
+// `ENCAPS_WORKSPACE_LEN` -bytes, this routine computes a cipher text and a
+// shared secret, exactly as `encaps` does, while keeping all intermediate
+// matrices in the workspace, which can be reused across calls.
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       const prepared_public_key& ppk,
+       std::span<uint8_t, CIPHER_LEN> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, ENCAPS_WORKSPACE_LEN> workspace)
+{
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(μ, std::span<uint8_t, len_salt / 8>{}, ppk, enc, ss, workspace);
+}
+
+// Inputs ( μ, salt ) and outputs ( cipher text, shared secret ) of one
+// encapsulation, in a batch.
+using encaps_input = kem::encaps_input_t<len_sec, len_salt>;
+using encaps_output = kem::encaps_output_t<n, n̄, len_sec, len_salt, D>;
+
+// Given a batch of 32 -bytes keys μ and a prepared eFrodo-1344-AES KEM public key,
+// this routine can be used for computing a cipher text and a 32 -bytes shared
+// secret for each of them, exactly as calling `encaps` for each of them, one by
+// one, while generating matrix A only once, for the whole batch. Salts of
+// inputs are empty. Returns how many of them got computed, which is the lesser
+// of both spans' lengths.
+inline size_t
+batch_encaps(const prepared_public_key& ppk, std::span<const encaps_input> inputs, std::span<encaps_output> outputs)
+{
+  return kem::batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(ppk, inputs, outputs);
+}
+
+// Given 4 eFrodo-1344-AES KEM public keys ( possibly all distinct ), along with keys μ
+// and salts for each of them, this routine can be used for computing a cipher
+// text and a shared secret for each of them, exactly as calling `encaps` for
+// each of them, one by one, while running their hashing in SIMD lanes.
+inline void
+encaps_x4(std::span<const std::span<const uint8_t, PUB_KEY_LEN>, 4> pkeys, std::span<const encaps_input, 4> inputs, std::span<encaps_output, 4> outputs)
+{
+  kem::encaps_x4<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(pkeys, inputs, outputs);
+}
+
+// Given a batch of eFrodo-1344-AES KEM public keys ( possibly all distinct ), along with
+// keys μ and salts for each of them, this routine can be used for computing a
+// cipher text and a shared secret for each of them, exactly as calling `encaps`
+// for each of them, one by one, 4 at a time. Returns how many of them got
+// computed, which is the least of all spans' lengths.
+inline size_t
+multi_encaps(std::span<const std::span<const uint8_t, PUB_KEY_LEN>> pkeys, std::span<const encaps_input> inputs, std::span<encaps_output> outputs)
+{
+  return kem::multi_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(pkeys, inputs, outputs);
+}
+
+// Given an eFrodo-1344-AES KEM secret key, which is associated with the public key,
+// using which the cipher text was computed and the cipher text as input, this
+// routine can be used for decrypting the cipher text, recovering 32 -bytes
+// shared secret, following algorithm described in section 8.3 of FrodoKEM
+// specification.
+inline void
+decaps(std::span<const uint8_t, SEC_KEY_LEN> skey, std::span<const uint8_t, CIPHER_LEN> enc, std::span<uint8_t, len_sec / 8> ss)
+{
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(skey, enc, ss);
+}
+
+// Given an eFrodo-1344-AES KEM secret key, a cipher text and a workspace of
+// `DECAPS_WORKSPACE_LEN` -bytes, this routine recovers shared secret, exactly
+// as `decaps` does, while keeping all intermediate matrices in the workspace,
+// which can be reused across calls.
+inline void
+decaps(std::span<const uint8_t, SEC_KEY_LEN> skey,
+       std::span<const uint8_t, CIPHER_LEN> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, DECAPS_WORKSPACE_LEN> workspace)
+{
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(skey, enc, ss, workspace);
+}
+
+// eFrodo-1344-AES KEM secret key, parsed once, for repeated decapsulation. Construct it
+// from a serialized secret key. It's immutable, so it can be shared across
+// threads.
+using prepared_secret_key = kem::prepared_secret_key<n, n̄, len_sec, len_A, D, gen_a::prg_t::aes128>;
+
+// Given a prepared eFrodo-1344-AES KEM secret key and a cipher text, this routine can
+// be used for decrypting the cipher text, recovering 32 -bytes shared secret,
+// exactly as `decaps` does with serialized secret key, while skipping per-call
+// parsing of the secret key.
+inline void
+decaps(const prepared_secret_key& psk, std::span<const uint8_t, CIPHER_LEN> enc, std::span<uint8_t, len_sec / 8> ss)
+{
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(psk, enc, ss);
+}
+
+// Given a prepared eFrodo-1344-AES KEM secret key, a cipher text and a workspace of
+// `DECAPS_WORKSPACE_LEN` -bytes, this routine recovers shared secret, exactly
+// as `decaps` does, while keeping all intermediate matrices in the workspace,
+// which can be reused across calls.
+inline void
+decaps(const prepared_secret_key& psk,
+       std::span<const uint8_t, CIPHER_LEN> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, DECAPS_WORKSPACE_LEN> workspace)
+{
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(psk, enc, ss, workspace);
+}
+
+// Given a prepared eFrodo-1344-AES KEM secret key and a batch of cipher texts, this
+// routine can be used for recovering 32 -bytes shared secret of each of them,
+// exactly as calling `decaps` for each of them, one by one, while generating
+// matrix A only once, for the whole batch. Returns how many of them got
+// recovered, which is the lesser of both spans' lengths.
+inline size_t
+batch_decaps(const prepared_secret_key& psk, std::span<const std::span<const uint8_t, CIPHER_LEN>> encs, std::span<const std::span<uint8_t, len_sec / 8>> sss)
+{
+  return kem::batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, gen_a::prg_t::aes128>(psk, encs, sss);
+}
+
+}
@@ -0,0 +1,251 @@
+#pragma once
+#include "aes128.hpp"
+#include "aes128_aesni.hpp"
+#include "dispatch.hpp"
+#include "keccak_avx2.hpp"
+#include "keccak_avx512.hpp"
+#include "shake128.hpp"
+#include "zq.hpp"
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <variant>
+
+// Pseudorandom generation of public matrix A, one row at a time
+namespace gen_a {
+
+// Pseudorandom generator used for expanding seedA into matrix A, following
+// section 7.6 of FrodoKEM specification. FrodoKEM-SHAKE and FrodoKEM-AES
+// parameter sets differ only in this choice.
+enum class prg_t : uint32_t
+{
+  shake128 = 0,
+  aes128 = 1,
+};
+
+// Given a seed of length len_seed_A -bits and a row index i ∈ [0, n), this
+// routine can be used for deterministically generating i -th row of the
+// pseudorandom matrix A of dimension n x n, using SHAKE128 XOF, following
+// algorithm described in section 7.6.2 of FrodoKEM specification.
+//
+// Generating A row by row lets its consumers use each row while it's still hot
+// in L1 cache and then throw it away, instead of materializing full n x n
+// matrix, which is 0.8 - 3.5 MB, depending on parameter set.
+template<size_t n, size_t len_seed_A, size_t D>
+inline void
+generate_row(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const size_t ridx, std::span<zq::zq_t<D>, n> row)
+{
+  constexpr size_t row_byte_len = 2 * n;
+
+  std::array<uint8_t, 2 + seed.size()> buf{};
+  std::memcpy(buf.data() + 2, seed.data(), seed.size());
+
+  buf[0] = (static_cast<uint16_t>(ridx) >> 0) & 0xff;
+  buf[1] = (static_cast<uint16_t>(ridx) >> 8) & 0xff;
+
+  shake128::shake128_t hasher{};
+
+  hasher.absorb(buf);
+  hasher.finalize();
+  hasher.squeeze(std::span(reinterpret_cast<uint8_t*>(row.data()), row_byte_len));
+}
+
+#if defined(__x86_64__)
+namespace internal {
+
+// Given a seed of length len_seed_A -bits and a row index i, this routine
+// generates `lanes` -many consecutive rows of A, starting at row i, in parallel,
+// using multi-lane SHAKE128 kernel of matching width.
+template<size_t n, size_t len_seed_A, size_t D, size_t lanes>
+inline void
+generate_row_batch(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const size_t ridx, zq::zq_t<D>* const rows)
+{
+  constexpr size_t msg_len = 2 + seed.size();
+  constexpr size_t row_byte_len = 2 * n;
+
+  std::array<std::array<uint8_t, msg_len>, lanes> bufs{};
+  std::array<const uint8_t*, lanes> msgs{};
+  std::array<uint8_t*, lanes> outs{};
+
+  for (size_t j = 0; j < lanes; j++) {
+    bufs[j][0] = (static_cast<uint16_t>(ridx + j) >> 0) & 0xff;
+    bufs[j][1] = (static_cast<uint16_t>(ridx + j) >> 8) & 0xff;
+    std::memcpy(bufs[j].data() + 2, seed.data(), seed.size());
+
+    msgs[j] = bufs[j].data();
+    outs[j] = reinterpret_cast<uint8_t*>(rows + j * n);
+  }
+
+  if constexpr (lanes == keccak_avx512::LANES) {
+    keccak_avx512::shake128<msg_len>(msgs, outs, row_byte_len);
+  } else {
+    keccak_avx2::shake128<msg_len>(msgs, outs, row_byte_len);
+  }
+}
+
+}
+#endif
+
+// Given a seed of length len_seed_A -bits and a row index i ∈ [0, n), this
+// routine can be used for deterministically generating `count` -many
+// consecutive rows of the pseudorandom matrix A, starting at row i, producing
+// exactly same output as calling `generate_row` for each of them.
+//
+// As each row is an independent SHAKE128 XOF, rows are generated 8 or 4 at a
+// time, running Keccak-f[1600] in SIMD lanes, when the active instruction set
+// tier allows it. Rest of the rows ( if any ) are generated one by one.
+template<size_t n, size_t len_seed_A, size_t D, size_t count>
+inline void
+generate_rows(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const size_t ridx, std::span<zq::zq_t<D>, count * n> rows)
+{
+  size_t r = 0;
+
+#if defined(__x86_64__)
+  if constexpr (2 + seed.size() < keccak::SHAKE128_RATE) {
+    constexpr size_t x8 = keccak_avx512::LANES;
+    constexpr size_t x4 = keccak_avx2::LANES;
+
+    switch (dispatch::active_tier()) {
+      case dispatch::tier_t::avx512bw:
+        for (; r + x8 <= count; r += x8) {
+          internal::generate_row_batch<n, len_seed_A, D, x8>(seed, ridx + r, rows.data() + r * n);
+        }
+        [[fallthrough]];
+      case dispatch::tier_t::avx2:
+        for (; r + x4 <= count; r += x4) {
+          internal::generate_row_batch<n, len_seed_A, D, x4>(seed, ridx + r, rows.data() + r * n);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+
+  for (; r < count; r++) {
+    generate_row<n, len_seed_A, D>(seed, ridx + r, std::span<zq::zq_t<D>, n>(rows.data() + r * n, n));
+  }
+}
+
+// Given expanded AES-128 key ( i.e. seedA ) and a row index i ∈ [0, n), this
+// routine can be used for deterministically generating `count` -many
+// consecutive rows of the pseudorandom matrix A, starting at row i, using
+// AES128, following algorithm described in section 7.6.1 of FrodoKEM
+// specification.
+//
+// Each 16 -bytes block (i || j || 0^96), with i and j as little-endian 16 -bit
+// row and column indices | j % 8 == 0, is encrypted to produce elements
+// A[i][j .. j + 8). As all blocks are independent, plaintexts are laid out in
+// place of the rows and encrypted in groups of 8 ( using AES-NI ) or 4 ( using
+// constant-time, bitsliced software implementation ).
+template<size_t n, size_t D, size_t count>
+inline void
+generate_rows_aes(const aes128::round_keys_t& rk, const size_t ridx, std::span<zq::zq_t<D>, count * n> rows)
+  requires(n % 8 == 0)
+{
+  constexpr size_t blk_len = aes128::BLOCK_LEN;
+  constexpr size_t blks_per_row = n / 8;
+  constexpr size_t blk_cnt = count * blks_per_row;
+
+  auto bytes = reinterpret_cast<uint8_t*>(rows.data());
+
+  for (size_t g = 0; g < blk_cnt; g++) {
+    const auto i = static_cast<uint16_t>(ridx + g / blks_per_row);
+    const auto j = static_cast<uint16_t>((g % blks_per_row) * 8);
+
+    uint8_t* const blk = bytes + g * blk_len;
+    std::memset(blk, 0, blk_len);
+
+    blk[0] = (i >> 0) & 0xff;
+    blk[1] = (i >> 8) & 0xff;
+    blk[2] = (j >> 0) & 0xff;
+    blk[3] = (j >> 8) & 0xff;
+  }
+
+  size_t g = 0;
+
+#if defined(__x86_64__)
+  if (dispatch::use_aesni()) {
+    constexpr size_t x8 = aes128_aesni::PAR_BLOCKS;
+
+    for (; g + x8 <= blk_cnt; g += x8) {
+      aes128_aesni::encrypt(rk, bytes + g * blk_len, bytes + g * blk_len);
+    }
+  }
+#endif
+
+  constexpr size_t x4 = aes128::PAR_BLOCKS;
+
+  for (; g + x4 <= blk_cnt; g += x4) {
+    aes128::encrypt(rk, bytes + g * blk_len, bytes + g * blk_len);
+  }
+
+  if (g < blk_cnt) {
+    std::array<uint8_t, x4 * blk_len> tmp{};
+    const size_t tail_len = (blk_cnt - g) * blk_len;
+
+    std::memcpy(tmp.data(), bytes + g * blk_len, tail_len);
+    aes128::encrypt(rk, tmp.data(), tmp.data());
+    std::memcpy(bytes + g * blk_len, tmp.data(), tail_len);
+  }
+}
+
+// Generator of rows of pseudorandom matrix A, for a fixed seedA, using chosen
+// PRG. For AES128, seedA is expanded into round keys only once, when the
+// generator is constructed, and reused for all rows.
+template<size_t n, size_t len_seed_A, size_t D, prg_t prg = prg_t::shake128>
+struct row_generator_t
+{
+private:
+  std::array<uint8_t, (len_seed_A + 7) / 8> seed{};
+  std::conditional_t<prg == prg_t::aes128, aes128::round_keys_t, std::monostate> rk{};
+
+public:
+  explicit row_generator_t(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+    requires((prg == prg_t::shake128) || (len_seed_A == aes128::KEY_LEN * 8))
+  {
+    std::copy(seed.begin(), seed.end(), this->seed.begin());
+
+    if constexpr (prg == prg_t::aes128) {
+      this->rk = aes128::expand_key(seed);
+    }
+  }
+
+  // Given a row index i ∈ [0, n), this routine generates `count` -many
+  // consecutive rows of A, starting at row i.
+  template<size_t count>
+  inline void generate(const size_t ridx, std::span<zq::zq_t<D>, count * n> rows) const
+  {
+    if constexpr (prg == prg_t::aes128) {
+      generate_rows_aes<n, D, count>(this->rk, ridx, rows);
+    } else {
+      generate_rows<n, len_seed_A, D, count>(this->seed, ridx, rows);
+    }
+  }
+
+  // Given a row index i ∈ [0, n) and scratch space, this routine generates
+  // `count` -many consecutive rows of A, starting at row i, into the scratch
+  // space, returning a view of them. See `row_source`.
+  template<size_t count>
+  inline std::span<const zq::zq_t<D>, count * n> rows(const size_t ridx, std::span<zq::zq_t<D>, count * n> scratch) const
+  {
+    this->generate<count>(ridx, scratch);
+    return scratch;
+  }
+};
+
+// A source of rows of matrix A, of dimension n x n, which is what kernels
+// multiplying with A consume. Given a row index and scratch space for `count`
+// -many rows, a source either generates rows into the scratch space ( see
+// `row_generator_t` ) or returns a view into an already materialized matrix A,
+// ignoring the scratch space.
+template<typename T, size_t n, size_t D>
+concept row_source = requires(const T& src, const size_t ridx, std::span<zq::zq_t<D>, n> scratch) {
+  { src.template rows<1>(ridx, scratch) } -> std::same_as<std::span<const zq::zq_t<D>, n>>;
+};
+
+}
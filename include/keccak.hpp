@@ -0,0 +1,137 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Constants and helpers shared by multi-lane Keccak-f[1600] kernels
+//
+// Each row of pseudorandom matrix A is an independent SHAKE128 XOF, on
+// (row index || seedA), so rows can be generated in parallel, by running
+// multiple Keccak-f[1600] permutations in SIMD lanes. Those kernels only ever
+// need a message which fits in a single block of SHAKE128, which keeps them
+// simple. Generating independent keypairs in lockstep needs general SHAKE128
+// and SHAKE256, with messages and outputs spanning many blocks, for which
+// rate generic helpers are provided too.
+namespace keccak {
+
+// # -of rounds of Keccak-f[1600] permutation.
+constexpr size_t ROUNDS = 24;
+
+// # -of 64 -bit lanes in Keccak-f[1600] state.
+constexpr size_t LANE_CNT = 25;
+
+// Rate of SHAKE128 XOF, in bytes.
+constexpr size_t SHAKE128_RATE = 168;
+
+// # -of 64 -bit lanes in rate portion of SHAKE128 state.
+constexpr size_t SHAKE128_RATE_LANES = SHAKE128_RATE / 8;
+
+// Rate of SHAKE256 XOF, in bytes.
+constexpr size_t SHAKE256_RATE = 136;
+
+// Domain separator of SHAKE128 XOF, with first bit of pad10*1 rule appended.
+constexpr uint8_t SHAKE128_DS = 0x1f;
+
+// Domain separator of SHAKE256 XOF, which is same as SHAKE128's.
+constexpr uint8_t SHAKE256_DS = SHAKE128_DS;
+
+// Round constants of Keccak-f[1600] permutation, applied in ι step.
+constexpr std::array<uint64_t, ROUNDS> RC = {
+  0x0000000000000001ul, 0x0000000000008082ul, 0x800000000000808aul, 0x8000000080008000ul, 0x000000000000808bul, 0x0000000080000001ul,
+  0x8000000080008081ul, 0x8000000000008009ul, 0x000000000000008aul, 0x0000000000000088ul, 0x0000000080008009ul, 0x000000008000000aul,
+  0x000000008000808bul, 0x800000000000008bul, 0x8000000000008089ul, 0x8000000000008003ul, 0x8000000000008002ul, 0x8000000000000080ul,
+  0x000000000000800aul, 0x800000008000000aul, 0x8000000080008081ul, 0x8000000000008080ul, 0x0000000080000001ul, 0x8000000080008008ul,
+};
+
+// Given a message of `msg_len` -bytes, which fits in a single block of
+// SHAKE128, this routine computes the padded block, as 21 little-endian 64 -bit
+// lanes, ready to be absorbed into an all-zero Keccak-f[1600] state.
+template<size_t msg_len>
+inline void
+shake128_pad_block(const uint8_t* const msg, std::array<uint64_t, SHAKE128_RATE_LANES>& lanes)
+  requires(msg_len < SHAKE128_RATE)
+{
+  std::array<uint8_t, SHAKE128_RATE> blk{};
+
+  std::memcpy(blk.data(), msg, msg_len);
+  blk[msg_len] ^= SHAKE128_DS;
+  blk[SHAKE128_RATE - 1] ^= 0x80;
+
+  for (size_t i = 0; i < SHAKE128_RATE_LANES; i++) {
+    uint64_t lane = 0;
+    for (size_t b = 0; b < 8; b++) {
+      lane |= static_cast<uint64_t>(blk[i * 8 + b]) << (b * 8);
+    }
+
+    lanes[i] = lane;
+  }
+}
+
+// Given lanes of rate portion of a SHAKE128 state, this routine writes them as
+// little-endian bytes, copying only first `len` ( <= 168 ) -bytes to output.
+inline void
+shake128_squeeze_block(const std::array<uint64_t, SHAKE128_RATE_LANES>& lanes, uint8_t* const out, const size_t len)
+{
+  std::array<uint8_t, SHAKE128_RATE> blk{};
+
+  for (size_t i = 0; i < SHAKE128_RATE_LANES; i++) {
+    for (size_t b = 0; b < 8; b++) {
+      blk[i * 8 + b] = static_cast<uint8_t>(lanes[i] >> (b * 8));
+    }
+  }
+
+  std::memcpy(out, blk.data(), len);
+}
+
+// Given `rate / 8` -many little-endian 64 -bit words, this routine loads them
+// as lanes, for absorbing a full block of message into Keccak-f[1600] state.
+template<size_t rate>
+inline void
+load_block(const uint8_t* const blk, std::array<uint64_t, rate / 8>& lanes)
+{
+  for (size_t i = 0; i < rate / 8; i++) {
+    uint64_t lane = 0;
+    for (size_t b = 0; b < 8; b++) {
+      lane |= static_cast<uint64_t>(blk[i * 8 + b]) << (b * 8);
+    }
+
+    lanes[i] = lane;
+  }
+}
+
+// Given last `len` ( < rate ) -bytes of a message, this routine computes the
+// padded final block, applying SHAKE domain separator and pad10*1 rule, as
+// lanes, ready to be absorbed.
+template<size_t rate>
+inline void
+pad_block(const uint8_t* const msg, const size_t len, std::array<uint64_t, rate / 8>& lanes)
+{
+  std::array<uint8_t, rate> blk{};
+
+  std::memcpy(blk.data(), msg, len);
+  blk[len] ^= SHAKE128_DS;
+  blk[rate - 1] ^= 0x80;
+
+  load_block<rate>(blk.data(), lanes);
+}
+
+// Given lanes of rate portion of a Keccak-f[1600] state, this routine writes
+// them as little-endian bytes, copying only first `len` ( <= rate ) -bytes to
+// output.
+template<size_t rate>
+inline void
+squeeze_block(const std::array<uint64_t, rate / 8>& lanes, uint8_t* const out, const size_t len)
+{
+  std::array<uint8_t, rate> blk{};
+
+  for (size_t i = 0; i < rate / 8; i++) {
+    for (size_t b = 0; b < 8; b++) {
+      blk[i * 8 + b] = static_cast<uint8_t>(lanes[i] >> (b * 8));
+    }
+  }
+
+  std::memcpy(out, blk.data(), len);
+}
+
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include "keccak.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX2 kernels for computing 4 instances of Keccak-f[1600] in parallel
+//
+// Keccak-f[1600] state of 4 independent instances is kept interleaved s.t.
+// i -th 64 -bit lane of instance j lives in 64 -bit word j of i -th vector,
+// so that each step of the permutation is applied to all 4 instances at
+// once, using exactly the same instruction sequence as a scalar
+// implementation would use for a single instance.
+//
+// Kernels are compiled for AVX2, irrespective of flags used for compiling
+// rest of the library, so they must only be invoked when
+// `dispatch::active_tier()` says the CPU supports AVX2.
+namespace keccak_avx2 {
+
+// # -of Keccak-f[1600] instances processed in parallel.
+constexpr size_t LANES = 4;
+
+// Rotates each 64 -bit word of a vector left by `r` -bits.
+template<int r>
+__attribute__((target("avx2"))) inline __m256i
+rotl(const __m256i x)
+{
+  return _mm256_or_si256(_mm256_slli_epi64(x, r), _mm256_srli_epi64(x, 64 - r));
+}
+
+// Applies Keccak-f[1600] permutation on 4 interleaved states, following
+// section 3.3 of SHA3 specification https://dx.doi.org/10.6028/NIST.FIPS.202.
+__attribute__((target("avx2"))) inline void
+permute(__m256i* const __restrict a)
+{
+  __m256i b[keccak::LANE_CNT];
+  __m256i c[5];
+  __m256i d[5];
+
+  for (size_t rnd = 0; rnd < keccak::ROUNDS; rnd++) {
+    // θ step
+    for (size_t x = 0; x < 5; x++) {
+      c[x] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a[x], a[x + 5]), _mm256_xor_si256(a[x + 10], a[x + 15])), a[x + 20]);
+    }
+    for (size_t x = 0; x < 5; x++) {
+      d[x] = _mm256_xor_si256(c[(x + 4) % 5], rotl<1>(c[(x + 1) % 5]));
+    }
+    for (size_t i = 0; i < keccak::LANE_CNT; i++) {
+      a[i] = _mm256_xor_si256(a[i], d[i % 5]);
+    }
+
+    // ρ and π steps
+    b[0] = a[0];
+    b[1] = rotl<44>(a[6]);
+    b[2] = rotl<43>(a[12]);
+    b[3] = rotl<21>(a[18]);
+    b[4] = rotl<14>(a[24]);
+    b[5] = rotl<28>(a[3]);
+    b[6] = rotl<20>(a[9]);
+    b[7] = rotl<3>(a[10]);
+    b[8] = rotl<45>(a[16]);
+    b[9] = rotl<61>(a[22]);
+    b[10] = rotl<1>(a[1]);
+    b[11] = rotl<6>(a[7]);
+    b[12] = rotl<25>(a[13]);
+    b[13] = rotl<8>(a[19]);
+    b[14] = rotl<18>(a[20]);
+    b[15] = rotl<27>(a[4]);
+    b[16] = rotl<36>(a[5]);
+    b[17] = rotl<10>(a[11]);
+    b[18] = rotl<15>(a[17]);
+    b[19] = rotl<56>(a[23]);
+    b[20] = rotl<62>(a[2]);
+    b[21] = rotl<55>(a[8]);
+    b[22] = rotl<39>(a[14]);
+    b[23] = rotl<41>(a[15]);
+    b[24] = rotl<2>(a[21]);
+
+    // χ step
+    for (size_t y = 0; y < 25; y += 5) {
+      for (size_t x = 0; x < 5; x++) {
+        a[y + x] = _mm256_xor_si256(b[y + x], _mm256_andnot_si256(b[y + (x + 1) % 5], b[y + (x + 2) % 5]));
+      }
+    }
+
+    // ι step
+    a[0] = _mm256_xor_si256(a[0], _mm256_set1_epi64x(static_cast<int64_t>(keccak::RC[rnd])));
+  }
+}
+
+// Given 4 messages, each of `msg_len` -bytes, fitting in a single block of
+// SHAKE128, this routine computes `out_len` -bytes of SHAKE128 output for each
+// of them, in parallel.
+template<size_t msg_len>
+__attribute__((target("avx2"))) inline void
+shake128(const std::array<const uint8_t*, LANES>& msgs, const std::array<uint8_t*, LANES>& outs, const size_t out_len)
+  requires(msg_len < keccak::SHAKE128_RATE)
+{
+  std::array<std::array<uint64_t, keccak::SHAKE128_RATE_LANES>, LANES> lanes{};
+  for (size_t j = 0; j < LANES; j++) {
+    keccak::shake128_pad_block<msg_len>(msgs[j], lanes[j]);
+  }
+
+  __m256i a[keccak::LANE_CNT];
+  for (size_t i = 0; i < keccak::SHAKE128_RATE_LANES; i++) {
+    a[i] = _mm256_setr_epi64x(static_cast<int64_t>(lanes[0][i]), static_cast<int64_t>(lanes[1][i]), static_cast<int64_t>(lanes[2][i]), static_cast<int64_t>(lanes[3][i]));
+  }
+  for (size_t i = keccak::SHAKE128_RATE_LANES; i < keccak::LANE_CNT; i++) {
+    a[i] = _mm256_setzero_si256();
+  }
+
+  for (size_t off = 0; off < out_len; off += keccak::SHAKE128_RATE) {
+    permute(a);
+
+    for (size_t i = 0; i < keccak::SHAKE128_RATE_LANES; i++) {
+      alignas(32) std::array<uint64_t, LANES> words;
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words.data()), a[i]);
+
+      for (size_t j = 0; j < LANES; j++) {
+        lanes[j][i] = words[j];
+      }
+    }
+
+    const size_t len = std::min(keccak::SHAKE128_RATE, out_len - off);
+    for (size_t j = 0; j < LANES; j++) {
+      keccak::shake128_squeeze_block(lanes[j], outs[j] + off, len);
+    }
+  }
+}
+
+// Given a block of `rate_lanes` -many 64 -bit lanes of each of 4 messages, this
+// routine xors them into first `rate_lanes` -many lanes of 4 interleaved states.
+template<size_t rate_lanes>
+__attribute__((target("avx2"))) inline void
+absorb_block(const std::array<std::array<uint64_t, rate_lanes>, LANES>& lanes, __m256i* const __restrict a)
+{
+  for (size_t i = 0; i < rate_lanes; i++) {
+    const auto v = _mm256_setr_epi64x(static_cast<int64_t>(lanes[0][i]), static_cast<int64_t>(lanes[1][i]), static_cast<int64_t>(lanes[2][i]), static_cast<int64_t>(lanes[3][i]));
+    a[i] = _mm256_xor_si256(a[i], v);
+  }
+}
+
+// Given 4 messages, each of `msg_len` -bytes, of arbitrary length, this routine
+// computes `out_len` -bytes of SHAKE output for each of them, in parallel, where
+// `rate` picks SHAKE128 or SHAKE256. Unlike `shake128`, which only absorbs a
+// single block, this one is meant for XOFs of independent keypairs, which are
+// computed in lockstep.
+template<size_t rate>
+__attribute__((target("avx2"))) inline void
+shake(const std::array<const uint8_t*, LANES>& msgs, const size_t msg_len, const std::array<uint8_t*, LANES>& outs, const size_t out_len)
+  requires((rate == keccak::SHAKE128_RATE) || (rate == keccak::SHAKE256_RATE))
+{
+  constexpr size_t rate_lanes = rate / 8;
+
+  std::array<std::array<uint64_t, rate_lanes>, LANES> lanes{};
+
+  __m256i a[keccak::LANE_CNT];
+  for (size_t i = 0; i < keccak::LANE_CNT; i++) {
+    a[i] = _mm256_setzero_si256();
+  }
+
+  size_t off = 0;
+  for (; off + rate <= msg_len; off += rate) {
+    for (size_t j = 0; j < LANES; j++) {
+      keccak::load_block<rate>(msgs[j] + off, lanes[j]);
+    }
+
+    absorb_block<rate_lanes>(lanes, a);
+    permute(a);
+  }
+
+  for (size_t j = 0; j < LANES; j++) {
+    keccak::pad_block<rate>(msgs[j] + off, msg_len - off, lanes[j]);
+  }
+  absorb_block<rate_lanes>(lanes, a);
+
+  for (off = 0; off < out_len; off += rate) {
+    permute(a);
+
+    for (size_t i = 0; i < rate_lanes; i++) {
+      alignas(32) std::array<uint64_t, LANES> words;
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words.data()), a[i]);
+
+      for (size_t j = 0; j < LANES; j++) {
+        lanes[j][i] = words[j];
+      }
+    }
+
+    const size_t len = std::min(rate, out_len - off);
+    for (size_t j = 0; j < LANES; j++) {
+      keccak::squeeze_block<rate>(lanes[j], outs[j] + off, len);
+    }
+  }
+}
+
+// Incremental SHAKE of 4 independent messages, absorbed and squeezed in
+// lockstep, where `rate` picks SHAKE128 or SHAKE256. Messages are absorbed, in
+// any number of calls, each taking same number of bytes of all 4 of them,
+// until `finalize` is called, after which output of all 4 instances can be
+// squeezed, in any number of calls, each continuing from where the previous
+// one stopped.
+//
+// Interleaved state is kept in memory and is only loaded into vector registers
+// for permuting it, so that this type can be constructed, copied and stored by
+// code, which isn't compiled for AVX2.
+template<size_t rate>
+struct shake_x4_t
+{
+  static_assert((rate == keccak::SHAKE128_RATE) || (rate == keccak::SHAKE256_RATE));
+
+private:
+  static constexpr size_t rate_lanes = rate / 8;
+
+  // i -th lane of instance j lives at index i * LANES + j.
+  alignas(32) std::array<uint64_t, keccak::LANE_CNT * LANES> state{};
+
+  // Partially absorbed block of each message, before finalization, or last
+  // squeezed block of output of each instance, after it.
+  std::array<std::array<uint8_t, rate>, LANES> blks{};
+  size_t off = 0;
+
+  // Applies Keccak-f[1600] permutation on interleaved state.
+  __attribute__((target("avx2"))) inline void permute_state()
+  {
+    __m256i a[keccak::LANE_CNT];
+    for (size_t i = 0; i < keccak::LANE_CNT; i++) {
+      a[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(this->state.data() + i * LANES));
+    }
+
+    permute(a);
+
+    for (size_t i = 0; i < keccak::LANE_CNT; i++) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(this->state.data() + i * LANES), a[i]);
+    }
+  }
+
+  // Xors first `rate_lanes` -many lanes of each instance into interleaved state.
+  inline void xor_lanes(const std::array<std::array<uint64_t, rate_lanes>, LANES>& lanes)
+  {
+    for (size_t i = 0; i < rate_lanes; i++) {
+      for (size_t j = 0; j < LANES; j++) {
+        this->state[i * LANES + j] ^= lanes[j][i];
+      }
+    }
+  }
+
+public:
+  // Given `len` -bytes of each of 4 messages, this routine absorbs them into
+  // respective instances, permuting them, each time a block is filled up.
+  inline void absorb(const std::array<const uint8_t*, LANES>& msgs, const size_t len)
+  {
+    std::array<std::array<uint64_t, rate_lanes>, LANES> lanes{};
+
+    size_t done = 0;
+    while (done < len) {
+      const size_t take = std::min(rate - this->off, len - done);
+      for (size_t j = 0; j < LANES; j++) {
+        std::copy_n(msgs[j] + done, take, this->blks[j].begin() + this->off);
+      }
+
+      this->off += take;
+      done += take;
+
+      if (this->off == rate) {
+        for (size_t j = 0; j < LANES; j++) {
+          keccak::load_block<rate>(this->blks[j].data(), lanes[j]);
+        }
+
+        this->xor_lanes(lanes);
+        this->permute_state();
+        this->off = 0;
+      }
+    }
+  }
+
+  // Pads and absorbs last partial block of each message, after which no more
+  // message bytes can be absorbed.
+  inline void finalize()
+  {
+    std::array<std::array<uint64_t, rate_lanes>, LANES> lanes{};
+    for (size_t j = 0; j < LANES; j++) {
+      keccak::pad_block<rate>(this->blks[j].data(), this->off, lanes[j]);
+    }
+
+    this->xor_lanes(lanes);
+    this->off = rate;
+  }
+
+  // Given 4 destinations, this routine writes next `len` -bytes of output of
+  // respective instances to them, permuting all of them, each time a block of
+  // output is exhausted.
+  inline void squeeze(const std::array<uint8_t*, LANES>& outs, const size_t len)
+  {
+    size_t done = 0;
+    while (done < len) {
+      if (this->off == rate) {
+        this->permute_state();
+
+        std::array<uint64_t, rate_lanes> lanes{};
+        for (size_t j = 0; j < LANES; j++) {
+          for (size_t i = 0; i < rate_lanes; i++) {
+            lanes[i] = this->state[i * LANES + j];
+          }
+
+          keccak::squeeze_block<rate>(lanes, this->blks[j].data(), rate);
+        }
+
+        this->off = 0;
+      }
+
+      const size_t take = std::min(rate - this->off, len - done);
+      for (size_t j = 0; j < LANES; j++) {
+        std::copy_n(this->blks[j].begin() + this->off, take, outs[j] + done);
+      }
+
+      this->off += take;
+      done += take;
+    }
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include "keccak.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX-512 kernels for computing 8 instances of Keccak-f[1600] in parallel
+//
+// Keccak-f[1600] state of 8 independent instances is kept interleaved s.t.
+// i -th 64 -bit lane of instance j lives in 64 -bit word j of i -th vector,
+// so that each step of the permutation is applied to all 8 instances at
+// once, using exactly the same instruction sequence as a scalar
+// implementation would use for a single instance.
+//
+// Kernels are compiled for AVX-512F, irrespective of flags used for compiling
+// rest of the library, so they must only be invoked when
+// `dispatch::active_tier()` says the CPU supports AVX-512F.
+namespace keccak_avx512 {
+
+// # -of Keccak-f[1600] instances processed in parallel.
+constexpr size_t LANES = 8;
+
+// Rotates each 64 -bit word of a vector left by `r` -bits. Zero-masked form of
+// `vprolq` ( with all words selected ) is used, as the unmasked one trips
+// -Wuninitialized in some GCC versions.
+template<int r>
+__attribute__((target("avx512f"))) inline __m512i
+rotl(const __m512i x)
+{
+  constexpr __mmask8 all_words = 0xff;
+  return _mm512_maskz_rol_epi64(all_words, x, r);
+}
+
+// Applies Keccak-f[1600] permutation on 8 interleaved states, following
+// section 3.3 of SHA3 specification https://dx.doi.org/10.6028/NIST.FIPS.202.
+__attribute__((target("avx512f"))) inline void
+permute(__m512i* const __restrict a)
+{
+  __m512i b[keccak::LANE_CNT];
+  __m512i c[5];
+  __m512i d[5];
+
+  for (size_t rnd = 0; rnd < keccak::ROUNDS; rnd++) {
+    // θ step
+    for (size_t x = 0; x < 5; x++) {
+      c[x] = _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(a[x], a[x + 5], a[x + 10], 0x96), a[x + 15], a[x + 20], 0x96);
+    }
+    for (size_t x = 0; x < 5; x++) {
+      d[x] = _mm512_xor_si512(c[(x + 4) % 5], rotl<1>(c[(x + 1) % 5]));
+    }
+    for (size_t i = 0; i < keccak::LANE_CNT; i++) {
+      a[i] = _mm512_xor_si512(a[i], d[i % 5]);
+    }
+
+    // ρ and π steps
+    b[0] = a[0];
+    b[1] = rotl<44>(a[6]);
+    b[2] = rotl<43>(a[12]);
+    b[3] = rotl<21>(a[18]);
+    b[4] = rotl<14>(a[24]);
+    b[5] = rotl<28>(a[3]);
+    b[6] = rotl<20>(a[9]);
+    b[7] = rotl<3>(a[10]);
+    b[8] = rotl<45>(a[16]);
+    b[9] = rotl<61>(a[22]);
+    b[10] = rotl<1>(a[1]);
+    b[11] = rotl<6>(a[7]);
+    b[12] = rotl<25>(a[13]);
+    b[13] = rotl<8>(a[19]);
+    b[14] = rotl<18>(a[20]);
+    b[15] = rotl<27>(a[4]);
+    b[16] = rotl<36>(a[5]);
+    b[17] = rotl<10>(a[11]);
+    b[18] = rotl<15>(a[17]);
+    b[19] = rotl<56>(a[23]);
+    b[20] = rotl<62>(a[2]);
+    b[21] = rotl<55>(a[8]);
+    b[22] = rotl<39>(a[14]);
+    b[23] = rotl<41>(a[15]);
+    b[24] = rotl<2>(a[21]);
+
+    // χ step
+    for (size_t y = 0; y < 25; y += 5) {
+      for (size_t x = 0; x < 5; x++) {
+        a[y + x] = _mm512_ternarylogic_epi64(b[y + x], b[y + (x + 1) % 5], b[y + (x + 2) % 5], 0xd2);
+      }
+    }
+
+    // ι step
+    a[0] = _mm512_xor_si512(a[0], _mm512_set1_epi64(static_cast<int64_t>(keccak::RC[rnd])));
+  }
+}
+
+// Given 8 messages, each of `msg_len` -bytes, fitting in a single block of
+// SHAKE128, this routine computes `out_len` -bytes of SHAKE128 output for each
+// of them, in parallel.
+//
+// θ parity and χ step are computed with `vpternlogq`, each combining three
+// vectors in a single instruction, while ρ uses native `vprolq` rotations.
+template<size_t msg_len>
+__attribute__((target("avx512f"))) inline void
+shake128(const std::array<const uint8_t*, LANES>& msgs, const std::array<uint8_t*, LANES>& outs, const size_t out_len)
+  requires(msg_len < keccak::SHAKE128_RATE)
+{
+  std::array<std::array<uint64_t, keccak::SHAKE128_RATE_LANES>, LANES> lanes{};
+  for (size_t j = 0; j < LANES; j++) {
+    keccak::shake128_pad_block<msg_len>(msgs[j], lanes[j]);
+  }
+
+  __m512i a[keccak::LANE_CNT];
+  for (size_t i = 0; i < keccak::SHAKE128_RATE_LANES; i++) {
+    a[i] = _mm512_set_epi64(static_cast<int64_t>(lanes[7][i]), static_cast<int64_t>(lanes[6][i]), static_cast<int64_t>(lanes[5][i]), static_cast<int64_t>(lanes[4][i]), static_cast<int64_t>(lanes[3][i]), static_cast<int64_t>(lanes[2][i]), static_cast<int64_t>(lanes[1][i]), static_cast<int64_t>(lanes[0][i]));
+  }
+  for (size_t i = keccak::SHAKE128_RATE_LANES; i < keccak::LANE_CNT; i++) {
+    a[i] = _mm512_setzero_si512();
+  }
+
+  for (size_t off = 0; off < out_len; off += keccak::SHAKE128_RATE) {
+    permute(a);
+
+    for (size_t i = 0; i < keccak::SHAKE128_RATE_LANES; i++) {
+      alignas(64) std::array<uint64_t, LANES> words;
+      _mm512_store_si512(words.data(), a[i]);
+
+      for (size_t j = 0; j < LANES; j++) {
+        lanes[j][i] = words[j];
+      }
+    }
+
+    const size_t len = std::min(keccak::SHAKE128_RATE, out_len - off);
+    for (size_t j = 0; j < LANES; j++) {
+      keccak::shake128_squeeze_block(lanes[j], outs[j] + off, len);
+    }
+  }
+}
+
+}
+
+#endif
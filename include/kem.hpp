@@ -1,5 +1,11 @@
 #pragma once
+#include "a_cache.hpp"
+#include "dispatch.hpp"
 #include "encoding.hpp"
+#include "gen_a.hpp"
+#include "keccak.hpp"
+#include "keccak_avx2.hpp"
+#include "matmul.hpp"
 #include "matrix.hpp"
 #include "packing.hpp"
 #include "params.hpp"
@@ -9,107 +15,213 @@
 #include "subtle.hpp"
 #include "utils.hpp"
 #include "zq.hpp"
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <new>
 #include <span>
+#include <type_traits>
+#include <vector>
 
 // Frodo Key Encapsulation Mechanism
 namespace kem {
 
 using namespace frodo_utils;
 
-// Given following three uniformly random sampled seeds
-//
-// - `s` of len_sec -bits
-// - `seedSE` of len_SE -bits
-// - `z` of len_A -bits
-//
-// as input, this routine can be used for deterministically generating a new
-// Frodo KEM public/ private keypair, following algorithm definition in
-// section 8.1 of FrodoKEM specification.
-template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D>
+// Given a serialized Frodo KEM public key, this routine can be used for hashing
+// it, computing pkh, as required in step 1 of algorithm 13 of FrodoKEM
+// specification.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D>
 inline void
-keygen(std::span<const uint8_t, len_sec / 8> s,
-       std::span<const uint8_t, len_SE / 8> seedSE,
-       std::span<const uint8_t, len_A / 8> z,
-       std::span<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
-       std::span<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey)
-  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+hash_public_key(std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey, std::span<uint8_t, len_sec / 8> pkh)
 {
-  std::array<uint8_t, len_A / 8> seedA{};
-
   if constexpr (n == 640) {
     shake128::shake128_t hasher;
 
-    hasher.absorb(z);
+    hasher.absorb(pkey);
     hasher.finalize();
-    hasher.squeeze(seedA);
+    hasher.squeeze(pkh);
   } else if constexpr ((n == 976) || (n == 1344)) {
     shake256::shake256_t hasher;
 
-    hasher.absorb(z);
+    hasher.absorb(pkey);
     hasher.finalize();
-    hasher.squeeze(seedA);
+    hasher.squeeze(pkh);
   }
+}
 
-  auto A = matrix::matrix<n, n, D>::template generate<len_A>(seedA);
+// Required alignment of a caller-provided workspace ( see `keygen`, `encaps` and
+// `decaps` overloads taking one ), which is met by any buffer returned by
+// `operator new` or `std::malloc`.
+constexpr size_t WORKSPACE_ALIGNMENT = alignof(std::max_align_t);
 
-  std::array<uint8_t, 1 + seedSE.size()> buf{};
-  std::array<uint8_t, (32 * n * n̄) / 8> dig{};
+namespace internal {
 
-  buf[0] = 0x5f;
-  std::memcpy(buf.data() + 1, seedSE.data(), seedSE.size());
+// Given a byte length, this routine rounds it up to the next multiple of
+// workspace alignment.
+constexpr size_t
+align_workspace(const size_t len)
+{
+  return ((len + WORKSPACE_ALIGNMENT - 1) / WORKSPACE_ALIGNMENT) * WORKSPACE_ALIGNMENT;
+}
 
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
+// Given a caller-provided workspace and a byte offset into it, this routine
+// begins lifetime of an object of type T, at that offset, returning reference
+// to it. Objects of non-trivially destructible types must be destroyed by the
+// caller, using `std::destroy_at`.
+template<typename T, typename... Args>
+inline T&
+workspace_emplace(std::span<uint8_t> workspace, const size_t off, Args&&... args)
+{
+  assert(reinterpret_cast<uintptr_t>(workspace.data()) % WORKSPACE_ALIGNMENT == 0);
+  assert(off % alignof(T) == 0);
+  assert(off + sizeof(T) <= workspace.size());
 
-    hasher.absorb(buf);
-    hasher.finalize();
-    hasher.squeeze(dig);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
+  return *::new (static_cast<void*>(workspace.data() + off)) T(std::forward<Args>(args)...);
+}
 
-    hasher.absorb(buf);
-    hasher.finalize();
-    hasher.squeeze(dig);
-  }
+// Intermediate matrices of key generation, see `keygen_workspace_len`.
+template<size_t n, size_t n̄, size_t D>
+struct keygen_scratch_t
+{
+  matrix::matrix<n̄, n, D> S_transposed;
+  matrix::matrix<n, n̄, D> E;
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows;
+};
+
+// SHAKE128 ( for n = 640 ) or SHAKE256 ( otherwise ), which is how FrodoKEM
+// instantiates its hash function, following section 8.1 of FrodoKEM
+// specification.
+template<size_t n>
+using xof_t = std::conditional_t<n == 640, shake128::shake128_t, shake256::shake256_t>;
+
+// Given a message, this routine computes `xof_t` output of requested length.
+template<size_t n>
+inline void
+xof(std::span<const uint8_t> msg, std::span<uint8_t> out)
+{
+  xof_t<n> hasher;
 
-  std::span<uint8_t, dig.size()> _dig{ dig };
+  hasher.absorb(msg);
+  hasher.finalize();
+  hasher.squeeze(out);
+}
 
-  auto _dig0 = _dig.template subspan<0, 2 * n * n̄>();
-  auto S_transposed = sampling::sample_matrix<n, n̄, n, D>(_dig0);
+// Given 4 messages, each of `msg_len` -bytes, this routine computes `out_len`
+// -bytes of `xof` output for each of them, producing exactly same outputs as
+// calling `xof` on each of them, one by one. When the active instruction set
+// tier allows it, all 4 of them run in lockstep, in SIMD lanes.
+template<size_t n>
+inline void
+xof_x4(const std::array<const uint8_t*, 4>& msgs, const size_t msg_len, const std::array<uint8_t*, 4>& outs, const size_t out_len)
+{
+#if defined(__x86_64__)
+  static_assert(keccak_avx2::LANES == 4);
 
-  auto _dig1 = _dig.template subspan<_dig0.size(), 2 * n * n̄>();
-  auto E = sampling::sample_matrix<n, n, n̄, D>(_dig1);
+  if (dispatch::active_tier() != dispatch::tier_t::scalar) {
+    constexpr size_t rate = (n == 640) ? keccak::SHAKE128_RATE : keccak::SHAKE256_RATE;
 
-  auto S = S_transposed.transpose();
-  auto B_mat = A * S + E;
+    keccak_avx2::shake<rate>(msgs, msg_len, outs, out_len);
+    return;
+  }
+#endif
+
+  for (size_t j = 0; j < msgs.size(); j++) {
+    xof<n>(std::span(msgs[j], msg_len), std::span(outs[j], out_len));
+  }
+}
 
+// 4 independent `xof_t` instances, absorbed and squeezed in lockstep, each
+// producing exactly same output as a single `xof_t`, fed with same message.
+// When the active instruction set tier allows it, all 4 of them run in SIMD
+// lanes, otherwise one after another. Each call takes same number of bytes of
+// all 4 messages or outputs, see `keccak_avx2::shake_x4_t`.
+template<size_t n>
+struct xof_x4_t
+{
+private:
+#if defined(__x86_64__)
+  static constexpr size_t rate = (n == 640) ? keccak::SHAKE128_RATE : keccak::SHAKE256_RATE;
+
+  bool simd = dispatch::active_tier() != dispatch::tier_t::scalar;
+  keccak_avx2::shake_x4_t<rate> lanes;
+#endif
+  std::array<xof_t<n>, 4> hashers;
+
+public:
+  inline void absorb(const std::array<const uint8_t*, 4>& msgs, const size_t len)
+  {
+#if defined(__x86_64__)
+    if (this->simd) {
+      this->lanes.absorb(msgs, len);
+      return;
+    }
+#endif
+
+    for (size_t j = 0; j < msgs.size(); j++) {
+      this->hashers[j].absorb(std::span(msgs[j], len));
+    }
+  }
+
+  inline void finalize()
+  {
+#if defined(__x86_64__)
+    if (this->simd) {
+      this->lanes.finalize();
+      return;
+    }
+#endif
+
+    for (auto& hasher : this->hashers) {
+      hasher.finalize();
+    }
+  }
+
+  inline void squeeze(const std::array<uint8_t*, 4>& outs, const size_t len)
+  {
+#if defined(__x86_64__)
+    if (this->simd) {
+      this->lanes.squeeze(outs, len);
+      return;
+    }
+#endif
+
+    for (size_t j = 0; j < outs.size(); j++) {
+      this->hashers[j].squeeze(std::span(outs[j], len));
+    }
+  }
+};
+
+// Given secret seed s, seedA, matrices S^T and E, sampled from output of
+// hashing 0x5f || seedSE, and scratch space for a block of rows of A, this
+// routine computes B = A * S + E and serializes public key and secret key,
+// following section 8.1 of FrodoKEM specification, leaving trailing pkh of
+// secret key for the caller to fill. B is packed into public key, block of rows
+// by block of rows, as it's computed.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D, gen_a::prg_t prg>
+inline void
+keygen_expand(std::span<const uint8_t, len_sec / 8> s,
+              std::span<const uint8_t, len_A / 8> seedA,
+              const matrix::matrix<n̄, n, D>& S_transposed,
+              const matrix::matrix<n, n̄, D>& E,
+              std::span<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows,
+              std::span<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+              std::span<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey)
+{
   // --- serialize public key ---
   auto pkey0 = pkey.template subspan<0, seedA.size()>();
   std::memcpy(pkey0.data(), seedA.data(), pkey0.size());
 
   auto pkey1 = pkey.template subspan<pkey0.size(), (D * n * n̄) / 8>();
-  packing::pack(B_mat, pkey1);
+  matmul::a_mul_st_add_e<n, n̄, len_A, D, prg>(seedA, S_transposed, E, pkey1, a_rows);
   // --- done ---
 
-  std::array<uint8_t, len_sec / 8> pkh{};
-
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
-
-    hasher.absorb(pkey);
-    hasher.finalize();
-    hasher.squeeze(pkh);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
-
-    hasher.absorb(pkey);
-    hasher.finalize();
-    hasher.squeeze(pkh);
-  }
-
-  // --- serialize secret key ---
+  // --- serialize secret key, except pkh ---
   auto skey0 = skey.template subspan<0, s.size()>();
   std::memcpy(skey0.data(), s.data(), skey0.size());
 
@@ -120,46 +232,348 @@ keygen(std::span<const uint8_t, len_sec / 8> s,
   constexpr size_t skoff1 = skoff0 + skey1.size();
   auto skey2 = skey.template subspan<skoff1, n̄ * n * 2>();
   S_transposed.write_as_le_bytes(skey2);
-
-  constexpr size_t skoff2 = skoff1 + skey2.size();
-  auto skey3 = skey.template subspan<skoff2, pkh.size()>();
-  std::memcpy(skey3.data(), pkh.data(), pkh.size());
   // --- done ---
 }
 
-// Given a uniformly random values μ and salt, along with a target Frodo KEM
-// public key ( for which the cipher text is going to be computed i.e. only
-// corresponding private key can be used for decrypting the cipher text ), this
-// routine can be used for computing a cipher text and a shared secret,
-// following algorithm definition in section 8.2 of FrodoKEM specification.
-template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D>
+// Given seeds ( s, seedSE, z ) and scratch space for intermediate matrices,
+// this routine generates a Frodo KEM keypair, see `keygen`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t D, gen_a::prg_t prg>
 inline void
-encaps(std::span<const uint8_t, len_sec / 8> μ,
-       std::span<const uint8_t, len_salt / 8> salt,
-       std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
-       std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
-       std::span<uint8_t, len_sec / 8> ss)
-  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+keygen_with(std::span<const uint8_t, len_sec / 8> s,
+            std::span<const uint8_t, len_SE / 8> seedSE,
+            std::span<const uint8_t, len_A / 8> z,
+            std::span<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+            std::span<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
+            keygen_scratch_t<n, n̄, D>& scratch)
 {
-  std::array<uint8_t, len_sec / 8> pkh{};
+  std::array<uint8_t, len_A / 8> seedA{};
+  xof<n>(z, seedA);
 
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
+  std::array<uint8_t, 1 + seedSE.size()> buf{};
 
-    hasher.absorb(pkey);
-    hasher.finalize();
-    hasher.squeeze(pkh);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
+  buf[0] = 0x5f;
+  std::memcpy(buf.data() + 1, seedSE.data(), seedSE.size());
 
-    hasher.absorb(pkey);
-    hasher.finalize();
-    hasher.squeeze(pkh);
+  // S^T and E are sampled straight out of the XOF, never materializing its
+  // output, see `sampling::sample_matrix`.
+  xof_t<n> hasher;
+
+  hasher.absorb(buf);
+  hasher.finalize();
+
+  sampling::sample_matrix<n, n̄, n, D>(hasher, scratch.S_transposed);
+  sampling::sample_matrix<n, n, n̄, D>(hasher, scratch.E);
+
+  keygen_expand<n, n̄, len_sec, len_A, D, prg>(s, seedA, scratch.S_transposed, scratch.E, scratch.a_rows, pkey, skey);
+
+  // pkh is the suffix of secret key.
+  hash_public_key<n, n̄, len_sec, len_A, D>(pkey, skey.template last<len_sec / 8>());
+}
+
+}
+
+// Given following three uniformly random sampled seeds
+//
+// - `s` of len_sec -bits
+// - `seedSE` of len_SE -bits
+// - `z` of len_A -bits
+//
+// as input, this routine can be used for deterministically generating a new
+// Frodo KEM public/ private keypair, following algorithm definition in
+// section 8.1 of FrodoKEM specification. Matrix A is generated using chosen
+// PRG i.e. SHAKE128 or AES128.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+keygen(std::span<const uint8_t, len_sec / 8> s,
+       std::span<const uint8_t, len_SE / 8> seedSE,
+       std::span<const uint8_t, len_A / 8> z,
+       std::span<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+       std::span<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey)
+  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+{
+  internal::keygen_scratch_t<n, n̄, D> scratch{};
+  internal::keygen_with<n, n̄, len_sec, len_SE, len_A, D, prg>(s, seedSE, z, pkey, skey, scratch);
+}
+
+// Compile-time computable byte length of the workspace, which a caller must
+// provide to `keygen`, for keeping all intermediate matrices ( S^T, E and a
+// block of rows of A ), whose size depends on n, off stack.
+template<size_t n, size_t n̄, size_t D>
+constexpr size_t
+keygen_workspace_len()
+{
+  return sizeof(internal::keygen_scratch_t<n, n̄, D>);
+}
+
+// Given seeds ( s, seedSE, z ) and a caller-owned workspace ( aligned to
+// `WORKSPACE_ALIGNMENT` ), this routine generates a Frodo KEM keypair, exactly
+// as above, carving all intermediate matrices out of the workspace. So a
+// workspace can be allocated once, per thread, and reused across calls, with
+// no per-call stack or heap growth.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+keygen(std::span<const uint8_t, len_sec / 8> s,
+       std::span<const uint8_t, len_SE / 8> seedSE,
+       std::span<const uint8_t, len_A / 8> z,
+       std::span<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+       std::span<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
+       std::span<uint8_t, keygen_workspace_len<n, n̄, D>()> workspace)
+  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::keygen_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::keygen_with<n, n̄, len_sec, len_SE, len_A, D, prg>(s, seedSE, z, pkey, skey, scratch);
+}
+
+// Seeds of one keypair, in a batch, see `keygen_x4` and `batch_keygen`.
+template<size_t len_sec, size_t len_SE, size_t len_A>
+struct keygen_input_t
+{
+  std::array<uint8_t, len_sec / 8> s{};
+  std::array<uint8_t, len_SE / 8> seedSE{};
+  std::array<uint8_t, len_A / 8> z{};
+};
+
+// Serialized public key and secret key of one keypair, in a batch, see
+// `keygen_x4` and `batch_keygen`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D>
+struct keypair_t
+{
+  std::array<uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey{};
+  std::array<uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey{};
+};
+
+namespace internal {
+
+// # -of keypairs or encapsulations computed in lockstep, see `keygen_x4` and
+// `encaps_x4`.
+constexpr size_t X4 = 4;
+
+// Intermediate values of `keygen_x4`, see `keygen_x4_workspace_len`. Matrices
+// S^T and E of all keypairs are sampled together, while a block of rows of A
+// is reused across keypairs, as they're expanded one by one.
+template<size_t n, size_t n̄, size_t D>
+struct keygen_x4_scratch_t
+{
+  std::array<matrix::matrix<n̄, n, D>, X4> S_transposed;
+  std::array<matrix::matrix<n, n̄, D>, X4> E;
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows;
+};
+
+// Given seeds of 4 independent keypairs and scratch space for intermediate
+// values, this routine generates all of them, see `keygen_x4`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t D, gen_a::prg_t prg>
+inline void
+keygen_x4_with(std::span<const keygen_input_t<len_sec, len_SE, len_A>, X4> inputs,
+               std::span<keypair_t<n, n̄, len_sec, len_A, D>, X4> keypairs,
+               keygen_x4_scratch_t<n, n̄, D>& scratch)
+{
+  constexpr size_t lanes = X4;
+
+  std::array<std::array<uint8_t, len_A / 8>, lanes> seedAs{};
+  std::array<std::array<uint8_t, 1 + len_SE / 8>, lanes> bufs{};
+
+  std::array<const uint8_t*, lanes> msgs{};
+  std::array<uint8_t*, lanes> outs{};
+
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j] = inputs[j].z.data();
+    outs[j] = seedAs[j].data();
   }
+  xof_x4<n>(msgs, len_A / 8, outs, len_A / 8);
 
-  std::array<uint8_t, (len_SE + len_sec) / 8> rand_bytes{};
-  auto _rand_bytes = std::span(rand_bytes);
+  for (size_t j = 0; j < lanes; j++) {
+    bufs[j][0] = 0x5f;
+    std::memcpy(bufs[j].data() + 1, inputs[j].seedSE.data(), inputs[j].seedSE.size());
+
+    msgs[j] = bufs[j].data();
+  }
+
+  // S^T and E of all keypairs are sampled straight out of the XOFs, squeezed in
+  // lockstep, never materializing their output, see
+  // `sampling::sample_matrix_x4`.
+  xof_x4_t<n> hasher;
+
+  hasher.absorb(msgs, bufs[0].size());
+  hasher.finalize();
+
+  sampling::sample_matrix_x4<n, n̄, n, D>(hasher, std::span(scratch.S_transposed));
+  sampling::sample_matrix_x4<n, n, n̄, D>(hasher, std::span(scratch.E));
+
+  for (size_t j = 0; j < lanes; j++) {
+    keygen_expand<n, n̄, len_sec, len_A, D, prg>(
+      inputs[j].s, seedAs[j], scratch.S_transposed[j], scratch.E[j], scratch.a_rows, keypairs[j].pkey, keypairs[j].skey);
+  }
+
+  // pkh is the suffix of secret key.
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j] = keypairs[j].pkey.data();
+    outs[j] = keypairs[j].skey.data() + keypairs[j].skey.size() - len_sec / 8;
+  }
+  xof_x4<n>(msgs, keypairs[0].pkey.size(), outs, len_sec / 8);
+}
+
+}
+
+// Given seeds of 4 independent keypairs, this routine generates all of them,
+// producing exactly same keypairs as calling `keygen` for each of them, one by
+// one.
+//
+// Hashing z into seedA, squeezing seedSE's XOF output, out of which S and E are
+// sampled, and hashing public keys into pkh run for all 4 keypairs in
+// lockstep, on 4-way SIMD Keccak-f[1600], when the active instruction set tier
+// allows it. Rows of each matrix A are already generated in SIMD lanes,
+// several rows at a time ( see `gen_a::generate_rows` ).
+//
+// S and E of all 4 keypairs are alive at once, which is as much as 4 x 43 KiB
+// for the 1344 parameter sets, so scratch space is allocated on heap. Prefer
+// the overload taking a workspace, for reusing it across calls.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+keygen_x4(std::span<const keygen_input_t<len_sec, len_SE, len_A>, 4> inputs, std::span<keypair_t<n, n̄, len_sec, len_A, D>, 4> keypairs)
+  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+{
+  const auto scratch = std::make_unique_for_overwrite<internal::keygen_x4_scratch_t<n, n̄, D>>();
+  internal::keygen_x4_with<n, n̄, len_sec, len_SE, len_A, D, prg>(inputs, keypairs, *scratch);
+}
+
+// Compile-time computable byte length of the workspace, which a caller must
+// provide to `keygen_x4`, for keeping matrices S^T and E of all 4 keypairs,
+// along with a block of rows of A, which is reused across keypairs, off stack.
+template<size_t n, size_t n̄, size_t D>
+constexpr size_t
+keygen_x4_workspace_len()
+{
+  return sizeof(internal::keygen_x4_scratch_t<n, n̄, D>);
+}
+
+// Given seeds of 4 independent keypairs and a caller-owned workspace ( aligned
+// to `WORKSPACE_ALIGNMENT` ), this routine generates all of them, exactly as
+// above, carving all intermediate values out of the workspace.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+keygen_x4(std::span<const keygen_input_t<len_sec, len_SE, len_A>, 4> inputs,
+          std::span<keypair_t<n, n̄, len_sec, len_A, D>, 4> keypairs,
+          std::span<uint8_t, keygen_x4_workspace_len<n, n̄, D>()> workspace)
+  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::keygen_x4_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::keygen_x4_with<n, n̄, len_sec, len_SE, len_A, D, prg>(inputs, keypairs, scratch);
+}
+
+// Given seeds of a batch of independent keypairs, this routine generates all of
+// them, 4 at a time ( see `keygen_x4` ), producing exactly same keypairs as
+// calling `keygen` for each of them, one by one. Rest of the keypairs ( if any )
+// are generated one by one. Only as many seeds as there are keypairs are
+// processed, returning how many keypairs got generated. Scratch space for
+// intermediate values is allocated on heap, once, for the whole batch.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t B, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+batch_keygen(std::span<const keygen_input_t<len_sec, len_SE, len_A>> inputs, std::span<keypair_t<n, n̄, len_sec, len_A, D>> keypairs)
+  requires(frodo_params::check_keygen_params(n, n̄, len_sec, len_SE, len_A, B, D))
+{
+  constexpr size_t x4 = internal::X4;
+  const size_t count = std::min(inputs.size(), keypairs.size());
+
+  size_t r = 0;
+  if (count >= x4) {
+    const auto scratch = std::make_unique_for_overwrite<internal::keygen_x4_scratch_t<n, n̄, D>>();
 
+    for (; r + x4 <= count; r += x4) {
+      internal::keygen_x4_with<n, n̄, len_sec, len_SE, len_A, D, prg>(inputs.subspan(r).template first<x4>(), keypairs.subspan(r).template first<x4>(), *scratch);
+    }
+  }
+
+  if (r < count) {
+    const auto scratch = std::make_unique_for_overwrite<internal::keygen_scratch_t<n, n̄, D>>();
+
+    for (; r < count; r++) {
+      internal::keygen_with<n, n̄, len_sec, len_SE, len_A, D, prg>(inputs[r].s, inputs[r].seedSE, inputs[r].z, keypairs[r].pkey, keypairs[r].skey, *scratch);
+    }
+  }
+
+  return count;
+}
+
+// Frodo KEM public key, parsed once and kept ready for repeated encapsulation
+// to the same peer. It holds pkh ( i.e. hash of serialized public key ), the
+// unpacked matrix B and a source of rows of matrix A, keyed by seedA ( for
+// AES128, round keys are expanded only once ), so that none of them are
+// recomputed by `encaps`. When prepared with a cache of expanded matrices A
+// ( see `a_cache` ), rows of A are read from the cache, instead of being
+// generated, on every `encaps`.
+//
+// It's immutable, once constructed, so a single instance can be shared by
+// many threads, encapsulating concurrently.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+struct prepared_public_key
+{
+private:
+  std::array<uint8_t, len_sec / 8> _pkh{};
+  a_cache::row_source_t<n, len_A, D, prg> _a_rows;
+  matrix::matrix<n, n̄, D> _B_mat{};
+
+  // Hashes serialized public key and unpacks matrix B.
+  inline void parse(std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey)
+  {
+    hash_public_key<n, n̄, len_sec, len_A, D>(pkey, this->_pkh);
+
+    auto pkey1 = pkey.template subspan<len_A / 8, pkey.size() - len_A / 8>();
+    packing::unpack<n, n̄, D>(pkey1, this->_B_mat);
+  }
+
+public:
+  // Given a serialized Frodo KEM public key, this routine hashes it, unpacks
+  // matrix B and prepares generator of matrix A, from seedA.
+  explicit prepared_public_key(std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey)
+    : _a_rows(pkey.template subspan<0, len_A / 8>())
+  {
+    this->parse(pkey);
+  }
+
+  // Given a serialized Frodo KEM public key and a cache of expanded matrices
+  // A, this routine hashes it, unpacks matrix B and looks up ( or expands and
+  // inserts ) matrix A, for seedA, in the cache.
+  prepared_public_key(std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey, a_cache::cache_t& cache)
+    : _a_rows(pkey.template subspan<0, len_A / 8>(), cache)
+  {
+    this->parse(pkey);
+  }
+
+  // Returns hash of serialized public key.
+  inline std::span<const uint8_t, len_sec / 8> pkh() const { return this->_pkh; }
+
+  // Returns source of rows of matrix A.
+  inline const a_cache::row_source_t<n, len_A, D, prg>& a_rows() const { return this->_a_rows; }
+
+  // Returns unpacked matrix B, of dimension n x n̄.
+  inline const matrix::matrix<n, n̄, D>& b_matrix() const { return this->_B_mat; }
+};
+
+namespace internal {
+
+// Intermediate matrices of encapsulation, see `encaps_workspace_len`.
+template<size_t n, size_t n̄, size_t D>
+struct encaps_scratch_t
+{
+  matrix::matrix<n̄, n, D> S_prime;
+  matrix::matrix<n̄, n, D> B_prime; // Holds E', before B' = S' * A + E' is computed.
+  matrix::matrix<n̄, n̄, D> E_dprime;
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows;
+};
+
+// Given pkh, along with uniformly random values μ and salt, this routine derives
+// seedSE || k and samples matrices S', E' and E'', as required in steps 2 - 5
+// of algorithm 13 and steps 8 - 9 of algorithm 14 of FrodoKEM specification.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_salt, size_t D>
+inline void
+encaps_sample(std::span<const uint8_t, len_sec / 8> pkh,
+              std::span<const uint8_t, len_sec / 8> μ,
+              std::span<const uint8_t, len_salt / 8> salt,
+              std::span<uint8_t, (len_SE + len_sec) / 8> rand_bytes,
+              matrix::matrix<n̄, n, D>& S_prime,
+              matrix::matrix<n̄, n, D>& E_prime,
+              matrix::matrix<n̄, n̄, D>& E_dprime)
+{
   if constexpr (n == 640) {
     shake128::shake128_t hasher;
 
@@ -167,7 +581,7 @@ encaps(std::span<const uint8_t, len_sec / 8> μ,
     hasher.absorb(μ);
     hasher.absorb(salt);
     hasher.finalize();
-    hasher.squeeze(_rand_bytes);
+    hasher.squeeze(rand_bytes);
   } else if constexpr ((n == 976) || (n == 1344)) {
     shake256::shake256_t hasher;
 
@@ -175,205 +589,818 @@ encaps(std::span<const uint8_t, len_sec / 8> μ,
     hasher.absorb(μ);
     hasher.absorb(salt);
     hasher.finalize();
-    hasher.squeeze(_rand_bytes);
+    hasher.squeeze(rand_bytes);
   }
 
   std::array<uint8_t, 1 + len_SE / 8> buf{};
-  std::array<uint8_t, ((2 * n̄ * n + n̄ * n̄) * 16) / 8> dig{};
 
   buf[0] = 0x96;
-  std::memcpy(buf.data() + 1, _rand_bytes.data(), len_SE / 8);
+  std::memcpy(buf.data() + 1, rand_bytes.data(), len_SE / 8);
 
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
+  // S', E' and E'' are sampled straight out of the XOF, never materializing
+  // its output, see `sampling::sample_matrix`.
+  xof_t<n> hasher;
 
-    hasher.absorb(buf);
-    hasher.finalize();
-    hasher.squeeze(dig);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
+  hasher.absorb(buf);
+  hasher.finalize();
 
-    hasher.absorb(buf);
-    hasher.finalize();
-    hasher.squeeze(dig);
-  }
-
-  std::span<uint8_t, dig.size()> _dig{ dig };
-
-  constexpr size_t doff0 = (n̄ * n * 16) / 8;
-  auto _dig0 = _dig.template subspan<0, doff0>();
-  auto S_prime = sampling::sample_matrix<n, n̄, n, D>(_dig0);
-
-  constexpr size_t doff1 = doff0 + (n̄ * n * 16) / 8;
-  auto _dig1 = _dig.template subspan<doff0, doff1 - doff0>();
-  auto E_prime = sampling::sample_matrix<n, n̄, n, D>(_dig1);
-
-  auto pkey0 = pkey.template subspan<0, len_A / 8>();
-  auto A = matrix::matrix<n, n, D>::template generate<len_A>(pkey0);
-
-  auto B_prime = S_prime * A + E_prime;
-
-  auto _dig2 = _dig.template subspan<doff1, _dig.size() - doff1>();
-  auto E_dprime = sampling::sample_matrix<n, n̄, n̄, D>(_dig2);
+  sampling::sample_matrix<n, n̄, n, D>(hasher, S_prime);
+  sampling::sample_matrix<n, n̄, n, D>(hasher, E_prime);
+  sampling::sample_matrix<n, n̄, n̄, D>(hasher, E_dprime);
+}
 
-  constexpr size_t pkoff = pkey0.size();
-  auto pkey1 = pkey.template subspan<pkoff, pkey.size() - pkoff>();
-  auto B_mat = packing::unpack<n, n̄, D>(pkey1);
+static_assert(encoding::BLOCK_ELEMS == packing::BLOCK_ELEMS, "A block of Encode(μ) must line up with a block of packed C");
 
-  auto V = S_prime * B_mat + E_dprime;
+// Matrix B, of dimension n x n̄, either unpacked ( as held by a prepared key )
+// or in packed form, read straight out of a serialized public key.
+template<typename T, size_t n, size_t n̄, size_t D>
+concept b_operand = std::same_as<T, matrix::matrix<n, n̄, D>> || std::same_as<T, packing::packed_t<n, n̄, D>>;
 
-  auto M = encoding::encode<n̄, n̄, D, B>(μ);
-  auto C = V + M;
+// Given μ and matrices S', B and E'', this routine computes V = S' * B + E'',
+// C = V + Encode(μ) and packs C into a bit string, as required in steps 8 - 9
+// of algorithm 13 of FrodoKEM specification.
+//
+// All of it is fused, computing one row of C at a time, which is packed right
+// away, block by block, each of 8 elements taking its B -bytes of μ and giving
+// D -bytes of packed C. Neither V, Encode(μ) nor C is ever materialized. When B
+// is in packed form, S' * B is computed off it, see `matmul::mul_packed`.
+template<size_t n, size_t n̄, size_t len_sec, size_t B, size_t D, b_operand<n, n̄, D> b_operand_t>
+inline void
+encrypt_c(std::span<const uint8_t, len_sec / 8> μ,
+          const b_operand_t& B_mat,
+          const matrix::matrix<n̄, n, D>& S_prime,
+          const matrix::matrix<n̄, n̄, D>& E_dprime,
+          std::span<uint8_t, (n̄ * n̄ * D) / 8> c)
+  requires((n̄ % packing::BLOCK_ELEMS == 0) && (len_sec == n̄ * n̄ * B))
+{
+  constexpr size_t blk_elems = packing::BLOCK_ELEMS;
+  constexpr size_t blks_per_row = n̄ / blk_elems;
+
+  const auto V = [&]() {
+    if constexpr (std::is_same_v<b_operand_t, packing::packed_t<n, n̄, D>>) {
+      return matmul::mul_packed<n̄, n, n̄, D>(S_prime, B_mat) + E_dprime;
+    } else {
+      return S_prime * B_mat + E_dprime;
+    }
+  }();
+  std::array<zq::zq_t<D>, n̄> row{};
+
+  for (size_t i = 0; i < n̄; i++) {
+    V.eval_row(i, row.data());
+
+    for (size_t j = 0; j < blks_per_row; j++) {
+      const size_t blk = i * blks_per_row + j;
+      const auto M = encoding::encode_block<D, B>(std::span<const uint8_t, B>(μ.subspan(blk * B, B)));
+
+      for (size_t k = 0; k < blk_elems; k++) {
+        row[j * blk_elems + k] += M[k];
+      }
+
+      packing::pack_block<D>(row.data() + j * blk_elems, std::span<uint8_t, D>(c.subspan(blk * D, D)));
+    }
+  }
+}
 
+// Given B' = S' * A + E', this routine computes C = S' * B + E'' + Encode(μ)
+// and serializes cipher text ( B', C, salt ), as required in steps 8 - 10 of
+// algorithm 13 of FrodoKEM specification.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_salt, size_t B, size_t D, b_operand<n, n̄, D> b_operand_t>
+inline void
+encaps_pack(std::span<const uint8_t, len_sec / 8> μ,
+            std::span<const uint8_t, len_salt / 8> salt,
+            const b_operand_t& B_mat,
+            const matrix::matrix<n̄, n, D>& S_prime,
+            const matrix::matrix<n̄, n, D>& B_prime,
+            const matrix::matrix<n̄, n̄, D>& E_dprime,
+            std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc)
+{
   auto enc0 = enc.template subspan<0, (n̄ * n * D) / 8>();
   packing::pack(B_prime, enc0);
 
   auto enc1 = enc.template subspan<enc0.size(), (n̄ * n̄ * D) / 8>();
-  packing::pack(C, enc1);
+  encrypt_c<n, n̄, len_sec, B, D>(μ, B_mat, S_prime, E_dprime, enc1);
 
   auto enc2 = enc.template subspan<enc0.size() + enc1.size(), salt.size()>();
-  std::memcpy(enc2.data(), salt.data(), salt.size());
+  std::copy(salt.begin(), salt.end(), enc2.begin());
+}
+
+// Given B' = S' * A + E', this routine computes V = S' * B + E'' and
+// C = V + Encode(μ), serializes cipher text ( B', C, salt ) and derives shared
+// secret from it, as required in steps 8 - 11 of algorithm 13 of FrodoKEM
+// specification.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_salt, size_t B, size_t D, b_operand<n, n̄, D> b_operand_t>
+inline void
+encaps_finish(std::span<const uint8_t, len_sec / 8> μ,
+              std::span<const uint8_t, len_salt / 8> salt,
+              std::span<const uint8_t, (len_SE + len_sec) / 8> rand_bytes,
+              const b_operand_t& B_mat,
+              const matrix::matrix<n̄, n, D>& S_prime,
+              const matrix::matrix<n̄, n, D>& B_prime,
+              const matrix::matrix<n̄, n̄, D>& E_dprime,
+              std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+              std::span<uint8_t, len_sec / 8> ss)
+{
+  encaps_pack<n, n̄, len_sec, len_salt, B, D>(μ, salt, B_mat, S_prime, B_prime, E_dprime, enc);
 
   if constexpr (n == 640) {
     shake128::shake128_t hasher;
 
     hasher.absorb(enc);
-    hasher.absorb(_rand_bytes.subspan(len_SE / 8, len_sec / 8));
+    hasher.absorb(rand_bytes.subspan(len_SE / 8, len_sec / 8));
     hasher.finalize();
     hasher.squeeze(ss);
   } else if constexpr ((n == 976) || (n == 1344)) {
     shake256::shake256_t hasher;
 
     hasher.absorb(enc);
-    hasher.absorb(_rand_bytes.subspan(len_SE / 8, len_sec / 8));
+    hasher.absorb(rand_bytes.subspan(len_SE / 8, len_sec / 8));
     hasher.finalize();
     hasher.squeeze(ss);
   }
 }
 
-// Given a FrodoKEM cipher text and secret key, which is associated with the
-// public key, using which the cipher text was computed, this routine can be
-// used for decrypting the cipher text, recovering shared secret, following
-// algorithm definition in section 8.3 of FrodoKEM specification.
-template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D>
+// Given uniformly random values μ and salt, pkh, a source of rows of matrix A,
+// matrix B ( unpacked or packed ) and scratch space for intermediate matrices,
+// this routine computes a cipher text and a shared secret, see `encaps`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_salt, size_t B, size_t D, typename row_source_t, b_operand<n, n̄, D> b_operand_t>
 inline void
-decaps(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
-       std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+encaps_from(std::span<const uint8_t, len_sec / 8> μ,
+            std::span<const uint8_t, len_salt / 8> salt,
+            std::span<const uint8_t, len_sec / 8> pkh,
+            const row_source_t& a_rows,
+            const b_operand_t& B_mat,
+            std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+            std::span<uint8_t, len_sec / 8> ss,
+            encaps_scratch_t<n, n̄, D>& scratch)
+{
+  std::array<uint8_t, (len_SE + len_sec) / 8> rand_bytes{};
+
+  // B' starts off as E', which is accumulated on top of.
+  encaps_sample<n, n̄, len_sec, len_SE, len_salt, D>(pkh, μ, salt, rand_bytes, scratch.S_prime, scratch.B_prime, scratch.E_dprime);
+  matmul::s_mul_a_add_e<n, n̄, D>(a_rows, scratch.S_prime, scratch.B_prime, scratch.a_rows);
+
+  encaps_finish<n, n̄, len_sec, len_SE, len_salt, B, D>(μ, salt, rand_bytes, B_mat, scratch.S_prime, scratch.B_prime, scratch.E_dprime, enc, ss);
+}
+
+// Given uniformly random values μ and salt, a prepared Frodo KEM public key and
+// scratch space for intermediate matrices, this routine computes a cipher text
+// and a shared secret, see `encaps`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D, gen_a::prg_t prg>
+inline void
+encaps_with(std::span<const uint8_t, len_sec / 8> μ,
+            std::span<const uint8_t, len_salt / 8> salt,
+            const prepared_public_key<n, n̄, len_sec, len_A, D, prg>& ppk,
+            std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+            std::span<uint8_t, len_sec / 8> ss,
+            encaps_scratch_t<n, n̄, D>& scratch)
+{
+  encaps_from<n, n̄, len_sec, len_SE, len_salt, B, D>(μ, salt, ppk.pkh(), ppk.a_rows(), ppk.b_matrix(), enc, ss, scratch);
+}
+
+// Given uniformly random values μ and salt, a serialized Frodo KEM public key
+// and scratch space for intermediate matrices, this routine computes a cipher
+// text and a shared secret, see `encaps`. Matrix B is never unpacked, it's
+// read straight out of the public key, see `encrypt_c`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D, gen_a::prg_t prg>
+inline void
+encaps_with(std::span<const uint8_t, len_sec / 8> μ,
+            std::span<const uint8_t, len_salt / 8> salt,
+            std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+            std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+            std::span<uint8_t, len_sec / 8> ss,
+            encaps_scratch_t<n, n̄, D>& scratch)
+{
+  std::array<uint8_t, len_sec / 8> pkh{};
+  hash_public_key<n, n̄, len_sec, len_A, D>(pkey, pkh);
+
+  const gen_a::row_generator_t<n, len_A, D, prg> a_rows(pkey.template subspan<0, len_A / 8>());
+  const packing::packed_t<n, n̄, D> B_mat{ pkey.template subspan<len_A / 8, pkey.size() - len_A / 8>() };
+
+  encaps_from<n, n̄, len_sec, len_SE, len_salt, B, D>(μ, salt, pkh, a_rows, B_mat, enc, ss, scratch);
+}
+
+}
+
+// Given a uniformly random values μ and salt, along with a prepared Frodo KEM
+// public key ( see `prepared_public_key` ), this routine can be used for
+// computing a cipher text and a shared secret, following algorithm definition
+// in section 8.2 of FrodoKEM specification, while skipping hashing of public
+// key, unpacking of matrix B and setting up generation of matrix A, which were
+// already done, when the public key was prepared.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       std::span<const uint8_t, len_salt / 8> salt,
+       const prepared_public_key<n, n̄, len_sec, len_A, D, prg>& ppk,
+       std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
        std::span<uint8_t, len_sec / 8> ss)
-  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
 {
-  // Parse cipher text
-  // = c1
-  auto enc0 = enc.template subspan<0, (n̄ * n * D) / 8>();
-  auto B_prime = packing::unpack<n̄, n, D>(enc0);
+  internal::encaps_scratch_t<n, n̄, D> scratch{};
+  internal::encaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, enc, ss, scratch);
+}
 
-  // = c2
-  auto enc1 = enc.template subspan<enc0.size(), (n̄ * n̄ * D) / 8>();
-  auto C = packing::unpack<n̄, n̄, D>(enc1);
+// Inputs of one encapsulation, in a batch, see `batch_encaps`.
+template<size_t len_sec, size_t len_salt>
+struct encaps_input_t
+{
+  std::array<uint8_t, len_sec / 8> μ{};
+  std::array<uint8_t, len_salt / 8> salt{};
+};
 
-  // = salt
-  auto enc2 = enc.template subspan<enc0.size() + enc1.size(), len_salt / 8>();
+// Outputs of one encapsulation, in a batch, see `batch_encaps`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_salt, size_t D>
+struct encaps_output_t
+{
+  std::array<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc{};
+  std::array<uint8_t, len_sec / 8> ss{};
+};
+
+// Given a batch of uniformly random values ( μ, salt ), along with a prepared
+// Frodo KEM public key, this routine computes a cipher text and a shared secret
+// for each of them, producing exactly same outputs as calling `encaps` for each
+// of them, one by one. Only as many inputs as there are outputs are processed,
+// returning how many cipher texts and shared secrets got computed.
+//
+// Matrices S' of all encapsulations in the batch are stacked into a single
+// (k·n̄) x n operand, so that matrix A is generated and streamed only once, for
+// the whole batch, and B' of all encapsulations come out of a single pass over
+// A ( see `matmul::s_mul_a_add_e_batch` ). When fanning out many sessions to
+// the same public key, this turns cost of encapsulation from being dominated by
+// generation of A, to being dominated by arithmetic.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+batch_encaps(const prepared_public_key<n, n̄, len_sec, len_A, D, prg>& ppk,
+             std::span<const encaps_input_t<len_sec, len_salt>> inputs,
+             std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>> outputs)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const size_t count = std::min(inputs.size(), outputs.size());
 
-  // Parse secret key
-  // = s
-  auto skey0 = skey.template subspan<0, len_sec / 8>();
+  std::vector<std::array<uint8_t, (len_SE + len_sec) / 8>> rand_bytes(count);
+  std::vector<matrix::matrix<n̄, n, D>> S_primes(count), B_primes(count);
+  std::vector<matrix::matrix<n̄, n̄, D>> E_dprimes(count);
 
-  // = seedA
-  constexpr size_t soff0 = skey0.size();
-  auto skey1 = skey.template subspan<soff0, len_A / 8>();
+  // B' starts off as E', which is accumulated on top of.
+  for (size_t r = 0; r < count; r++) {
+    internal::encaps_sample<n, n̄, len_sec, len_SE, len_salt, D>(
+      ppk.pkh(), inputs[r].μ, inputs[r].salt, rand_bytes[r], S_primes[r], B_primes[r], E_dprimes[r]);
+  }
 
-  // = b
-  constexpr size_t soff1 = soff0 + skey1.size();
-  auto skey2 = skey.template subspan<soff1, (n * n̄ * D) / 8>();
+  matmul::s_mul_a_add_e_batch<n, n̄, D>(ppk.a_rows(), std::span<const matrix::matrix<n̄, n, D>>(S_primes), std::span(B_primes));
 
-  // = S_transposed
-  constexpr size_t soff2 = soff1 + skey2.size();
-  auto skey3 = skey.template subspan<soff2, n̄ * n * 2>();
-  auto S_transposed = matrix::matrix<n̄, n, D>::read_from_le_bytes(skey3);
-  auto S = S_transposed.transpose();
+  for (size_t r = 0; r < count; r++) {
+    internal::encaps_finish<n, n̄, len_sec, len_SE, len_salt, B, D>(
+      inputs[r].μ, inputs[r].salt, rand_bytes[r], ppk.b_matrix(), S_primes[r], B_primes[r], E_dprimes[r], outputs[r].enc, outputs[r].ss);
+  }
 
-  // = pkh
-  constexpr size_t soff3 = soff2 + skey3.size();
-  auto skey4 = skey.template subspan<soff3, skey.size() - soff3>();
+  return count;
+}
 
-  auto M = C - B_prime * S;
+// Given a batch of uniformly random values ( μ, salt ), along with a target
+// Frodo KEM public key, this routine computes a cipher text and a shared secret
+// for each of them, exactly as `batch_encaps` does with a prepared public key.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+batch_encaps(std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+             std::span<const encaps_input_t<len_sec, len_salt>> inputs,
+             std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>> outputs)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(pkey);
+  return batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(ppk, inputs, outputs);
+}
 
-  std::array<uint8_t, len_sec / 8> μ_prime{};
-  encoding::decode<n̄, n̄, D, B>(M, μ_prime);
+// Given a uniformly random values μ and salt, along with a target Frodo KEM
+// public key ( for which the cipher text is going to be computed i.e. only
+// corresponding private key can be used for decrypting the cipher text ), this
+// routine can be used for computing a cipher text and a shared secret,
+// following algorithm definition in section 8.2 of FrodoKEM specification.
+//
+// When encapsulating to the same public key many times, prefer preparing it
+// once, using `prepared_public_key`.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       std::span<const uint8_t, len_salt / 8> salt,
+       std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+       std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  internal::encaps_scratch_t<n, n̄, D> scratch{};
+  internal::encaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, pkey, enc, ss, scratch);
+}
 
-  std::array<uint8_t, (len_SE + len_sec) / 8> rand_bytes{};
+// Compile-time computable byte length of the workspace, which a caller must
+// provide to `encaps`, for keeping all intermediate matrices ( S', E', B', E''
+// and a block of rows of A ), whose size depends on n, off stack. Matrix B is
+// read straight out of a serialized public key, so no prepared public key is
+// kept in the workspace.
+template<size_t n, size_t n̄, size_t D>
+constexpr size_t
+encaps_workspace_len()
+{
+  return sizeof(internal::encaps_scratch_t<n, n̄, D>);
+}
 
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
+// Given uniformly random values μ and salt, a prepared Frodo KEM public key and
+// a caller-owned workspace ( aligned to `WORKSPACE_ALIGNMENT` ), this routine
+// computes a cipher text and a shared secret, exactly as `encaps` does,
+// carving all intermediate matrices out of the workspace.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       std::span<const uint8_t, len_salt / 8> salt,
+       const prepared_public_key<n, n̄, len_sec, len_A, D, prg>& ppk,
+       std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, encaps_workspace_len<n, n̄, D>()> workspace)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::encaps_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::encaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, enc, ss, scratch);
+}
 
-    hasher.absorb(skey4);
-    hasher.absorb(μ_prime);
-    hasher.absorb(enc2);
-    hasher.finalize();
-    hasher.squeeze(rand_bytes);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
+// Given uniformly random values μ and salt, a target Frodo KEM public key and a
+// caller-owned workspace ( aligned to `WORKSPACE_ALIGNMENT` ), this routine
+// computes a cipher text and a shared secret, exactly as `encaps` does,
+// carving all intermediate matrices out of the workspace. So a workspace can
+// be allocated once, per thread, and reused across calls, with no per-call
+// stack or heap growth.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps(std::span<const uint8_t, len_sec / 8> μ,
+       std::span<const uint8_t, len_salt / 8> salt,
+       std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)> pkey,
+       std::span<uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, encaps_workspace_len<n, n̄, D>()> workspace)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::encaps_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::encaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, pkey, enc, ss, scratch);
+}
+
+namespace internal {
 
-    hasher.absorb(skey4);
-    hasher.absorb(μ_prime);
-    hasher.absorb(enc2);
+// Intermediate values of `encaps_x4`, see `encaps_x4_workspace_len`. Matrices
+// S', E' and E'' of all encapsulations are sampled together, while a block of
+// rows of A is reused across encapsulations, as they're computed one by one.
+template<size_t n, size_t n̄, size_t D>
+struct encaps_x4_scratch_t
+{
+  std::array<matrix::matrix<n̄, n, D>, X4> S_primes;
+  std::array<matrix::matrix<n̄, n, D>, X4> B_primes; // Hold E', before B' = S' * A + E' is computed.
+  std::array<matrix::matrix<n̄, n̄, D>, X4> E_dprimes;
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows;
+};
+
+// Given 4 target Frodo KEM public keys, uniformly random values ( μ, salt ) for
+// each of them and scratch space for intermediate values, this routine
+// computes a cipher text and a shared secret for each of them, see
+// `encaps_x4`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D, gen_a::prg_t prg>
+inline void
+encaps_x4_with(std::span<const std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)>, X4> pkeys,
+               std::span<const encaps_input_t<len_sec, len_salt>, X4> inputs,
+               std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>, X4> outputs,
+               encaps_x4_scratch_t<n, n̄, D>& scratch)
+{
+  constexpr size_t lanes = X4;
+  constexpr size_t ctlen = kem_cipher_text_len(n, n̄, len_salt, D);
+
+  std::array<std::array<uint8_t, len_sec / 8>, lanes> pkhs{};
+  std::array<std::array<uint8_t, (len_SE + len_sec) / 8>, lanes> rand_bytes{};
+  std::array<std::array<uint8_t, 1 + len_SE / 8>, lanes> bufs{};
+
+  std::array<const uint8_t*, lanes> msgs{};
+  std::array<uint8_t*, lanes> outs{};
+
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j] = pkeys[j].data();
+    outs[j] = pkhs[j].data();
+  }
+  xof_x4<n>(msgs, pkeys[0].size(), outs, len_sec / 8);
+
+  // seedSE || k is derived from pkh || μ || salt, absorbed piece by piece.
+  {
+    xof_x4_t<n> hasher;
+
+    for (size_t j = 0; j < lanes; j++) {
+      msgs[j] = pkhs[j].data();
+    }
+    hasher.absorb(msgs, len_sec / 8);
+
+    for (size_t j = 0; j < lanes; j++) {
+      msgs[j] = inputs[j].μ.data();
+    }
+    hasher.absorb(msgs, len_sec / 8);
+
+    for (size_t j = 0; j < lanes; j++) {
+      msgs[j] = inputs[j].salt.data();
+    }
+    hasher.absorb(msgs, len_salt / 8);
     hasher.finalize();
-    hasher.squeeze(rand_bytes);
+
+    for (size_t j = 0; j < lanes; j++) {
+      outs[j] = rand_bytes[j].data();
+    }
+    hasher.squeeze(outs, rand_bytes[0].size());
   }
 
-  std::array<uint8_t, 1 + (len_SE) / 8> buf{};
-  std::array<uint8_t, ((2 * n̄ * n + n̄ * n̄) * 16) / 8> dig{};
+  // S', E' and E'' of all encapsulations are sampled straight out of the XOFs,
+  // squeezed in lockstep, never materializing their output, see
+  // `sampling::sample_matrix_x4`. B' starts off as E', which is accumulated on
+  // top of.
+  {
+    for (size_t j = 0; j < lanes; j++) {
+      bufs[j][0] = 0x96;
+      std::memcpy(bufs[j].data() + 1, rand_bytes[j].data(), len_SE / 8);
 
-  buf[0] = 0x96;
-  std::memcpy(buf.data() + 1, rand_bytes.data(), buf.size() - 1);
+      msgs[j] = bufs[j].data();
+    }
 
-  if constexpr (n == 640) {
-    shake128::shake128_t hasher;
+    xof_x4_t<n> hasher;
 
-    hasher.absorb(buf);
+    hasher.absorb(msgs, bufs[0].size());
     hasher.finalize();
-    hasher.squeeze(dig);
-  } else if constexpr ((n == 976) || (n == 1344)) {
-    shake256::shake256_t hasher;
 
-    hasher.absorb(buf);
-    hasher.finalize();
-    hasher.squeeze(dig);
+    sampling::sample_matrix_x4<n, n̄, n, D>(hasher, std::span(scratch.S_primes));
+    sampling::sample_matrix_x4<n, n̄, n, D>(hasher, std::span(scratch.B_primes));
+    sampling::sample_matrix_x4<n, n̄, n̄, D>(hasher, std::span(scratch.E_dprimes));
   }
 
-  std::span<uint8_t, dig.size()> _dig{ dig };
+  for (size_t j = 0; j < lanes; j++) {
+    const auto& S_prime = scratch.S_primes[j];
+    auto& B_prime = scratch.B_primes[j];
 
-  constexpr size_t doff0 = (n̄ * n * 16) / 8;
-  auto _dig0 = _dig.template subspan<0, doff0>();
-  auto S_prime = sampling::sample_matrix<n, n̄, n, D>(_dig0);
+    const gen_a::row_generator_t<n, len_A, D, prg> a_rows(pkeys[j].template subspan<0, len_A / 8>());
+    matmul::s_mul_a_add_e<n, n̄, D>(a_rows, S_prime, B_prime, scratch.a_rows);
 
-  constexpr size_t doff1 = doff0 + (n̄ * n * 16) / 8;
-  auto _dig1 = _dig.template subspan<doff0, doff1 - doff0>();
-  auto E_prime = sampling::sample_matrix<n, n̄, n, D>(_dig1);
+    const packing::packed_t<n, n̄, D> B_mat{ pkeys[j].template subspan<len_A / 8, kem_pub_key_len(n, n̄, len_A, D) - len_A / 8>() };
+    encaps_pack<n, n̄, len_sec, len_salt, B, D>(inputs[j].μ, inputs[j].salt, B_mat, S_prime, B_prime, scratch.E_dprimes[j], outputs[j].enc);
+  }
 
-  auto A = matrix::matrix<n, n, D>::template generate<len_A>(skey1);
-  auto B_dprime = S_prime * A + E_prime;
+  // Shared secret is derived from cipher text || k, absorbed piece by piece.
+  xof_x4_t<n> hasher;
 
-  auto _dig2 = _dig.template subspan<doff1, _dig.size() - doff1>();
-  auto E_dprime = sampling::sample_matrix<n, n̄, n̄, D>(_dig2);
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j] = outputs[j].enc.data();
+  }
+  hasher.absorb(msgs, ctlen);
 
-  auto B_mat = packing::unpack<n, n̄, D>(skey2);
-  auto V = S_prime * B_mat + E_dprime;
+  for (size_t j = 0; j < lanes; j++) {
+    msgs[j] = rand_bytes[j].data() + len_SE / 8;
+  }
+  hasher.absorb(msgs, len_sec / 8);
+  hasher.finalize();
 
-  auto M_prime = encoding::encode<n̄, n̄, D, B>(μ_prime);
-  auto C_prime = V + M_prime;
+  for (size_t j = 0; j < lanes; j++) {
+    outs[j] = outputs[j].ss.data();
+  }
+  hasher.squeeze(outs, len_sec / 8);
+}
+
+}
+
+// Given 4 target Frodo KEM public keys ( possibly all distinct ), along with
+// uniformly random values ( μ, salt ) for each of them, this routine computes
+// a cipher text and a shared secret for each of them, producing exactly same
+// outputs as calling `encaps` for each of them, one by one.
+//
+// Hashing of public keys into pkh, derivation of seedSE || k, squeezing
+// seedSE's XOF output, out of which S', E' and E'' are sampled, and derivation
+// of shared secrets run for all 4 encapsulations in lockstep, on 4-way SIMD
+// Keccak-f[1600], when the active instruction set tier allows it. Rows of each
+// matrix A are already generated in SIMD lanes, several rows at a time ( see
+// `gen_a::generate_rows` ).
+//
+// S', E' and E'' of all 4 encapsulations are alive at once, which is as much as
+// 4 x 43 KiB for the 1344 parameter sets, so scratch space is allocated on
+// heap. Prefer the overload taking a workspace, for reusing it across calls.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps_x4(std::span<const std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)>, 4> pkeys,
+          std::span<const encaps_input_t<len_sec, len_salt>, 4> inputs,
+          std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>, 4> outputs)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const auto scratch = std::make_unique_for_overwrite<internal::encaps_x4_scratch_t<n, n̄, D>>();
+  internal::encaps_x4_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(pkeys, inputs, outputs, *scratch);
+}
+
+// Compile-time computable byte length of the workspace, which a caller must
+// provide to `encaps_x4`, for keeping matrices S', E' and E'' of all 4
+// encapsulations, along with a block of rows of A, which is reused across
+// encapsulations, off stack.
+template<size_t n, size_t n̄, size_t D>
+constexpr size_t
+encaps_x4_workspace_len()
+{
+  return sizeof(internal::encaps_x4_scratch_t<n, n̄, D>);
+}
+
+// Given 4 target Frodo KEM public keys, uniformly random values ( μ, salt ) for
+// each of them and a caller-owned workspace ( aligned to `WORKSPACE_ALIGNMENT`
+// ), this routine computes a cipher text and a shared secret for each of them,
+// exactly as above, carving all intermediate values out of the workspace.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+encaps_x4(std::span<const std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)>, 4> pkeys,
+          std::span<const encaps_input_t<len_sec, len_salt>, 4> inputs,
+          std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>, 4> outputs,
+          std::span<uint8_t, encaps_x4_workspace_len<n, n̄, D>()> workspace)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::encaps_x4_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::encaps_x4_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(pkeys, inputs, outputs, scratch);
+}
+
+// Given a batch of target Frodo KEM public keys ( possibly all distinct ), along
+// with uniformly random values ( μ, salt ) for each of them, this routine
+// computes a cipher text and a shared secret for each of them, 4 at a time
+// ( see `encaps_x4` ), producing exactly same outputs as calling `encaps` for
+// each of them, one by one. Rest of the encapsulations ( if any ) are computed
+// one by one. Only as many encapsulations as the shortest span holds are
+// computed, returning their count. Scratch space for intermediate values is
+// allocated on heap, once, for the whole batch.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+multi_encaps(std::span<const std::span<const uint8_t, kem_pub_key_len(n, n̄, len_A, D)>> pkeys,
+             std::span<const encaps_input_t<len_sec, len_salt>> inputs,
+             std::span<encaps_output_t<n, n̄, len_sec, len_salt, D>> outputs)
+  requires(frodo_params::check_encaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  constexpr size_t x4 = internal::X4;
+  const size_t count = std::min({ pkeys.size(), inputs.size(), outputs.size() });
+
+  size_t r = 0;
+  if (count >= x4) {
+    const auto scratch = std::make_unique_for_overwrite<internal::encaps_x4_scratch_t<n, n̄, D>>();
+
+    for (; r + x4 <= count; r += x4) {
+      internal::encaps_x4_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(
+        pkeys.subspan(r).template first<x4>(), inputs.subspan(r).template first<x4>(), outputs.subspan(r).template first<x4>(), *scratch);
+    }
+  }
+
+  if (r < count) {
+    const auto scratch = std::make_unique_for_overwrite<internal::encaps_scratch_t<n, n̄, D>>();
+
+    for (; r < count; r++) {
+      internal::encaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(inputs[r].μ, inputs[r].salt, pkeys[r], outputs[r].enc, outputs[r].ss, *scratch);
+    }
+  }
+
+  return count;
+}
+
+// Frodo KEM secret key, parsed once and kept ready for repeated decapsulation.
+// It holds secret seed s, pkh, the unpacked matrix B, matrix S^T ( of dimension
+// n̄ x n, exactly as it's serialized and as consumed by B' * S, so it's never
+// transposed ) and a source of rows of matrix A, keyed by seedA, so that none
+// of them are recomputed by `decaps`. When prepared with a cache of expanded
+// matrices A ( see `a_cache` ), rows of A are read from the cache, instead of
+// being generated, on every `decaps`.
+//
+// It's immutable, once constructed, so a single instance can be shared by
+// many threads, decapsulating concurrently.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+struct prepared_secret_key
+{
+private:
+  std::array<uint8_t, len_sec / 8> _s{};
+  std::array<uint8_t, len_sec / 8> _pkh{};
+  a_cache::row_source_t<n, len_A, D, prg> _a_rows;
+  matrix::matrix<n, n̄, D> _B_mat{};
+  matrix::matrix<n̄, n, D> _S_transposed{};
+
+  // Parses serialized secret key, unpacking matrix B and deserializing matrix S^T.
+  inline void parse(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey)
+  {
+    // = s
+    auto skey0 = skey.template subspan<0, len_sec / 8>();
+    std::copy(skey0.begin(), skey0.end(), this->_s.begin());
+
+    // = b
+    constexpr size_t soff1 = skey0.size() + len_A / 8;
+    auto skey2 = skey.template subspan<soff1, (n * n̄ * D) / 8>();
+    packing::unpack<n, n̄, D>(skey2, this->_B_mat);
+
+    // = S_transposed
+    constexpr size_t soff2 = soff1 + skey2.size();
+    auto skey3 = skey.template subspan<soff2, n̄ * n * 2>();
+    this->_S_transposed.read_le_bytes(skey3);
+
+    // = pkh
+    constexpr size_t soff3 = soff2 + skey3.size();
+    auto skey4 = skey.template subspan<soff3, skey.size() - soff3>();
+    std::copy(skey4.begin(), skey4.end(), this->_pkh.begin());
+  }
+
+public:
+  // Given a serialized Frodo KEM secret key, this routine parses it, unpacking
+  // matrix B, deserializing matrix S and preparing generator of matrix A, from
+  // seedA.
+  explicit prepared_secret_key(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey)
+    : _a_rows(skey.template subspan<len_sec / 8, len_A / 8>())
+  {
+    this->parse(skey);
+  }
+
+  // Given a serialized Frodo KEM secret key and a cache of expanded matrices
+  // A, this routine parses it, unpacking matrix B, deserializing matrix S and
+  // looking up ( or expanding and inserting ) matrix A, for seedA, in the
+  // cache.
+  prepared_secret_key(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey, a_cache::cache_t& cache)
+    : _a_rows(skey.template subspan<len_sec / 8, len_A / 8>(), cache)
+  {
+    this->parse(skey);
+  }
+
+  // Returns secret seed s, used for implicit rejection.
+  inline std::span<const uint8_t, len_sec / 8> s() const { return this->_s; }
+
+  // Returns hash of serialized public key.
+  inline std::span<const uint8_t, len_sec / 8> pkh() const { return this->_pkh; }
+
+  // Returns source of rows of matrix A.
+  inline const a_cache::row_source_t<n, len_A, D, prg>& a_rows() const { return this->_a_rows; }
+
+  // Returns unpacked matrix B, of dimension n x n̄.
+  inline const matrix::matrix<n, n̄, D>& b_matrix() const { return this->_B_mat; }
+
+  // Returns matrix S^T, of dimension n̄ x n.
+  inline const matrix::matrix<n̄, n, D>& s_transposed() const { return this->_S_transposed; }
+};
+
+namespace internal {
+
+// Intermediate matrices of decapsulation, see `decaps_workspace_len`.
+template<size_t n, size_t n̄, size_t D>
+struct decaps_scratch_t
+{
+  matrix::matrix<n̄, n, D> S_prime;
+  matrix::matrix<n̄, n, D> B_dprime; // Holds E', before B'' = S' * A + E' is computed.
+  matrix::matrix<n̄, n̄, D> E_dprime;
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows;
+};
+
+// Given a FrodoKEM cipher text and matrix S^T, this routine decrypts it,
+// recovering μ', as required in steps 1 - 6 of algorithm 14 of FrodoKEM
+// specification.
+//
+// Neither B' nor C is unpacked into memory. B' * S is computed straight off
+// packed B' ( see `matmul::mul_packed_st` ), while unpacking of C, M = C - B' *
+// S and Decode(M) are fused, one block of 8 elements at a time, each taking
+// D -bytes of packed C and giving its B -bytes of μ'.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_salt, size_t B, size_t D>
+inline void
+decaps_decrypt(std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+               const matrix::matrix<n̄, n, D>& S_transposed,
+               std::span<uint8_t, len_sec / 8> μ_prime)
+  requires(len_sec == n̄ * n̄ * B)
+{
+  constexpr size_t blk_elems = packing::BLOCK_ELEMS;
+
+  // Parse cipher text
+  // = c1
+  const packing::packed_t<n̄, n, D> B_prime{ enc.template subspan<0, (n̄ * n * D) / 8>() };
+
+  // = c2
+  auto enc1 = enc.template subspan<B_prime.bytes.size(), (n̄ * n̄ * D) / 8>();
+
+  const matrix::matrix<n̄, n̄, D> W = matmul::mul_packed_st<n̄, n, n̄, D>(B_prime, S_transposed);
+  std::array<zq::zq_t<D>, blk_elems> M{};
+
+  for (size_t blk = 0; blk < (n̄ * n̄) / blk_elems; blk++) {
+    packing::unpack_block<D>(std::span<const uint8_t, D>(enc1.subspan(blk * D, D)), M.data());
+
+    for (size_t k = 0; k < blk_elems; k++) {
+      M[k] = M[k] - W[blk * blk_elems + k];
+    }
+
+    encoding::decode_block<D, B>(M.data(), std::span<uint8_t, B>(μ_prime.subspan(blk * B, B)));
+  }
+}
+
+// Given a FrodoKEM cipher text, recovered μ' and re-encryption B'' = S' * A +
+// E', this routine completes re-encryption and, in constant-time, compares it
+// with the cipher text, selecting k' or s, from which shared secret is
+// derived, as required in steps 12 - 16 of algorithm 14 of FrodoKEM
+// specification.
+//
+// B'' is compared with packed B', as it appears in the cipher text, while C' is
+// computed in packed form ( see `encrypt_c` ) and compared with packed C.
+// Packing is a bijection between matrices over Zq and bit strings, so it's same
+// as comparing unpacked matrices.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D, gen_a::prg_t prg>
+inline void
+decaps_finish(const prepared_secret_key<n, n̄, len_sec, len_A, D, prg>& psk,
+              std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+              std::span<const uint8_t, len_sec / 8> μ_prime,
+              std::span<const uint8_t, (len_SE + len_sec) / 8> rand_bytes,
+              const matrix::matrix<n̄, n, D>& S_prime,
+              const matrix::matrix<n̄, n, D>& B_dprime,
+              const matrix::matrix<n̄, n̄, D>& E_dprime,
+              std::span<uint8_t, len_sec / 8> ss)
+{
+  const packing::packed_t<n̄, n, D> B_prime{ enc.template subspan<0, (n̄ * n * D) / 8>() };
+  auto enc1 = enc.template subspan<B_prime.bytes.size(), (n̄ * n̄ * D) / 8>();
+
+  std::array<uint8_t, enc1.size()> c_prime{};
+  encrypt_c<n, n̄, len_sec, B, D>(μ_prime, psk.b_matrix(), S_prime, E_dprime, c_prime);
 
   // Constant-time implementation of step 15
   // --- begins ---
+  uint8_t c_diff = 0;
+  for (size_t i = 0; i < c_prime.size(); i++) {
+    c_diff |= c_prime[i] ^ enc1[i];
+  }
+
   const uint32_t br0 = B_prime.ct_equal(B_dprime);
-  const uint32_t br1 = C.ct_equal(C_prime);
+  const uint32_t br1 = subtle::ct_eq<uint8_t, uint32_t>(c_diff, 0);
   const uint32_t br = br0 & br1;
 
   auto k_prime = rand_bytes.data() + (len_SE / 8);
+  auto s = psk.s();
   std::array<uint8_t, (len_sec + 7) / 8> k̄{};
 
   for (size_t i = 0; i < k̄.size(); i++) {
-    k̄[i] = subtle::ct_select(br, k_prime[i], skey0[i]);
+    k̄[i] = subtle::ct_select(br, k_prime[i], s[i]);
   }
   // --- ends ---
 
@@ -394,4 +1421,230 @@ decaps(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey
   }
 }
 
+// Given a FrodoKEM cipher text, a prepared secret key and scratch space for
+// intermediate matrices, this routine recovers shared secret, see `decaps`.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_SE, size_t len_A, size_t len_salt, size_t B, size_t D, gen_a::prg_t prg>
+inline void
+decaps_with(const prepared_secret_key<n, n̄, len_sec, len_A, D, prg>& psk,
+            std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+            std::span<uint8_t, len_sec / 8> ss,
+            decaps_scratch_t<n, n̄, D>& scratch)
+{
+  std::array<uint8_t, len_sec / 8> μ_prime{};
+
+  decaps_decrypt<n, n̄, len_sec, len_salt, B, D>(enc, psk.s_transposed(), μ_prime);
+
+  // = salt
+  constexpr size_t salt_off = kem_cipher_text_len(n, n̄, len_salt, D) - len_salt / 8;
+  auto salt = enc.template subspan<salt_off, len_salt / 8>();
+
+  std::array<uint8_t, (len_SE + len_sec) / 8> rand_bytes{};
+
+  // B'' starts off as E', which is accumulated on top of.
+  encaps_sample<n, n̄, len_sec, len_SE, len_salt, D>(psk.pkh(), μ_prime, salt, rand_bytes, scratch.S_prime, scratch.B_dprime, scratch.E_dprime);
+  matmul::s_mul_a_add_e<n, n̄, D>(psk.a_rows(), scratch.S_prime, scratch.B_dprime, scratch.a_rows);
+
+  decaps_finish<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(
+    psk, enc, μ_prime, rand_bytes, scratch.S_prime, scratch.B_dprime, scratch.E_dprime, ss);
+}
+
+}
+
+// Given a FrodoKEM cipher text and a prepared secret key ( see
+// `prepared_secret_key` ), associated with the public key, using which the
+// cipher text was computed, this routine can be used for decrypting the cipher
+// text, recovering shared secret, following algorithm definition in section
+// 8.3 of FrodoKEM specification, while skipping parsing of secret key, which
+// was already done, when the secret key was prepared.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+decaps(const prepared_secret_key<n, n̄, len_sec, len_A, D, prg>& psk,
+       std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  internal::decaps_scratch_t<n, n̄, D> scratch{};
+  internal::decaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, enc, ss, scratch);
+}
+
+// Given a batch of FrodoKEM cipher texts and a prepared secret key, associated
+// with the public key, using which all of them were computed, this routine
+// recovers shared secret of each of them, producing exactly same outputs as
+// calling `decaps` for each of them, one by one. Only as many cipher texts as
+// there are shared secrets are processed, returning how many shared secrets got
+// recovered.
+//
+// Re-encryption matrices S' of all cipher texts in the batch are stacked into a
+// single (k·n̄) x n operand, so that matrix A is generated and streamed only
+// once, for the whole batch ( see `matmul::s_mul_a_add_e_batch` ). Comparison
+// of each re-encrypted cipher text and selection of k' or s stay constant-time
+// and independent of other cipher texts in the batch.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+batch_decaps(const prepared_secret_key<n, n̄, len_sec, len_A, D, prg>& psk,
+             std::span<const std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)>> encs,
+             std::span<const std::span<uint8_t, len_sec / 8>> sss)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const size_t count = std::min(encs.size(), sss.size());
+
+  std::vector<matrix::matrix<n̄, n, D>> S_primes(count), B_dprimes(count);
+  std::vector<matrix::matrix<n̄, n̄, D>> E_dprimes(count);
+  std::vector<std::array<uint8_t, len_sec / 8>> μ_primes(count);
+  std::vector<std::array<uint8_t, (len_SE + len_sec) / 8>> rand_bytes(count);
+
+  constexpr size_t salt_off = kem_cipher_text_len(n, n̄, len_salt, D) - len_salt / 8;
+
+  // B'' starts off as E', which is accumulated on top of.
+  for (size_t r = 0; r < count; r++) {
+    internal::decaps_decrypt<n, n̄, len_sec, len_salt, B, D>(encs[r], psk.s_transposed(), μ_primes[r]);
+
+    auto salt = encs[r].template subspan<salt_off, len_salt / 8>();
+    internal::encaps_sample<n, n̄, len_sec, len_SE, len_salt, D>(psk.pkh(), μ_primes[r], salt, rand_bytes[r], S_primes[r], B_dprimes[r], E_dprimes[r]);
+  }
+
+  matmul::s_mul_a_add_e_batch<n, n̄, D>(psk.a_rows(), std::span<const matrix::matrix<n̄, n, D>>(S_primes), std::span(B_dprimes));
+
+  for (size_t r = 0; r < count; r++) {
+    internal::decaps_finish<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(
+      psk, encs[r], μ_primes[r], rand_bytes[r], S_primes[r], B_dprimes[r], E_dprimes[r], sss[r]);
+  }
+
+  return count;
+}
+
+// Given a FrodoKEM cipher text and secret key, which is associated with the
+// public key, using which the cipher text was computed, this routine can be
+// used for decrypting the cipher text, recovering shared secret, following
+// algorithm definition in section 8.3 of FrodoKEM specification.
+//
+// When decapsulating using the same secret key many times, prefer preparing it
+// once, using `prepared_secret_key`.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+decaps(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
+       std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(skey);
+  decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, enc, ss);
+}
+
+// Compile-time computable byte length of the workspace, which a caller must
+// provide to `decaps`, for keeping the prepared secret key and all
+// intermediate matrices ( S', E', B'', E'' and a block of rows of A ), whose
+// size depends on n, off stack. Decapsulating with an already prepared secret
+// key needs only a prefix of it.
+template<size_t n, size_t n̄, size_t len_sec, size_t len_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+constexpr size_t
+decaps_workspace_len()
+{
+  return internal::align_workspace(sizeof(prepared_secret_key<n, n̄, len_sec, len_A, D, prg>)) + sizeof(internal::decaps_scratch_t<n, n̄, D>);
+}
+
+// Given a FrodoKEM cipher text, a prepared secret key and a caller-owned
+// workspace ( aligned to `WORKSPACE_ALIGNMENT` ), this routine recovers shared
+// secret, exactly as `decaps` does, carving all intermediate matrices out of
+// the workspace.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+decaps(const prepared_secret_key<n, n̄, len_sec, len_A, D, prg>& psk,
+       std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, decaps_workspace_len<n, n̄, len_sec, len_A, D, prg>()> workspace)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  auto& scratch = internal::workspace_emplace<internal::decaps_scratch_t<n, n̄, D>>(workspace, 0);
+  internal::decaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, enc, ss, scratch);
+}
+
+// Given a FrodoKEM cipher text, the secret key, associated with the public key,
+// using which the cipher text was computed, and a caller-owned workspace
+// ( aligned to `WORKSPACE_ALIGNMENT` ), this routine recovers shared secret,
+// exactly as `decaps` does, preparing the secret key and carving all
+// intermediate matrices out of the workspace. So a workspace can be allocated
+// once, per thread, and reused across calls, with no per-call stack or heap
+// growth.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+decaps(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
+       std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)> enc,
+       std::span<uint8_t, len_sec / 8> ss,
+       std::span<uint8_t, decaps_workspace_len<n, n̄, len_sec, len_A, D, prg>()> workspace)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  using psk_t = prepared_secret_key<n, n̄, len_sec, len_A, D, prg>;
+  constexpr size_t scratch_off = internal::align_workspace(sizeof(psk_t));
+
+  const auto& psk = internal::workspace_emplace<psk_t>(workspace, 0, skey);
+  auto& scratch = internal::workspace_emplace<internal::decaps_scratch_t<n, n̄, D>>(workspace, scratch_off);
+
+  internal::decaps_with<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, enc, ss, scratch);
+  std::destroy_at(&psk);
+}
+
+// Given a batch of FrodoKEM cipher texts and secret key, associated with the
+// public key, using which all of them were computed, this routine recovers
+// shared secret of each of them, exactly as `batch_decaps` does with a
+// prepared secret key.
+template<size_t n,
+         size_t n̄,
+         size_t len_sec,
+         size_t len_SE,
+         size_t len_A,
+         size_t len_salt,
+         size_t B,
+         size_t D,
+         gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline size_t
+batch_decaps(std::span<const uint8_t, kem_sec_key_len(n, n̄, len_sec, len_A, D)> skey,
+             std::span<const std::span<const uint8_t, kem_cipher_text_len(n, n̄, len_salt, D)>> encs,
+             std::span<const std::span<uint8_t, len_sec / 8>> sss)
+  requires(frodo_params::check_decaps_params(n, n̄, len_sec, len_SE, len_A, len_salt, B, D))
+{
+  const prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(skey);
+  return batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, encs, sss);
+}
+
 }
@@ -0,0 +1,401 @@
+#pragma once
+#include "dispatch.hpp"
+#include "gen_a.hpp"
+#include "matmul_avx2.hpp"
+#include "matmul_avx512.hpp"
+#include "matrix.hpp"
+#include "packing.hpp"
+#include "swar.hpp"
+#include "zq.hpp"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <span>
+
+// Multiplication with pseudorandom matrix A, which is streamed row by row
+namespace matmul {
+
+// # -of consecutive rows of A, which are generated together and consumed by
+// A * S + E kernel, before being thrown away. It matches widest multi-lane
+// SHAKE128 kernel, so that a block is generated in one go. For n = 1344, it's
+// 21 KB, which still fits in L1 data cache.
+constexpr size_t A_ROWS_PER_BLOCK = 8;
+
+// Given `rows` -many rows of some matrix X ( each of length n ), matrix S^T of
+// dimension n̄ x n and matching `rows` -many rows of E ( each of length n̄ ),
+// this routine computes corresponding rows of X * S + E.
+//
+// S is consumed in its transposed form, as it's sampled and serialized, so no
+// transposed copy is ever made. Element (i, j) of X * S is the dot product of
+// row i of X and row j of S^T, both of which are contiguous.
+template<size_t rows, size_t n, size_t n̄, size_t D>
+inline void
+rows_mul_st_add_e(const zq::zq_t<D>* const x, const matrix::matrix<n̄, n, D>& S_transposed, const zq::zq_t<D>* const e, zq::zq_t<D>* const b)
+{
+#if defined(__x86_64__)
+  if constexpr ((n̄ == 8) && (n % 16 == 0)) {
+    static_assert(sizeof(zq::zq_t<D>) == sizeof(uint16_t), "Zq element must be backed by a 16 -bit word");
+
+    const auto x_ptr = reinterpret_cast<const uint16_t*>(x);
+    const auto st_ptr = reinterpret_cast<const uint16_t*>(S_transposed.data());
+    const auto e_ptr = reinterpret_cast<const uint16_t*>(e);
+    const auto b_ptr = reinterpret_cast<uint16_t*>(b);
+
+    switch (dispatch::active_tier()) {
+      case dispatch::tier_t::avx512bw:
+        if constexpr (rows % 2 == 0) {
+          matmul_avx512::mul_st_add_e<n, rows>(x_ptr, st_ptr, e_ptr, b_ptr);
+          return;
+        }
+        [[fallthrough]];
+      case dispatch::tier_t::avx2:
+        matmul_avx2::mul_st_add_e<n, rows>(x_ptr, st_ptr, e_ptr, b_ptr);
+        return;
+      default:
+        break;
+    }
+  }
+#endif
+
+  if constexpr (swar::PREFERRED && (n̄ % swar::LANES == 0)) {
+    // Portable SWAR path : column k of S^T ( i.e. row k of S ) is packed in
+    // n̄/4 words, on the fly, which are shared among all rows of X, while
+    // products are lazily accumulated and reduced only once per row of output.
+    constexpr size_t words = n̄ / swar::LANES;
+    std::array<swar::acc_t, rows * words> acc{};
+
+    for (size_t k = 0; k < n; k++) {
+      for (size_t w = 0; w < words; w++) {
+        uint64_t s_kw = 0;
+        for (size_t l = 0; l < swar::LANES; l++) {
+          s_kw |= static_cast<uint64_t>(S_transposed[(w * swar::LANES + l) * n + k].to_raw()) << (l * 16);
+        }
+
+        for (size_t r = 0; r < rows; r++) {
+          swar::mul_acc(acc[r * words + w], s_kw, x[r * n + k].to_raw());
+        }
+      }
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t w = 0; w < words; w++) {
+        const size_t off = r * n̄ + w * swar::LANES;
+        swar::store(swar::add(swar::reduce(acc[r * words + w]), swar::load(e + off)), b + off);
+      }
+    }
+  } else {
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t j = 0; j < n̄; j++) {
+        zq::zq_t<D> acc = e[r * n̄ + j];
+
+        for (size_t k = 0; k < n; k++) {
+          acc += x[r * n + k] * S_transposed[j * n + k];
+        }
+
+        b[r * n̄ + j] = acc;
+      }
+    }
+  }
+}
+
+// Given a seed of length len_seed_A -bits ( for generating matrix A of
+// dimension n x n ), matrix S^T of dimension n̄ x n, matrix E of dimension
+// n x n̄ and scratch space for a block of rows of A, this routine can be used
+// for computing B = A * S + E, over Zq, as required in step 5 of algorithm 12
+// of FrodoKEM specification.
+//
+// Note, A is never materialized. A block of few rows of A is generated,
+// multiplied with S and accumulated on top of corresponding rows of E, while
+// it's still in L1 cache. So peak working memory stays at a few rows of A,
+// instead of 2n^2 -bytes. Neither is S, as rows of A are dotted with rows of
+// S^T, see `rows_mul_st_add_e`. Each row of E is consumed before the same row
+// of B is written, so B may alias E.
+template<size_t n, size_t n̄, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+a_mul_st_add_e(std::span<const uint8_t, (len_seed_A + 7) / 8> seed,
+               const matrix::matrix<n̄, n, D>& S_transposed,
+               const matrix::matrix<n, n̄, D>& E,
+               matrix::matrix<n, n̄, D>& B_mat,
+               std::span<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> scratch)
+  requires(n % A_ROWS_PER_BLOCK == 0)
+{
+  const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(seed);
+
+  for (size_t i = 0; i < n; i += A_ROWS_PER_BLOCK) {
+    rowgen.template generate<A_ROWS_PER_BLOCK>(i, scratch);
+
+    rows_mul_st_add_e<A_ROWS_PER_BLOCK, n, n̄, D>(scratch.data(), S_transposed, E.data() + i * n̄, B_mat.data() + i * n̄);
+  }
+}
+
+// Given a seed of length len_seed_A -bits ( for generating matrix A of
+// dimension n x n ), matrix S^T of dimension n̄ x n, matrix E of dimension
+// n x n̄ and scratch space for a block of rows of A, this routine computes
+// B = A * S + E, over Zq, same as above, but writes B in packed form, as it
+// appears in a public key, never materializing it.
+//
+// Each block of rows of B is final as soon as the matching block of rows of A
+// is consumed, so it's computed into a small buffer and packed right away, into
+// its slot of `packed_B`, before next block of rows of A is generated.
+template<size_t n, size_t n̄, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline void
+a_mul_st_add_e(std::span<const uint8_t, (len_seed_A + 7) / 8> seed,
+               const matrix::matrix<n̄, n, D>& S_transposed,
+               const matrix::matrix<n, n̄, D>& E,
+               std::span<uint8_t, (n * n̄ * D) / 8> packed_B,
+               std::span<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> scratch)
+  requires((n % A_ROWS_PER_BLOCK == 0) && ((A_ROWS_PER_BLOCK * n̄) % packing::BLOCK_ELEMS == 0))
+{
+  constexpr size_t blk_byte_len = (A_ROWS_PER_BLOCK * n̄ * D) / 8;
+
+  const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(seed);
+  matrix::matrix<A_ROWS_PER_BLOCK, n̄, D> b_rows{};
+
+  for (size_t i = 0; i < n; i += A_ROWS_PER_BLOCK) {
+    rowgen.template generate<A_ROWS_PER_BLOCK>(i, scratch);
+
+    rows_mul_st_add_e<A_ROWS_PER_BLOCK, n, n̄, D>(scratch.data(), S_transposed, E.data() + i * n̄, b_rows.data());
+    packing::pack(b_rows, std::span<uint8_t, blk_byte_len>(packed_B.subspan((i / A_ROWS_PER_BLOCK) * blk_byte_len, blk_byte_len)));
+  }
+}
+
+// Given a seed of length len_seed_A -bits ( for generating matrix A of
+// dimension n x n ), matrix S^T of dimension n̄ x n and matrix E of dimension
+// n x n̄, this routine computes B = A * S + E, over Zq, returning it, see above.
+template<size_t n, size_t n̄, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline matrix::matrix<n, n̄, D>
+a_mul_st_add_e(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const matrix::matrix<n̄, n, D>& S_transposed, const matrix::matrix<n, n̄, D>& E)
+  requires(n % A_ROWS_PER_BLOCK == 0)
+{
+  matrix::matrix<n, n̄, D> B_mat{};
+  std::array<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> a_rows{};
+
+  a_mul_st_add_e<n, n̄, len_seed_A, D, prg>(seed, S_transposed, E, B_mat, a_rows);
+  return B_mat;
+}
+
+// Given matrix X of dimension m x n and matrix S^T of dimension n̄ x n, this
+// routine computes X * S, of dimension m x n̄, e.g. B' * S, as required in
+// step 2 of algorithm 14 of FrodoKEM specification, never materializing S.
+template<size_t m, size_t n, size_t n̄, size_t D>
+inline matrix::matrix<m, n̄, D>
+mul_st(const matrix::matrix<m, n, D>& X, const matrix::matrix<n̄, n, D>& S_transposed)
+{
+  const matrix::matrix<m, n̄, D> zero{};
+  matrix::matrix<m, n̄, D> res{};
+
+  rows_mul_st_add_e<m, n, n̄, D>(X.data(), S_transposed, zero.data(), res.data());
+  return res;
+}
+
+// Given matrix X of dimension m x n, in packed form ( e.g. B', straight out of
+// a cipher text ), and matrix S^T of dimension n̄ x n, this routine computes
+// X * S, of dimension m x n̄, same as unpacking X and calling `mul_st` would.
+//
+// X is unpacked tile by tile, each tile being 2 rows ( or 1, if m is odd ),
+// into a buffer which stays hot in L1 cache and is multiplied with S^T, by
+// same kernels as `mul_st` uses, before next tile overwrites it. So X is never
+// unpacked into memory, as a whole.
+template<size_t m, size_t n, size_t n̄, size_t D>
+inline matrix::matrix<m, n̄, D>
+mul_packed_st(packing::packed_t<m, n, D> X, const matrix::matrix<n̄, n, D>& S_transposed)
+{
+  constexpr size_t tile_rows = (m % 2 == 0) ? 2 : 1;
+
+  const matrix::matrix<tile_rows, n̄, D> zero{};
+  matrix::matrix<tile_rows, n, D> tile{};
+  matrix::matrix<m, n̄, D> res{};
+
+  for (size_t i = 0; i < m; i += tile_rows) {
+    packing::unpack<tile_rows, n, D>(X.template rows<tile_rows>(i).bytes, tile);
+    rows_mul_st_add_e<tile_rows, n, n̄, D>(tile.data(), S_transposed, zero.data(), res.data() + i * n̄);
+  }
+
+  return res;
+}
+
+// Given matrix X of dimension m x n and matrix Y of dimension n x n̄, in packed
+// form ( e.g. B, straight out of a public key ), this routine computes X * Y,
+// of dimension m x n̄, same as unpacking Y and multiplying would.
+//
+// Y is consumed row by row, each row of n̄ elements being unpacked into
+// registers and accumulated into all m rows of X * Y, scaled by matching
+// column of X.
+template<size_t m, size_t n, size_t n̄, size_t D>
+inline matrix::matrix<m, n̄, D>
+mul_packed(const matrix::matrix<m, n, D>& X, packing::packed_t<n, n̄, D> Y)
+{
+  static_assert(sizeof(zq::zq_t<D>) == sizeof(uint16_t), "Zq element must be backed by a 16 -bit word");
+
+  constexpr size_t blk_elems = packing::BLOCK_ELEMS;
+
+  const auto x_ptr = reinterpret_cast<const uint16_t*>(X.data());
+  std::array<uint16_t, m * n̄> acc{};
+
+  for (size_t k = 0; k < n; k++) {
+    std::array<zq::zq_t<D>, n̄> y{};
+
+    for (size_t b = 0; b < Y.BLOCKS_PER_ROW; b++) {
+      Y.unpack_block(k * Y.BLOCKS_PER_ROW + b, y.data() + b * blk_elems);
+    }
+
+    for (size_t i = 0; i < m; i++) {
+      const uint32_t x_ik = x_ptr[i * n + k];
+
+      for (size_t j = 0; j < n̄; j++) {
+        acc[i * n̄ + j] += static_cast<uint16_t>(x_ik * y[j].to_raw());
+      }
+    }
+  }
+
+  matrix::matrix<m, n̄, D> res{};
+  for (size_t i = 0; i < m * n̄; i++) {
+    res[i] = zq::zq_t<D>(acc[i]);
+  }
+
+  return res;
+}
+
+// Given matrix S' of dimension n̄ x n and `A_ROWS_PER_BLOCK` -many consecutive
+// rows of A, starting at row index k, this routine accumulates
+// S'[:, k + t] * A[k + t, :] ∀ t ∈ [0, A_ROWS_PER_BLOCK) into matrix B' of
+// dimension n̄ x n.
+template<size_t n, size_t n̄, size_t D>
+inline void
+s_mul_a_rows(const matrix::matrix<n̄, n, D>& S_prime, const size_t k, std::span<const zq::zq_t<D>, A_ROWS_PER_BLOCK * n> a_rows, matrix::matrix<n̄, n, D>& B_prime)
+{
+#if defined(__x86_64__)
+  if constexpr ((n̄ == 8) && (n % 16 == 0)) {
+    static_assert(sizeof(zq::zq_t<D>) == sizeof(uint16_t), "Zq element must be backed by a 16 -bit word");
+
+    const auto s_ptr = reinterpret_cast<const uint16_t*>(S_prime.data());
+    const auto a_ptr = reinterpret_cast<const uint16_t*>(a_rows.data());
+    const auto b_ptr = reinterpret_cast<uint16_t*>(B_prime.data());
+
+    switch (dispatch::active_tier()) {
+      case dispatch::tier_t::avx512bw:
+        matmul_avx512::s_mul_a_rows<n, A_ROWS_PER_BLOCK>(s_ptr, k, a_ptr, b_ptr);
+        return;
+      case dispatch::tier_t::avx2:
+        matmul_avx2::s_mul_a_rows<n, A_ROWS_PER_BLOCK>(s_ptr, k, a_ptr, b_ptr);
+        return;
+      default:
+        break;
+    }
+  }
+#endif
+
+  if constexpr (swar::PREFERRED && (n % swar::LANES == 0)) {
+    // Portable SWAR path : four consecutive elements of a row of B' are updated
+    // at once, accumulating products with all rows of A in this block, before
+    // reducing and adding them to B'.
+    for (size_t i = 0; i < n̄; i++) {
+      std::array<uint16_t, A_ROWS_PER_BLOCK> s{};
+      for (size_t t = 0; t < A_ROWS_PER_BLOCK; t++) {
+        s[t] = S_prime[{ i, k + t }].to_raw();
+      }
+
+      for (size_t j = 0; j < n; j += swar::LANES) {
+        swar::acc_t acc{};
+        for (size_t t = 0; t < A_ROWS_PER_BLOCK; t++) {
+          swar::mul_acc(acc, swar::load(a_rows.data() + t * n + j), s[t]);
+        }
+
+        auto b_ij = B_prime.data() + i * n + j;
+        swar::store(swar::add(swar::load(b_ij), swar::reduce(acc)), b_ij);
+      }
+    }
+  } else {
+    for (size_t t = 0; t < A_ROWS_PER_BLOCK; t++) {
+      auto a_row = a_rows.subspan(t * n, n);
+
+      for (size_t i = 0; i < n̄; i++) {
+        const auto s = S_prime[{ i, k + t }];
+
+        for (size_t j = 0; j < n; j++) {
+          B_prime[{ i, j }] += s * a_row[j];
+        }
+      }
+    }
+  }
+}
+
+// Given a source of rows of matrix A ( of dimension n x n ), matrix S' of
+// dimension n̄ x n, matrix E' of dimension n̄ x n and scratch space for a block
+// of rows of A, this routine can be used for computing B' = S' * A + E', over
+// Zq, in place, as required in step 7 of algorithm 13 and step 11 of algorithm
+// 14 of FrodoKEM specification. On input, `B_prime` holds E', which gets
+// overwritten by B'.
+//
+// Rather than walking A column-wise ( with a 2n -bytes stride ), as a generic
+// i/j/k loop would, a block of few rows of A is generated and
+// S'[:, k] * A[k, :] is immediately accumulated into all n̄ rows of B', for
+// each row k in that block, before the block is thrown away. Every access to
+// A and B' is sequential.
+template<size_t n, size_t n̄, size_t D, typename row_source_t>
+inline void
+s_mul_a_add_e(const row_source_t& src, const matrix::matrix<n̄, n, D>& S_prime, matrix::matrix<n̄, n, D>& B_prime, std::span<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> scratch)
+  requires(gen_a::row_source<row_source_t, n, D> && (n % A_ROWS_PER_BLOCK == 0))
+{
+  for (size_t k = 0; k < n; k += A_ROWS_PER_BLOCK) {
+    const auto a_rows = src.template rows<A_ROWS_PER_BLOCK>(k, scratch);
+
+    s_mul_a_rows<n, n̄, D>(S_prime, k, a_rows, B_prime);
+  }
+}
+
+// Given a source of rows of matrix A ( of dimension n x n ), matrix S' of
+// dimension n̄ x n and matrix E' of dimension n̄ x n, this routine computes
+// B' = S' * A + E', over Zq, returning it, see above.
+template<size_t n, size_t n̄, size_t D, typename row_source_t>
+inline matrix::matrix<n̄, n, D>
+s_mul_a_add_e(const row_source_t& src, const matrix::matrix<n̄, n, D>& S_prime, const matrix::matrix<n̄, n, D>& E_prime)
+  requires(gen_a::row_source<row_source_t, n, D> && (n % A_ROWS_PER_BLOCK == 0))
+{
+  matrix::matrix<n̄, n, D> B_prime = E_prime;
+  std::array<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> scratch{};
+
+  s_mul_a_add_e<n, n̄, D>(src, S_prime, B_prime, scratch);
+  return B_prime;
+}
+
+// Given a source of rows of matrix A ( of dimension n x n ) and a batch of k
+// matrices S'_r, each of dimension n̄ x n, stacked into a (k·n̄) x n operand,
+// this routine computes B'_r = S'_r * A + E'_r ∀ r ∈ [0, k), over Zq. On
+// input, `B_primes` holds E'_r, which get overwritten by B'_r. Both spans must
+// be of same length.
+//
+// Each block of rows of A is generated ( or read ) only once and, while it's
+// still hot in L1 cache, accumulated into B' of all k matrices, so the whole
+// batch makes a single pass over A.
+template<size_t n, size_t n̄, size_t D, typename row_source_t>
+inline void
+s_mul_a_add_e_batch(const row_source_t& src, std::span<const matrix::matrix<n̄, n, D>> S_primes, std::span<matrix::matrix<n̄, n, D>> B_primes)
+  requires(gen_a::row_source<row_source_t, n, D> && (n % A_ROWS_PER_BLOCK == 0))
+{
+  assert(S_primes.size() == B_primes.size());
+
+  std::array<zq::zq_t<D>, A_ROWS_PER_BLOCK * n> scratch{};
+
+  for (size_t k = 0; k < n; k += A_ROWS_PER_BLOCK) {
+    const auto a_rows = src.template rows<A_ROWS_PER_BLOCK>(k, scratch);
+
+    for (size_t r = 0; r < S_primes.size(); r++) {
+      s_mul_a_rows<n, n̄, D>(S_primes[r], k, a_rows, B_primes[r]);
+    }
+  }
+}
+
+// Given a seed of length len_seed_A -bits ( for generating matrix A of
+// dimension n x n ), matrix S' of dimension n̄ x n and matrix E' of dimension
+// n̄ x n, this routine can be used for computing B' = S' * A + E', over Zq.
+template<size_t n, size_t n̄, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline matrix::matrix<n̄, n, D>
+s_mul_a_add_e(std::span<const uint8_t, (len_seed_A + 7) / 8> seed, const matrix::matrix<n̄, n, D>& S_prime, const matrix::matrix<n̄, n, D>& E_prime)
+  requires(n % A_ROWS_PER_BLOCK == 0)
+{
+  const gen_a::row_generator_t<n, len_seed_A, D, prg> rowgen(seed);
+  return s_mul_a_add_e<n, n̄, D>(rowgen, S_prime, E_prime);
+}
+
+}
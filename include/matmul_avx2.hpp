@@ -0,0 +1,118 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX2 kernels for multiplication with pseudorandom matrix A
+//
+// All arithmetic is over Zq s.t. q = 2^D and D <= 16, so each element is
+// kept in an unsigned 16 -bit lane and reduction modulo q comes for free with
+// wrapping `vpmullw`/ `vpaddw`. Results are bit-identical to the scalar
+// implementation, because that too computes everything modulo 2^16 and masks
+// by q only while packing.
+//
+// Kernels are compiled for AVX2, irrespective of flags used for compiling rest
+// of the library, so they must only be invoked when `dispatch::active_tier()`
+// says the CPU supports AVX2.
+namespace matmul_avx2 {
+
+// Given eight 256 -bit vectors of 16 -bit lanes, this routine sums up lanes of
+// each of them, modulo 2^16, returning eight sums, in order, in a single 128 -bit
+// vector. Three rounds of `vphaddw` sum lanes of each 128 -bit half, which are
+// then folded.
+__attribute__((target("avx2"))) inline __m128i
+hsum8(const __m256i* const v)
+{
+  const __m256i h01 = _mm256_hadd_epi16(v[0], v[1]);
+  const __m256i h23 = _mm256_hadd_epi16(v[2], v[3]);
+  const __m256i h45 = _mm256_hadd_epi16(v[4], v[5]);
+  const __m256i h67 = _mm256_hadd_epi16(v[6], v[7]);
+
+  const __m256i g0 = _mm256_hadd_epi16(h01, h23);
+  const __m256i g1 = _mm256_hadd_epi16(h45, h67);
+  const __m256i f = _mm256_hadd_epi16(g0, g1);
+
+  return _mm_add_epi16(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+}
+
+// Given `rows` -many rows of X ( each of length n ), matrix S^T of dimension
+// 8 x n and matching `rows` -many rows of E ( each of length 8 ), this routine
+// computes corresponding rows of X * S + E, never materializing S.
+//
+// Element (i, j) of X * S is the dot product of row i of X and row j of S^T,
+// both of which are contiguous. So 16 consecutive elements of a row of X are
+// multiplied with matching elements of all 8 rows of S^T, accumulating into 8
+// vectors, which are summed up horizontally only once per row of X.
+template<size_t n, size_t rows>
+__attribute__((target("avx2"))) inline void
+mul_st_add_e(const uint16_t* const __restrict x, const uint16_t* const __restrict st, const uint16_t* const __restrict e, uint16_t* const __restrict b)
+  requires((n % 16 == 0) && (rows > 0))
+{
+  constexpr size_t n̄ = 8;
+
+  for (size_t r = 0; r < rows; r++) {
+    __m256i acc[n̄];
+    for (size_t j = 0; j < n̄; j++) {
+      acc[j] = _mm256_setzero_si256();
+    }
+
+    for (size_t k = 0; k < n; k += 16) {
+      const __m256i x_k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + r * n + k));
+
+      for (size_t j = 0; j < n̄; j++) {
+        const __m256i st_k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(st + j * n + k));
+        acc[j] = _mm256_add_epi16(acc[j], _mm256_mullo_epi16(x_k, st_k));
+      }
+    }
+
+    const __m128i e_r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e + r * n̄));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(b + r * n̄), _mm_add_epi16(hsum8(acc), e_r));
+  }
+}
+
+// Given matrix S' of dimension 8 x n, `rows` -many consecutive rows of A
+// ( each of length n ), starting at row index k, this routine accumulates
+// S'[:, k + t] * A[k + t, :] ∀ t ∈ [0, rows) into matrix B' of dimension 8 x n.
+//
+// This is a streaming axpy : each S' coefficient is broadcasted over all 16
+// lanes of a 256 -bit vector and multiplied with 16 consecutive elements of a
+// row of A, accumulating into 16 consecutive elements of the corresponding row
+// of B'. Each 16 -lane chunk of B' is loaded and stored once per block of A
+// rows, while broadcasted S' coefficients are computed once per block.
+template<size_t n, size_t rows>
+__attribute__((target("avx2"))) inline void
+s_mul_a_rows(const uint16_t* const __restrict s, const size_t k, const uint16_t* const __restrict a, uint16_t* const __restrict b)
+  requires((n % 16 == 0) && (rows > 0) && (rows <= 8))
+{
+  constexpr size_t n̄ = 8;
+
+  __m256i s_bcast[n̄ * rows];
+  for (size_t i = 0; i < n̄; i++) {
+    for (size_t t = 0; t < rows; t++) {
+      s_bcast[i * rows + t] = _mm256_set1_epi16(static_cast<int16_t>(s[i * n + k + t]));
+    }
+  }
+
+  for (size_t j = 0; j < n; j += 16) {
+    __m256i a_j[rows];
+    for (size_t t = 0; t < rows; t++) {
+      a_j[t] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + t * n + j));
+    }
+
+    for (size_t i = 0; i < n̄; i++) {
+      __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * n + j));
+
+      for (size_t t = 0; t < rows; t++) {
+        acc = _mm256_add_epi16(acc, _mm256_mullo_epi16(s_bcast[i * rows + t], a_j[t]));
+      }
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i * n + j), acc);
+    }
+  }
+}
+
+}
+
+#endif
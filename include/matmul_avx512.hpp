@@ -0,0 +1,119 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include "matmul_avx2.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX-512BW kernels for multiplication with pseudorandom matrix A
+//
+// Same algorithms as AVX2 kernels, living in `matmul_avx2.hpp`, but operating
+// on 512 -bit vectors i.e. 32 lanes of unsigned 16 -bit integers. Wrapping
+// `vpmullw`/ `vpaddw` keep the results bit-identical to the scalar
+// implementation.
+//
+// Kernels are compiled for AVX-512BW, irrespective of flags used for compiling
+// rest of the library, so they must only be invoked when
+// `dispatch::active_tier()` says the CPU supports AVX-512BW.
+namespace matmul_avx512 {
+
+// Given `rows` -many rows of X ( each of length n ), matrix S^T of dimension
+// 8 x n and matching `rows` -many rows of E ( each of length 8 ), this routine
+// computes corresponding rows of X * S + E, never materializing S.
+//
+// Dot products of rows of X and S^T, 32 lanes at a time. Two rows of X are
+// processed together, sharing each load of S^T, with 16 accumulators. As n
+// isn't necessarily a multiple of 32 ( e.g. n = 976 ), the last chunk is loaded
+// with zero-masking. Each accumulator is folded to 256 -bit and summed up
+// horizontally, using the AVX2 routine.
+template<size_t n, size_t rows>
+__attribute__((target("avx512f,avx512bw"))) inline void
+mul_st_add_e(const uint16_t* const __restrict x, const uint16_t* const __restrict st, const uint16_t* const __restrict e, uint16_t* const __restrict b)
+  requires((n % 16 == 0) && (rows % 2 == 0) && (rows > 0))
+{
+  constexpr size_t n̄ = 8;
+
+  for (size_t r = 0; r < rows; r += 2) {
+    __m512i acc0[n̄];
+    __m512i acc1[n̄];
+    for (size_t j = 0; j < n̄; j++) {
+      acc0[j] = _mm512_setzero_si512();
+      acc1[j] = _mm512_setzero_si512();
+    }
+
+    for (size_t k = 0; k < n; k += 32) {
+      const __mmask32 mask = (n - k >= 32) ? ~__mmask32{ 0 } : static_cast<__mmask32>((1u << (n - k)) - 1u);
+
+      const __m512i x0_k = _mm512_maskz_loadu_epi16(mask, x + (r + 0) * n + k);
+      const __m512i x1_k = _mm512_maskz_loadu_epi16(mask, x + (r + 1) * n + k);
+
+      for (size_t j = 0; j < n̄; j++) {
+        const __m512i st_k = _mm512_maskz_loadu_epi16(mask, st + j * n + k);
+
+        acc0[j] = _mm512_add_epi16(acc0[j], _mm512_mullo_epi16(x0_k, st_k));
+        acc1[j] = _mm512_add_epi16(acc1[j], _mm512_mullo_epi16(x1_k, st_k));
+      }
+    }
+
+    __m256i sum0[n̄];
+    __m256i sum1[n̄];
+
+    // Zero-masked extracts, as unmasked ones trip -Wuninitialized on some GCC versions.
+    for (size_t j = 0; j < n̄; j++) {
+      sum0[j] = _mm256_add_epi16(_mm512_maskz_extracti64x4_epi64(0xff, acc0[j], 0), _mm512_maskz_extracti64x4_epi64(0xff, acc0[j], 1));
+      sum1[j] = _mm256_add_epi16(_mm512_maskz_extracti64x4_epi64(0xff, acc1[j], 0), _mm512_maskz_extracti64x4_epi64(0xff, acc1[j], 1));
+    }
+
+    const __m128i e0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e + (r + 0) * n̄));
+    const __m128i e1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e + (r + 1) * n̄));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(b + (r + 0) * n̄), _mm_add_epi16(matmul_avx2::hsum8(sum0), e0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(b + (r + 1) * n̄), _mm_add_epi16(matmul_avx2::hsum8(sum1), e1));
+  }
+}
+
+// Given matrix S' of dimension 8 x n, `rows` -many consecutive rows of A
+// ( each of length n ), starting at row index k, this routine accumulates
+// S'[:, k + t] * A[k + t, :] ∀ t ∈ [0, rows) into matrix B' of dimension 8 x n.
+//
+// Streaming axpy over 32 lanes at a time. As n isn't necessarily a multiple of
+// 32 ( e.g. n = 976 ), the last chunk of each row is processed with masked
+// loads and stores.
+template<size_t n, size_t rows>
+__attribute__((target("avx512f,avx512bw"))) inline void
+s_mul_a_rows(const uint16_t* const __restrict s, const size_t k, const uint16_t* const __restrict a, uint16_t* const __restrict b)
+  requires((n % 16 == 0) && (rows > 0) && (rows <= 8))
+{
+  constexpr size_t n̄ = 8;
+
+  __m512i s_bcast[n̄ * rows];
+  for (size_t i = 0; i < n̄; i++) {
+    for (size_t t = 0; t < rows; t++) {
+      s_bcast[i * rows + t] = _mm512_set1_epi16(static_cast<int16_t>(s[i * n + k + t]));
+    }
+  }
+
+  for (size_t j = 0; j < n; j += 32) {
+    const __mmask32 mask = (n - j >= 32) ? ~__mmask32{ 0 } : static_cast<__mmask32>((1u << (n - j)) - 1u);
+
+    __m512i a_j[rows];
+    for (size_t t = 0; t < rows; t++) {
+      a_j[t] = _mm512_maskz_loadu_epi16(mask, a + t * n + j);
+    }
+
+    for (size_t i = 0; i < n̄; i++) {
+      __m512i acc = _mm512_maskz_loadu_epi16(mask, b + i * n + j);
+
+      for (size_t t = 0; t < rows; t++) {
+        acc = _mm512_add_epi16(acc, _mm512_mullo_epi16(s_bcast[i * rows + t], a_j[t]));
+      }
+
+      _mm512_mask_storeu_epi16(b + i * n + j, mask, acc);
+    }
+  }
+}
+
+}
+
+#endif
@@ -1,16 +1,126 @@
 #pragma once
+#include "gen_a.hpp"
 #include "prng.hpp"
 #include "subtle.hpp"
+#include "swar.hpp"
 #include "zq.hpp"
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory_resource>
 #include <span>
 #include <type_traits>
+#include <utility>
 
 // Operations on Matrices over Zq
 namespace matrix {
 
+template<size_t rows, size_t cols, size_t D>
+struct matrix;
+
+template<size_t rows, size_t cols, size_t D>
+struct heap_matrix;
+
+// Dimension and modulus of a matrix type, i.e. rows x cols over Zq | q = 2^D.
+template<typename T>
+struct shape;
+
+template<size_t r, size_t c, size_t d>
+struct shape<matrix<r, c, d>>
+{
+  static constexpr size_t rows = r;
+  static constexpr size_t cols = c;
+  static constexpr size_t D = d;
+};
+
+template<size_t r, size_t c, size_t d>
+struct shape<heap_matrix<r, c, d>> : shape<matrix<r, c, d>>
+{
+};
+
+// Whether T is a matrix, holding its elements, instead of a lazily evaluated
+// expression computing them.
+template<typename T>
+inline constexpr bool is_matrix = false;
+
+template<size_t rows, size_t cols, size_t D>
+inline constexpr bool is_matrix<matrix<rows, cols, D>> = true;
+
+template<size_t rows, size_t cols, size_t D>
+inline constexpr bool is_matrix<heap_matrix<rows, cols, D>> = true;
+
+// A matrix of dimension rows x cols over Zq | q = 2^D, holding its elements in
+// contiguous, row-major storage, either inline ( `matrix` ) or on heap (
+// `heap_matrix` ). Routines filling a matrix in place accept either of them.
+template<typename M, size_t rows, size_t cols, size_t D>
+concept storage_of = is_matrix<M> && (shape<M>::rows == rows) && (shape<M>::cols == cols) && (shape<M>::D == D);
+
+// A matrix or a lazily evaluated matrix expression, which can compute any row
+// of the matrix it denotes, of type `result_t`, into a destination row.
+template<typename T>
+concept expression = requires(const std::remove_cvref_t<T>& e, const size_t i, zq::zq_t<shape<typename std::remove_cvref_t<T>::result_t>::D>* dst) {
+  typename std::remove_cvref_t<T>::result_t;
+  { e.eval_row(i, dst) };
+};
+
+// Whether matrix expressions L and R denote matrices of same dimension, over
+// same Zq, no matter where either of them would be stored.
+template<typename L, typename R>
+concept same_shape = (shape<typename std::remove_cvref_t<L>::result_t>::rows == shape<typename std::remove_cvref_t<R>::result_t>::rows) &&
+                     (shape<typename std::remove_cvref_t<L>::result_t>::cols == shape<typename std::remove_cvref_t<R>::result_t>::cols) &&
+                     (shape<typename std::remove_cvref_t<L>::result_t>::D == shape<typename std::remove_cvref_t<R>::result_t>::D);
+
+namespace internal {
+
+// Given row-major storage of `count` -many elements, this routine serializes
+// each of them as two little-endian bytes.
+template<size_t D, size_t count>
+inline constexpr void
+write_le_words(const zq::zq_t<D>* const elements, std::span<uint8_t, count * 2> bytes)
+{
+  for (size_t i = 0; i < count; i++) {
+    const size_t boff = i * 2;
+
+    const auto word = elements[i].to_raw();
+    bytes[boff + 0] = (word >> 0) & 0xff;
+    bytes[boff + 1] = (word >> 8) & 0xff;
+  }
+}
+
+// Given a byte array of length count * 2, this routine deserializes it into
+// `count` -many elements, interpreting each two consecutive bytes in
+// little-endian order.
+template<size_t D, size_t count>
+inline constexpr void
+read_le_words(std::span<const uint8_t, count * 2> bytes, zq::zq_t<D>* const elements)
+{
+  for (size_t i = 0; i < count; i++) {
+    const size_t boff = i * 2;
+
+    const uint16_t word = (static_cast<uint16_t>(bytes[boff + 1]) << 8) | (static_cast<uint16_t>(bytes[boff + 0]) << 0);
+    elements[i] = zq::zq_t<D>(word);
+  }
+}
+
+// Given two row-major storages of `count` -many elements, this routine tests
+// their equality in constant-time, returning truth value ( = 0xffffffff ) in
+// case they are equal or false value ( = 0x00 ).
+template<size_t D, size_t count>
+inline constexpr uint32_t
+ct_equal(const zq::zq_t<D>* const a, const zq::zq_t<D>* const b)
+{
+  uint32_t res = -1u;
+
+  for (size_t i = 0; i < count; i++) {
+    res &= subtle::ct_eq<uint16_t, uint32_t>(a[i].to_canonical(), b[i].to_canonical());
+  }
+
+  return res;
+}
+
+}
+
 // Wrapper type encapsulating ops on matrices s.t. elements ∈ Zq | q = 2^D
 template<size_t rows, size_t cols, size_t D>
 struct matrix
@@ -19,8 +129,24 @@ private:
   std::array<zq::zq_t<D>, rows * cols> elements{};
 
 public:
+  using result_t = matrix<rows, cols, D>;
+
   inline constexpr matrix() = default;
 
+  // Given a lazily evaluated matrix expression ( e.g. S' * B + E'' ), this
+  // routine evaluates it, one row at a time, straight into this matrix, so that
+  // no intermediate matrix is ever materialized.
+  //
+  // A `heap_matrix` of same dimension is copied in, same way.
+  template<typename E>
+  inline constexpr matrix(const E& expr)
+    requires(expression<E> && !std::is_same_v<E, matrix<rows, cols, D>> && same_shape<E, matrix<rows, cols, D>>)
+  {
+    for (size_t i = 0; i < rows; i++) {
+      expr.eval_row(i, this->data() + i * cols);
+    }
+  }
+
   // Given linear index of matrix, returns reference to requested element.
   inline constexpr zq::zq_t<D>& operator[](const size_t lin_idx) { return this->elements[lin_idx]; }
 
@@ -35,6 +161,12 @@ public:
   // element.
   inline constexpr const zq::zq_t<D>& operator[](std::pair<size_t, size_t> idx) const { return this->elements[idx.first * cols + idx.second]; }
 
+  // Returns pointer to underlying row-major storage of matrix elements.
+  inline constexpr zq::zq_t<D>* data() { return this->elements.data(); }
+
+  // Returns const pointer to underlying row-major storage of matrix elements.
+  inline constexpr const zq::zq_t<D>* data() const { return this->elements.data(); }
+
   // Returns # -of rows in matrix M
   inline constexpr size_t row_count() const { return rows; }
 
@@ -59,112 +191,261 @@ public:
     return res;
   }
 
+  // Given row index i, this routine copies i -th row of matrix into destination
+  // row, which is how a matrix takes part in a matrix expression.
+  inline constexpr void eval_row(const size_t i, zq::zq_t<D>* const dst) const
+  {
+    std::copy_n(this->elements.begin() + i * cols, cols, dst);
+  }
+
+  // Given two matrices A, B of same dimension, this routine can be used for
+  // testing equality of A and B i.e. only returns true if A == B.
+  inline constexpr bool operator==(const matrix<rows, cols, D>& rhs) const { return std::ranges::equal(this->elements, rhs.elements); }
+
   // Given two matrices A, B of same dimension, this routine can be used for
-  // performing matrix addition over Zq, returning a matrix of same dimension.
-  inline constexpr matrix<rows, cols, D> operator+(const matrix<rows, cols, D>& rhs) const
+  // constant-time equality test between A and B s.t. it returns truth value ( =
+  // 0xffffffff ) in case A == B or it returns false value ( = 0x00 ).
+  inline constexpr uint32_t ct_equal(const matrix<rows, cols, D>& rhs) const
   {
-    matrix<rows, cols, D> res{};
+    return internal::ct_equal<D, rows * cols>(this->data(), rhs.data());
+  }
 
-    for (size_t i = 0; i < res.element_count(); i++) {
-      res[i] = (*this)[i] + rhs[i];
-    }
+  // Given a seed of length len_seed_A -bits, this routine can be used for
+  // deterministically generating a pseudorandom matrix of dimension n x n,
+  // using SHAKE128 XOF or AES128, following algorithm described in section 7.6
+  // of FrodoKEM specification.
+  template<size_t len_seed_A, gen_a::prg_t prg = gen_a::prg_t::shake128>
+  inline static constexpr matrix<rows, cols, D> generate(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
+    requires(rows == cols)
+  {
+    matrix<rows, cols, D> mat{};
+    gen_a::row_generator_t<cols, len_seed_A, D, prg>(seed).template generate<rows>(0, mat.elements);
 
-    return res;
+    return mat;
   }
 
-  // Given two matrices A, B of same dimension, this routine can be used for
-  // subtracting B from A, resulting into another matrix C of same dimension.
-  inline constexpr matrix<rows, cols, D> operator-(const matrix<rows, cols, D>& rhs) const
+  // Computes a random matrix, while reading pseudo random bytes from PRNG.
+  inline static constexpr matrix<rows, cols, D> random(prng::prng_t& prng)
   {
-    matrix<rows, cols, D> res{};
+    matrix<rows, cols, D> mat{};
 
-    for (size_t i = 0; i < res.element_count(); i++) {
-      res[i] = (*this)[i] - rhs[i];
+    for (size_t i = 0; i < mat.element_count(); i++) {
+      mat[i] = zq::zq_t<D>::random_value(prng);
     }
 
+    return mat;
+  }
+
+  // Given a matrix M of dimension m x n, this routine can be used for
+  // serializing each of its elements as two little-endian bytes and
+  // concatenating them in order to compute a byte array of length m * n * 2.
+  inline constexpr void write_as_le_bytes(std::span<uint8_t, rows * cols * 2> bytes) const
+  {
+    internal::write_le_words<D, rows * cols>(this->data(), bytes);
+  }
+
+  // Given a byte array of length m * n * 2, this routine can be used for
+  // deserializing it as a matrix of dimension m x n s.t. each matrix element is
+  // computed by interpreting two consecutive bytes in little-endian order.
+  inline static matrix<rows, cols, D> read_from_le_bytes(std::span<const uint8_t, rows * cols * 2> bytes)
+  {
+    matrix<rows, cols, D> res{};
+    res.read_le_bytes(bytes);
+
     return res;
   }
 
-  // Given two matrices A ( of dimension rows x cols ) and B ( of dimension
-  // rhs_rows x rhs_cols ) s.t. cols == rhs_rows, this routine can be used for
-  // multiplying them over Zq, resulting into another matrix (C) of dimension
-  // rows x rhs_cols.
-  template<size_t rhs_rows, size_t rhs_cols>
-  inline constexpr matrix<rows, rhs_cols, D> operator*(const matrix<rhs_rows, rhs_cols, D>& rhs) const
-    requires(cols == rhs_rows)
+  // Given a byte array of length m * n * 2, this routine deserializes it into
+  // this matrix, in place, see `read_from_le_bytes`.
+  inline void read_le_bytes(std::span<const uint8_t, rows * cols * 2> bytes) { internal::read_le_words<D, rows * cols>(bytes, this->data()); }
+};
+
+// Tag selecting construction of a `heap_matrix`, without initializing its
+// elements, for producers which overwrite every element right away.
+struct uninitialized_t
+{
+  explicit uninitialized_t() = default;
+};
+
+inline constexpr uninitialized_t uninitialized{};
+
+// Alignment of storage of each `heap_matrix`, in bytes, matching cache line
+// size and widest SIMD register.
+constexpr size_t HEAP_ALIGNMENT = 64;
+
+// Matrix of dimension rows x cols over Zq | q = 2^D, same as `matrix`, but its
+// elements live in 64 -bytes aligned heap storage, allocated from a
+// `std::pmr::memory_resource` ( default resource, unless one is supplied ).
+//
+// Moving a heap matrix only moves ownership of storage, so it's O(1), no matter
+// its dimension, while copying one allocates and copies elements. A moved-from
+// heap matrix holds no storage and can only be assigned to or destroyed.
+//
+// Default construction zero-fills storage, same as `matrix`, while
+// `uninitialized` construction skips that memory pass, leaving elements
+// indeterminate, until they are written.
+template<size_t rows, size_t cols, size_t D>
+struct heap_matrix
+{
+private:
+  static constexpr size_t byte_len = rows * cols * sizeof(zq::zq_t<D>);
+
+  zq::zq_t<D>* elements = nullptr;
+  std::pmr::memory_resource* res = nullptr;
+
+  // Returns storage of this matrix to its memory resource, if it holds any.
+  inline void release()
   {
-    matrix<rows, rhs_cols, D> res{};
+    if (this->elements != nullptr) {
+      this->res->deallocate(this->elements, byte_len, HEAP_ALIGNMENT);
+      this->elements = nullptr;
+    }
+  }
 
-    for (size_t i = 0; i < rows; i++) {
-      for (size_t j = 0; j < rhs_cols; j++) {
-        zq::zq_t<D> tmp(0);
+public:
+  using result_t = heap_matrix<rows, cols, D>;
+
+  // Allocates storage from given memory resource, leaving elements
+  // uninitialized. zq_t is trivially copyable and destructible, so elements
+  // come to life as they are written.
+  inline heap_matrix(uninitialized_t, std::pmr::memory_resource* const res = std::pmr::get_default_resource())
+    : elements(static_cast<zq::zq_t<D>*>(res->allocate(byte_len, HEAP_ALIGNMENT)))
+    , res(res)
+  {
+  }
 
-        for (size_t k = 0; k < cols; k++) {
-          tmp += (*this)[{ i, k }] * rhs[{ k, j }];
-        }
+  // Allocates storage from given memory resource, with all elements set to 0.
+  inline explicit heap_matrix(std::pmr::memory_resource* const res = std::pmr::get_default_resource())
+    : heap_matrix(uninitialized, res)
+  {
+    std::fill_n(this->elements, rows * cols, zq::zq_t<D>());
+  }
 
-        res[{ i, j }] = tmp;
-      }
+  // Given a matrix expression ( e.g. S' * B + E'' ) or a `matrix`, of same
+  // dimension, this routine evaluates it, one row at a time, straight into
+  // newly allocated storage, which is never zero-filled.
+  template<typename E>
+  inline heap_matrix(const E& expr, std::pmr::memory_resource* const res = std::pmr::get_default_resource())
+    requires(expression<E> && !std::is_same_v<E, heap_matrix<rows, cols, D>> && same_shape<E, heap_matrix<rows, cols, D>>)
+    : heap_matrix(uninitialized, res)
+  {
+    for (size_t i = 0; i < rows; i++) {
+      expr.eval_row(i, this->elements + i * cols);
     }
+  }
 
-    return res;
+  // Copies elements into storage allocated from given memory resource, which
+  // is the default one, unless specified, following `std::pmr` containers.
+  inline heap_matrix(const heap_matrix& other, std::pmr::memory_resource* const res = std::pmr::get_default_resource())
+    : heap_matrix(uninitialized, res)
+  {
+    std::copy_n(other.elements, rows * cols, this->elements);
   }
 
-  // Given two matrices A, B of same dimension, this routine can be used for
-  // testing equality of A and B i.e. only returns true if A == B.
-  inline constexpr bool operator==(const matrix<rows, cols, D>& rhs) const { return std::ranges::equal(this->elements, rhs.elements); }
+  // Takes over storage of other matrix, along with its memory resource.
+  inline heap_matrix(heap_matrix&& other) noexcept
+    : elements(std::exchange(other.elements, nullptr))
+    , res(other.res)
+  {
+  }
 
-  // Given two matrices A, B of same dimension, this routine can be used for
-  // constant-time equality test between A and B s.t. it returns truth value ( =
-  // 0xffffffff ) in case A == B or it returns false value ( = 0x00 ).
-  inline constexpr uint32_t ct_equal(const matrix<rows, cols, D>& rhs) const
+  // Copies elements of other matrix, reusing storage of this one, if it holds
+  // any.
+  inline heap_matrix& operator=(const heap_matrix& other)
   {
-    uint32_t res = -1u;
+    if (this != &other) {
+      if (this->elements == nullptr) {
+        this->elements = static_cast<zq::zq_t<D>*>(this->res->allocate(byte_len, HEAP_ALIGNMENT));
+      }
 
-    for (size_t i = 0; i < this->element_count(); i++) {
-      res &= subtle::ct_eq<uint16_t, uint32_t>(this->elements[i].to_canonical(), rhs.elements[i].to_canonical());
+      std::copy_n(other.elements, rows * cols, this->elements);
     }
 
-    return res;
+    return *this;
   }
 
-  // Given a seed of length len_seed_A -bits, this routine can be used for
-  // deterministically generating a pseudorandom matrix of dimension n x n,
-  // using SHAKE128 XOF, following algorithm described in section 7.6.2 of
-  // FrodoKEM specification.
-  template<size_t len_seed_A>
-  inline static constexpr matrix<rows, cols, D> generate(std::span<const uint8_t, (len_seed_A + 7) / 8> seed)
-    requires(rows == cols)
+  // Swaps storage with other matrix, when both of them allocate from same
+  // memory resource, otherwise copies its elements.
+  inline heap_matrix& operator=(heap_matrix&& other)
   {
-    constexpr size_t row_byte_len = 2 * cols;
+    if (this != &other) {
+      if ((this->res == other.res) || (*this->res == *other.res)) {
+        std::swap(this->elements, other.elements);
+      } else {
+        *this = static_cast<const heap_matrix&>(other);
+      }
+    }
 
-    std::array<uint8_t, 2 + seed.size()> buf{};
-    std::memcpy(buf.data() + 2, seed.data(), seed.size());
+    return *this;
+  }
 
-    matrix<rows, cols, D> mat{};
-    auto mat_ptr = reinterpret_cast<uint8_t*>(mat.elements.data());
+  inline ~heap_matrix() { this->release(); }
 
-    for (size_t i = 0; i < rows; i++) {
-      const uint16_t ridx = static_cast<uint16_t>(i);
-      const size_t row_byte_off = i * row_byte_len;
+  // Returns memory resource, storage of this matrix is allocated from.
+  inline std::pmr::memory_resource* resource() const { return this->res; }
 
-      buf[0] = (ridx >> 0) & 0xff;
-      buf[1] = (ridx >> 8) & 0xff;
+  // Given linear index of matrix, returns reference to requested element.
+  inline zq::zq_t<D>& operator[](const size_t lin_idx) { return this->elements[lin_idx]; }
 
-      shake128::shake128_t hasher{};
+  // Given linear index of matrix, returns const reference to requested element.
+  inline const zq::zq_t<D>& operator[](const size_t lin_idx) const { return this->elements[lin_idx]; }
 
-      hasher.absorb(buf);
-      hasher.finalize();
-      hasher.squeeze(std::span(mat_ptr + row_byte_off, row_byte_len));
-    }
+  // Given row and column index of matrix, returns reference to requested
+  // element.
+  inline zq::zq_t<D>& operator[](std::pair<size_t, size_t> idx) { return this->elements[idx.first * cols + idx.second]; }
+
+  // Given row and column index of matrix, returns const reference to requested
+  // element.
+  inline const zq::zq_t<D>& operator[](std::pair<size_t, size_t> idx) const { return this->elements[idx.first * cols + idx.second]; }
+
+  // Returns pointer to underlying row-major, 64 -bytes aligned storage of
+  // matrix elements.
+  inline zq::zq_t<D>* data() { return this->elements; }
+
+  // Returns const pointer to underlying row-major, 64 -bytes aligned storage of
+  // matrix elements.
+  inline const zq::zq_t<D>* data() const { return this->elements; }
+
+  // Returns # -of rows in matrix M
+  inline constexpr size_t row_count() const { return rows; }
+
+  // Returns # -of cols in matrix M
+  inline constexpr size_t col_count() const { return cols; }
+
+  // Returns # -of elements in matrix M
+  inline constexpr size_t element_count() const { return rows * cols; }
+
+  // Given row index i, this routine copies i -th row of matrix into destination
+  // row, which is how a matrix takes part in a matrix expression.
+  inline void eval_row(const size_t i, zq::zq_t<D>* const dst) const { std::copy_n(this->elements + i * cols, cols, dst); }
+
+  // Given two matrices A, B of same dimension, this routine can be used for
+  // testing equality of A and B i.e. only returns true if A == B.
+  inline bool operator==(const heap_matrix<rows, cols, D>& rhs) const { return std::equal(this->elements, this->elements + rows * cols, rhs.elements); }
+
+  // Given two matrices A, B of same dimension, this routine can be used for
+  // constant-time equality test between A and B, see `matrix::ct_equal`.
+  inline uint32_t ct_equal(const heap_matrix<rows, cols, D>& rhs) const { return internal::ct_equal<D, rows * cols>(this->elements, rhs.elements); }
+
+  // Given a seed of length len_seed_A -bits, this routine deterministically
+  // generates pseudorandom matrix A of dimension n x n, see `matrix::generate`.
+  // Rows are generated straight into uninitialized storage, so matrix A is
+  // written exactly once.
+  template<size_t len_seed_A, gen_a::prg_t prg = gen_a::prg_t::shake128>
+  inline static heap_matrix<rows, cols, D> generate(std::span<const uint8_t, (len_seed_A + 7) / 8> seed,
+                                                    std::pmr::memory_resource* const res = std::pmr::get_default_resource())
+    requires(rows == cols)
+  {
+    heap_matrix<rows, cols, D> mat(uninitialized, res);
+    gen_a::row_generator_t<cols, len_seed_A, D, prg>(seed).template generate<rows>(0, std::span<zq::zq_t<D>, rows * cols>(mat.elements, rows * cols));
 
     return mat;
   }
 
   // Computes a random matrix, while reading pseudo random bytes from PRNG.
-  inline static constexpr matrix<rows, cols, D> random(prng::prng_t& prng)
+  inline static heap_matrix<rows, cols, D> random(prng::prng_t& prng, std::pmr::memory_resource* const res = std::pmr::get_default_resource())
   {
-    matrix<rows, cols, D> mat{};
+    heap_matrix<rows, cols, D> mat(uninitialized, res);
 
     for (size_t i = 0; i < mat.element_count(); i++) {
       mat[i] = zq::zq_t<D>::random_value(prng);
@@ -173,41 +454,184 @@ public:
     return mat;
   }
 
-  // Given a matrix M of dimension m x n, this routine can be used for
-  // serializing each of its elements as two little-endian bytes and
-  // concatenating them in order to compute a byte array of length m * n * 2.
-  inline constexpr void write_as_le_bytes(std::span<uint8_t, rows * cols * 2> bytes) const
+  // Serializes matrix as a byte array of length m * n * 2, see
+  // `matrix::write_as_le_bytes`.
+  inline void write_as_le_bytes(std::span<uint8_t, rows * cols * 2> bytes) const { internal::write_le_words<D, rows * cols>(this->elements, bytes); }
+
+  // Given a byte array of length m * n * 2, this routine deserializes it as a
+  // matrix of dimension m x n, see `matrix::read_from_le_bytes`.
+  inline static heap_matrix<rows, cols, D> read_from_le_bytes(std::span<const uint8_t, rows * cols * 2> bytes,
+                                                              std::pmr::memory_resource* const res = std::pmr::get_default_resource())
   {
-    for (size_t i = 0; i < this->element_count(); i++) {
-      const size_t boff = i * 2;
+    heap_matrix<rows, cols, D> mat(uninitialized, res);
+    mat.read_le_bytes(bytes);
+
+    return mat;
+  }
+
+  // Given a byte array of length m * n * 2, this routine deserializes it into
+  // this matrix, in place.
+  inline void read_le_bytes(std::span<const uint8_t, rows * cols * 2> bytes) { internal::read_le_words<D, rows * cols>(bytes, this->elements); }
+};
 
-      const auto word = this->elements[i].to_raw();
-      bytes[boff + 0] = (word >> 0) & 0xff;
-      bytes[boff + 1] = (word >> 8) & 0xff;
+namespace internal {
+
+// How an operand is held by a matrix expression. Matrices, passed as lvalues,
+// are held by reference, while temporaries are moved into the expression, so
+// that an expression never outlives its operands, even when it's bound to an
+// `auto` variable.
+template<typename T>
+using operand_t = std::conditional_t<std::is_lvalue_reference_v<T> && is_matrix<std::remove_cvref_t<T>>, const std::remove_cvref_t<T>&, std::remove_cvref_t<T>>;
+
+// How an operand of a matrix product is held. Elements of both operands of a
+// product are accessed in arbitrary order, so an operand, which is itself an
+// expression, is evaluated into a matrix, once, while matrices are held same
+// way as `operand_t` does.
+template<typename T>
+using product_operand_t = std::conditional_t<is_matrix<std::remove_cvref_t<T>>, operand_t<T>, typename std::remove_cvref_t<T>::result_t>;
+
+// Given destination row and another row, both of length cols, this routine
+// adds ( or subtracts, if `negate` is set ) latter into former, over Zq.
+template<size_t cols, size_t D, bool negate>
+inline constexpr void
+add_row(zq::zq_t<D>* const dst, const zq::zq_t<D>* const src)
+{
+  if constexpr (swar::PREFERRED && (cols % swar::LANES == 0)) {
+    for (size_t j = 0; j < cols; j += swar::LANES) {
+      const uint64_t a = swar::load(dst + j);
+      const uint64_t b = swar::load(src + j);
+
+      swar::store(negate ? swar::sub(a, b) : swar::add(a, b), dst + j);
+    }
+  } else {
+    for (size_t j = 0; j < cols; j++) {
+      dst[j] = negate ? dst[j] - src[j] : dst[j] + src[j];
     }
   }
+}
 
-  // Given a byte array of length m * n * 2, this routine can be used for
-  // deserializing it as a matrix of dimension m x n s.t. each matrix element is
-  // computed by interpreting two consecutive bytes in little-endian order.
-  inline static matrix<rows, cols, D> read_from_le_bytes(std::span<const uint8_t, rows * cols * 2> bytes)
+}
+
+// Lazily evaluated sum ( or difference, if `negate` is set ) of two matrix
+// expressions of same dimension.
+template<typename L, typename R, bool negate>
+struct sum_t
+{
+  using result_t = typename std::remove_cvref_t<L>::result_t;
+
+  L lhs;
+  R rhs;
+
+  // Given row index i, this routine computes i -th row of lhs ± rhs, straight
+  // into destination row. Only a row of rhs is ever materialized, if it's an
+  // expression itself.
+  inline constexpr void eval_row(const size_t i, zq::zq_t<shape<result_t>::D>* const dst) const
   {
-    constexpr size_t blen = bytes.size();
-    matrix<rows, cols, D> res{};
+    constexpr size_t cols = shape<result_t>::cols;
+    constexpr size_t D = shape<result_t>::D;
 
-    size_t boff = 0;
-    size_t moff = 0;
+    this->lhs.eval_row(i, dst);
 
-    while (boff < blen) {
-      const uint16_t word = (static_cast<uint16_t>(bytes[boff + 1]) << 8) | (static_cast<uint16_t>(bytes[boff + 0]) << 0);
-      res[moff] = zq::zq_t<D>(word);
+    if constexpr (is_matrix<std::remove_cvref_t<R>>) {
+      internal::add_row<cols, D, negate>(dst, this->rhs.data() + i * cols);
+    } else {
+      std::array<zq::zq_t<D>, cols> row;
 
-      boff += 2;
-      moff += 1;
+      this->rhs.eval_row(i, row.data());
+      internal::add_row<cols, D, negate>(dst, row.data());
     }
+  }
+};
 
-    return res;
+// Lazily evaluated product of two matrices A ( of dimension rows x cols ) and
+// B ( of dimension cols x rhs_cols ), over Zq.
+template<typename L, typename R>
+struct product_t
+{
+private:
+  using lhs_shape = shape<std::remove_cvref_t<L>>;
+  using rhs_shape = shape<std::remove_cvref_t<R>>;
+
+public:
+  using result_t = matrix<lhs_shape::rows, rhs_shape::cols, lhs_shape::D>;
+
+  L lhs;
+  R rhs;
+
+  // Given row index i, this routine computes i -th row of A * B, straight into
+  // destination row.
+  //
+  // When SWAR kernels are preferred for this target and rhs_cols is a multiple
+  // of 4, row i is computed as a linear combination of rows of B, four columns
+  // at a time, with products lazily accumulated over all k.
+  inline constexpr void eval_row(const size_t i, zq::zq_t<lhs_shape::D>* const dst) const
+  {
+    constexpr size_t cols = lhs_shape::cols;
+    constexpr size_t rhs_cols = rhs_shape::cols;
+
+    if constexpr (swar::PREFERRED && (rhs_cols % swar::LANES == 0) && (cols < (1ul << 16))) {
+      constexpr size_t words = rhs_cols / swar::LANES;
+      std::array<swar::acc_t, words> acc{};
+
+      for (size_t k = 0; k < cols; k++) {
+        const uint16_t a_ik = this->lhs[{ i, k }].to_raw();
+
+        for (size_t w = 0; w < words; w++) {
+          swar::mul_acc(acc[w], swar::load(this->rhs.data() + k * rhs_cols + w * swar::LANES), a_ik);
+        }
+      }
+
+      for (size_t w = 0; w < words; w++) {
+        swar::store(swar::reduce(acc[w]), dst + w * swar::LANES);
+      }
+    } else {
+      for (size_t j = 0; j < rhs_cols; j++) {
+        zq::zq_t<lhs_shape::D> tmp(0);
+
+        for (size_t k = 0; k < cols; k++) {
+          tmp += this->lhs[{ i, k }] * this->rhs[{ k, j }];
+        }
+
+        dst[j] = tmp;
+      }
+    }
   }
 };
 
+// Given two matrix expressions A, B of same dimension, this routine can be used
+// for performing matrix addition over Zq, returning a lazily evaluated
+// expression, which is computed only when assigned to a matrix.
+template<typename L, typename R>
+inline constexpr sum_t<internal::operand_t<L&&>, internal::operand_t<R&&>, false>
+operator+(L&& lhs, R&& rhs)
+  requires(expression<L> && expression<R> && same_shape<L, R>)
+{
+  return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
+// Given two matrix expressions A, B of same dimension, this routine can be used
+// for subtracting B from A, returning a lazily evaluated expression, which is
+// computed only when assigned to a matrix.
+template<typename L, typename R>
+inline constexpr sum_t<internal::operand_t<L&&>, internal::operand_t<R&&>, true>
+operator-(L&& lhs, R&& rhs)
+  requires(expression<L> && expression<R> && same_shape<L, R>)
+{
+  return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
+// Given two matrix expressions A ( of dimension rows x cols ) and B ( of
+// dimension rhs_rows x rhs_cols ) s.t. cols == rhs_rows, this routine can be
+// used for multiplying them over Zq, returning a lazily evaluated expression of
+// dimension rows x rhs_cols, which is computed only when assigned to a matrix.
+template<typename L, typename R>
+inline constexpr product_t<internal::product_operand_t<L&&>, internal::product_operand_t<R&&>>
+operator*(L&& lhs, R&& rhs)
+  requires(expression<L> && expression<R> &&
+           (shape<typename std::remove_cvref_t<L>::result_t>::cols == shape<typename std::remove_cvref_t<R>::result_t>::rows) &&
+           (shape<typename std::remove_cvref_t<L>::result_t>::D == shape<typename std::remove_cvref_t<R>::result_t>::D))
+{
+  return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
 }
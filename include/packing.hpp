@@ -1,23 +1,33 @@
 #pragma once
+#include "dispatch.hpp"
 #include "matrix.hpp"
+#include "packing_avx2.hpp"
+#include "packing_avx512.hpp"
 #include "params.hpp"
+#include "subtle.hpp"
 #include "utils.hpp"
 #include "zq.hpp"
+#include <array>
+#include <cstdint>
 #include <span>
+#include <type_traits>
 
 // Packing matrices modulo Q to bit strings and vice versa
 namespace packing {
 
-// Given a matrix of dimension n1 x n2 s.t. its elements ∈ Zq, this routine can
-// be used for packing the matrix into a bit string of length n1 x n2 x D -bits
-// s.t. Q = 1 << D, following algorithm described in section 7.3 of FrodoKEM
-// specification.
+// # -of matrix elements packed into ( or unpacked from ) each D -bytes block of
+// a bit string, for both D ∈ {15, 16}.
+constexpr size_t BLOCK_ELEMS = 8;
+
+// Given 8 consecutive elements ∈ Zq s.t. Q = 1 << D, this routine packs them
+// into D -bytes of a bit string, following algorithm described in section 7.3
+// of FrodoKEM specification.
 //
-// Note, we're dealing with byte oriented API, this routine packs matrix as a
-// byte array of length (n1 * n2 * D + 7) / 8.
-template<size_t n1, size_t n2, size_t D>
+// Packing works on such blocks independently, so that it can be fused with
+// other row-wise computation, see `kem::internal::encrypt_c`.
+template<size_t D>
 inline constexpr void
-pack(const matrix::matrix<n1, n2, D>& mat, std::span<uint8_t, (n1 * n2 * D + 7) / 8> arr)
+pack_block(const zq::zq_t<D>* const elems, std::span<uint8_t, D> arr)
   requires(frodo_params::check_d(D))
 {
   if constexpr (D == 15ul) {
@@ -36,83 +46,64 @@ pack(const matrix::matrix<n1, n2, D>& mat, std::span<uint8_t, (n1 * n2 * D + 7)
     constexpr uint16_t mask2 = mask3 >> 1;
     constexpr uint16_t mask1 = mask2 >> 1;
 
-    size_t moff = 0;
-    size_t boff = 0;
+    const auto v0 = elems[0].to_canonical();
+    const auto v1 = elems[1].to_canonical();
 
-    while (moff < mat.element_count()) {
-      const auto v0 = mat[moff + 0].to_canonical();
-      const auto v1 = mat[moff + 1].to_canonical();
+    arr[0] = (v0 >> 7) & mask8;
+    arr[1] = ((v0 & mask7) << 1) | ((v1 >> 14) & mask1);
 
-      arr[boff + 0] = (v0 >> 7) & mask8;
-      arr[boff + 1] = ((v0 & mask7) << 1) | ((v1 >> 14) & mask1);
+    const auto v2 = elems[2].to_canonical();
 
-      const auto v2 = mat[moff + 2].to_canonical();
+    arr[2] = (v1 & mask14) >> 6;
+    arr[3] = ((v1 & mask6) << 2) | ((v2 >> 13) & mask2);
 
-      arr[boff + 2] = (v1 & mask14) >> 6;
-      arr[boff + 3] = ((v1 & mask6) << 2) | ((v2 >> 13) & mask2);
+    const auto v3 = elems[3].to_canonical();
 
-      const auto v3 = mat[moff + 3].to_canonical();
+    arr[4] = (v2 & mask13) >> 5;
+    arr[5] = ((v2 & mask5) << 3) | ((v3 >> 12) & mask3);
 
-      arr[boff + 4] = (v2 & mask13) >> 5;
-      arr[boff + 5] = ((v2 & mask5) << 3) | ((v3 >> 12) & mask3);
+    const auto v4 = elems[4].to_canonical();
 
-      const auto v4 = mat[moff + 4].to_canonical();
+    arr[6] = (v3 & mask12) >> 4;
+    arr[7] = ((v3 & mask4) << 4) | ((v4 >> 11) & mask4);
 
-      arr[boff + 6] = (v3 & mask12) >> 4;
-      arr[boff + 7] = ((v3 & mask4) << 4) | ((v4 >> 11) & mask4);
+    const auto v5 = elems[5].to_canonical();
 
-      const auto v5 = mat[moff + 5].to_canonical();
+    arr[8] = (v4 & mask11) >> 3;
+    arr[9] = ((v4 & mask3) << 5) | ((v5 >> 10) & mask5);
 
-      arr[boff + 8] = (v4 & mask11) >> 3;
-      arr[boff + 9] = ((v4 & mask3) << 5) | ((v5 >> 10) & mask5);
+    const auto v6 = elems[6].to_canonical();
 
-      const auto v6 = mat[moff + 6].to_canonical();
+    arr[10] = (v5 & mask10) >> 2;
+    arr[11] = ((v5 & mask2) << 6) | ((v6 >> 9) & mask6);
 
-      arr[boff + 10] = (v5 & mask10) >> 2;
-      arr[boff + 11] = ((v5 & mask2) << 6) | ((v6 >> 9) & mask6);
+    const auto v7 = elems[7].to_canonical();
 
-      const auto v7 = mat[moff + 7].to_canonical();
-
-      arr[boff + 12] = (v6 & mask9) >> 1;
-      arr[boff + 13] = ((v6 & mask1) << 7) | ((v7 >> 8) & mask7);
-      arr[boff + 14] = v7 & mask8;
-
-      moff += 8;
-      boff += 15;
-    }
+    arr[12] = (v6 & mask9) >> 1;
+    arr[13] = ((v6 & mask1) << 7) | ((v7 >> 8) & mask7);
+    arr[14] = v7 & mask8;
   } else if constexpr (D == 16ul) {
     constexpr uint16_t mask = 0xff;
 
-    size_t moff = 0;
-    size_t boff = 0;
-
-    while (moff < mat.element_count()) {
-      const auto v = mat[moff].to_canonical();
-
-      arr[boff + 0] = (v >> 8) & mask;
-      arr[boff + 1] = (v >> 0) & mask;
+    for (size_t i = 0; i < BLOCK_ELEMS; i++) {
+      const auto v = elems[i].to_canonical();
 
-      moff += 1;
-      boff += 2;
+      arr[2 * i + 0] = (v >> 8) & mask;
+      arr[2 * i + 1] = (v >> 0) & mask;
     }
   }
 }
 
-// Given a bit string of length n1 x n2 x D -bits ( as a byte array of length
-// (n1 x n2 x D + 7) / 8 -bytes ), this routine can be used for unpacking
-// contiguous ( D -many ) bits into a n1 x n2 matrix over Zq s.t. q = 1 << D,
-// following algorithm described in section 7.3 of FrodoKEM specification.
-template<size_t n1, size_t n2, size_t D>
-inline constexpr matrix::matrix<n1, n2, D>
-unpack(std::span<const uint8_t, (n1 * n2 * D + 7) / 8> arr)
+// Given D -bytes of a bit string, this routine unpacks them into 8 consecutive
+// elements ∈ Zq s.t. Q = 1 << D. Inverse of `pack_block`.
+template<size_t D>
+inline constexpr void
+unpack_block(std::span<const uint8_t, D> arr, zq::zq_t<D>* const elems)
   requires(frodo_params::check_d(D))
 {
   // alias, so that I've to type lesser !
   using Zq = zq::zq_t<D>;
 
-  constexpr size_t byte_len = arr.size();
-  matrix::matrix<n1, n2, D> mat{};
-
   if constexpr (D == 15ul) {
     constexpr uint8_t mask7 = 0xff >> 1;
     constexpr uint8_t mask6 = mask7 >> 1;
@@ -122,35 +113,155 @@ unpack(std::span<const uint8_t, (n1 * n2 * D + 7) / 8> arr)
     constexpr uint8_t mask2 = mask3 >> 1;
     constexpr uint8_t mask1 = mask2 >> 1;
 
-    size_t boff = 0;
-    size_t moff = 0;
-
-    while (boff < byte_len) {
-      mat[moff + 0] = Zq((static_cast<uint16_t>(arr[boff + 0]) << 7) | static_cast<uint16_t>(arr[boff + 1] >> 1));
-      mat[moff + 1] = Zq((static_cast<uint16_t>(arr[boff + 1] & mask1) << 14) | (static_cast<uint16_t>(arr[boff + 2]) << 6) | static_cast<uint16_t>(arr[boff + 3] >> 2));
-      mat[moff + 2] = Zq((static_cast<uint16_t>(arr[boff + 3] & mask2) << 13) | (static_cast<uint16_t>(arr[boff + 4]) << 5) | static_cast<uint16_t>(arr[boff + 5] >> 3));
-      mat[moff + 3] = Zq((static_cast<uint16_t>(arr[boff + 5] & mask3) << 12) | (static_cast<uint16_t>(arr[boff + 6]) << 4) | static_cast<uint16_t>(arr[boff + 7] >> 4));
-      mat[moff + 4] = Zq((static_cast<uint16_t>(arr[boff + 7] & mask4) << 11) | (static_cast<uint16_t>(arr[boff + 8]) << 3) | static_cast<uint16_t>(arr[boff + 9] >> 5));
-      mat[moff + 5] = Zq((static_cast<uint16_t>(arr[boff + 9] & mask5) << 10) | (static_cast<uint16_t>(arr[boff + 10]) << 2) | static_cast<uint16_t>(arr[boff + 11] >> 6));
-      mat[moff + 6] = Zq((static_cast<uint16_t>(arr[boff + 11] & mask6) << 9) | (static_cast<uint16_t>(arr[boff + 12]) << 1) | static_cast<uint16_t>(arr[boff + 13] >> 7));
-      mat[moff + 7] = Zq((static_cast<uint16_t>(arr[boff + 13] & mask7) << 8) | static_cast<uint16_t>(arr[boff + 14]));
-
-      boff += 15;
-      moff += 8;
-    }
+    elems[0] = Zq((static_cast<uint16_t>(arr[0]) << 7) | static_cast<uint16_t>(arr[1] >> 1));
+    elems[1] = Zq((static_cast<uint16_t>(arr[1] & mask1) << 14) | (static_cast<uint16_t>(arr[2]) << 6) | static_cast<uint16_t>(arr[3] >> 2));
+    elems[2] = Zq((static_cast<uint16_t>(arr[3] & mask2) << 13) | (static_cast<uint16_t>(arr[4]) << 5) | static_cast<uint16_t>(arr[5] >> 3));
+    elems[3] = Zq((static_cast<uint16_t>(arr[5] & mask3) << 12) | (static_cast<uint16_t>(arr[6]) << 4) | static_cast<uint16_t>(arr[7] >> 4));
+    elems[4] = Zq((static_cast<uint16_t>(arr[7] & mask4) << 11) | (static_cast<uint16_t>(arr[8]) << 3) | static_cast<uint16_t>(arr[9] >> 5));
+    elems[5] = Zq((static_cast<uint16_t>(arr[9] & mask5) << 10) | (static_cast<uint16_t>(arr[10]) << 2) | static_cast<uint16_t>(arr[11] >> 6));
+    elems[6] = Zq((static_cast<uint16_t>(arr[11] & mask6) << 9) | (static_cast<uint16_t>(arr[12]) << 1) | static_cast<uint16_t>(arr[13] >> 7));
+    elems[7] = Zq((static_cast<uint16_t>(arr[13] & mask7) << 8) | static_cast<uint16_t>(arr[14]));
   } else if constexpr (D == 16ul) {
-    size_t boff = 0;
-    size_t moff = 0;
+    for (size_t i = 0; i < BLOCK_ELEMS; i++) {
+      elems[i] = Zq((static_cast<uint16_t>(arr[2 * i + 0]) << 8) | static_cast<uint16_t>(arr[2 * i + 1]) << 0);
+    }
+  }
+}
+
+// Given a matrix of dimension n1 x n2 s.t. its elements ∈ Zq, this routine can
+// be used for packing the matrix into a bit string of length n1 x n2 x D -bits
+// s.t. Q = 1 << D, following algorithm described in section 7.3 of FrodoKEM
+// specification.
+//
+// Note, we're dealing with byte oriented API, this routine packs matrix as a
+// byte array of length (n1 * n2 * D + 7) / 8.
+template<size_t n1, size_t n2, size_t D>
+inline constexpr void
+pack(const matrix::matrix<n1, n2, D>& mat, std::span<uint8_t, (n1 * n2 * D + 7) / 8> arr)
+  requires(frodo_params::check_d(D) && ((n1 * n2) % BLOCK_ELEMS == 0))
+{
+#if defined(__x86_64__)
+  if constexpr (D == 16ul) {
+    if (!std::is_constant_evaluated()) {
+      const auto src = reinterpret_cast<const uint8_t*>(mat.data());
+
+      switch (dispatch::active_tier()) {
+        case dispatch::tier_t::avx512bw:
+          packing_avx512::swap_bytes16<n1 * n2>(src, arr.data());
+          return;
+        case dispatch::tier_t::avx2:
+          packing_avx2::swap_bytes16<n1 * n2>(src, arr.data());
+          return;
+        default:
+          break;
+      }
+    }
+  }
+#endif
 
-    while (boff < byte_len) {
-      mat[moff] = Zq((static_cast<uint16_t>(arr[boff + 0]) << 8) | static_cast<uint16_t>(arr[boff + 1]) << 0);
+  for (size_t moff = 0, boff = 0; moff < mat.element_count(); moff += BLOCK_ELEMS, boff += D) {
+    pack_block<D>(mat.data() + moff, std::span<uint8_t, D>(arr.subspan(boff, D)));
+  }
+}
 
-      boff += 2;
-      moff += 1;
+// Given a bit string of length n1 x n2 x D -bits ( as a byte array of length
+// (n1 x n2 x D + 7) / 8 -bytes ), this routine can be used for unpacking
+// contiguous ( D -many ) bits into a n1 x n2 matrix over Zq s.t. q = 1 << D,
+// following algorithm described in section 7.3 of FrodoKEM specification.
+//
+// All elements of destination matrix get overwritten, so it can be carved out
+// of an uninitialized workspace or be an `uninitialized` heap matrix.
+template<size_t n1, size_t n2, size_t D, matrix::storage_of<n1, n2, D> matrix_t>
+inline constexpr void
+unpack(std::span<const uint8_t, (n1 * n2 * D + 7) / 8> arr, matrix_t& mat)
+  requires(frodo_params::check_d(D) && ((n1 * n2) % BLOCK_ELEMS == 0))
+{
+#if defined(__x86_64__)
+  if constexpr (D == 16ul) {
+    if (!std::is_constant_evaluated()) {
+      const auto dst = reinterpret_cast<uint8_t*>(mat.data());
+
+      switch (dispatch::active_tier()) {
+        case dispatch::tier_t::avx512bw:
+          packing_avx512::swap_bytes16<n1 * n2>(arr.data(), dst);
+          return;
+        case dispatch::tier_t::avx2:
+          packing_avx2::swap_bytes16<n1 * n2>(arr.data(), dst);
+          return;
+        default:
+          break;
+      }
     }
   }
+#endif
+
+  for (size_t moff = 0, boff = 0; moff < n1 * n2; moff += BLOCK_ELEMS, boff += D) {
+    unpack_block<D>(std::span<const uint8_t, D>(arr.subspan(boff, D)), mat.data() + moff);
+  }
+}
 
+// Given a bit string of length n1 x n2 x D -bits, this routine unpacks it into
+// a n1 x n2 matrix over Zq, returning it, see above.
+template<size_t n1, size_t n2, size_t D>
+inline constexpr matrix::matrix<n1, n2, D>
+unpack(std::span<const uint8_t, (n1 * n2 * D + 7) / 8> arr)
+  requires(frodo_params::check_d(D) && ((n1 * n2) % BLOCK_ELEMS == 0))
+{
+  matrix::matrix<n1, n2, D> mat{};
+  unpack<n1, n2, D>(arr, mat);
   return mat;
 }
 
+// Read-only view of a n1 x n2 matrix over Zq, in its packed form ( see `pack` ),
+// e.g. B in a serialized public key or B' in a cipher text. Kernels consume it
+// block by block, unpacking 8 elements at a time into registers, right before
+// using them, so the whole matrix is never unpacked into memory.
+//
+// Each row of n2 elements takes (n2 / 8) -many blocks, so no block straddles
+// two rows.
+template<size_t n1, size_t n2, size_t D>
+  requires(frodo_params::check_d(D) && (n2 % BLOCK_ELEMS == 0))
+struct packed_t
+{
+  static constexpr size_t BLOCKS_PER_ROW = n2 / BLOCK_ELEMS;
+
+  std::span<const uint8_t, (n1 * n2 * D + 7) / 8> bytes;
+
+  // Given a block index, this routine unpacks 8 consecutive elements of the
+  // matrix ( in row-major order ), starting at linear index 8 * blk.
+  inline constexpr void unpack_block(const size_t blk, zq::zq_t<D>* const elems) const
+  {
+    packing::unpack_block<D>(std::span<const uint8_t, D>(this->bytes.subspan(blk * D, D)), elems);
+  }
+
+  // Given a row index i, this routine returns a view of `count` -many
+  // consecutive rows of the matrix, starting at row i.
+  template<size_t count>
+  inline constexpr packed_t<count, n2, D> rows(const size_t ridx) const
+  {
+    constexpr size_t row_bytes = (n2 * D) / 8;
+    return { std::span<const uint8_t, count * row_bytes>(this->bytes.subspan(ridx * row_bytes, count * row_bytes)) };
+  }
+
+  // Given a matrix of same dimension, this routine tests, in constant-time,
+  // whether it packs to exactly same bit string, returning truth value ( =
+  // 0xffffffff ) if it does or false value ( = 0x00 ), same as unpacking this
+  // matrix and calling `matrix::ct_equal` would.
+  inline constexpr uint32_t ct_equal(const matrix::matrix<n1, n2, D>& mat) const
+  {
+    std::array<uint8_t, D> blk_bytes{};
+    uint8_t diff = 0;
+
+    for (size_t blk = 0; blk < (n1 * n2) / BLOCK_ELEMS; blk++) {
+      pack_block<D>(mat.data() + blk * BLOCK_ELEMS, blk_bytes);
+
+      for (size_t i = 0; i < D; i++) {
+        diff |= blk_bytes[i] ^ this->bytes[blk * D + i];
+      }
+    }
+
+    return subtle::ct_eq<uint8_t, uint32_t>(diff, 0);
+  }
+};
+
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX2 kernels for packing matrices modulo Q to bit strings and vice versa
+//
+// Kernels are compiled for AVX2, irrespective of flags used for compiling rest
+// of the library, so they must only be invoked when `dispatch::active_tier()`
+// says the CPU supports AVX2.
+namespace packing_avx2 {
+
+// Given `count` -many 16 -bit words, this routine swaps two bytes of each word,
+// writing them to destination. When D = 16, packing a matrix is exactly this,
+// as each element is serialized as two big-endian bytes, while matrix elements
+// live in little-endian 16 -bit words. And so is unpacking.
+template<size_t count>
+__attribute__((target("avx2"))) inline void
+swap_bytes16(const uint8_t* const __restrict src, uint8_t* const __restrict dst)
+{
+  const __m256i swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+  constexpr size_t vec_count = count - (count % 16);
+
+  for (size_t off = 0; off < vec_count; off += 16) {
+    const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + off * 2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + off * 2), _mm256_shuffle_epi8(words, swap));
+  }
+
+  for (size_t off = vec_count; off < count; off++) {
+    dst[off * 2 + 0] = src[off * 2 + 1];
+    dst[off * 2 + 1] = src[off * 2 + 0];
+  }
+}
+
+}
+
+#endif
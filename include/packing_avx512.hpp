@@ -0,0 +1,41 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX-512BW kernels for packing matrices modulo Q to bit strings and vice versa
+//
+// Kernels are compiled for AVX-512BW, irrespective of flags used for compiling
+// rest of the library, so they must only be invoked when
+// `dispatch::active_tier()` says the CPU supports AVX-512BW.
+namespace packing_avx512 {
+
+// Given `count` -many 16 -bit words, this routine swaps two bytes of each word,
+// writing them to destination, 32 words at a time. Last few words, if any, are
+// handled with masked loads and stores.
+template<size_t count>
+__attribute__((target("avx512f,avx512bw"))) inline void
+swap_bytes16(const uint8_t* const __restrict src, uint8_t* const __restrict dst)
+{
+  const __m512i swap = _mm512_set_epi64(0x0e0f0c0d0a0b0809ll,
+                                        0x0607040502030001ll,
+                                        0x0e0f0c0d0a0b0809ll,
+                                        0x0607040502030001ll,
+                                        0x0e0f0c0d0a0b0809ll,
+                                        0x0607040502030001ll,
+                                        0x0e0f0c0d0a0b0809ll,
+                                        0x0607040502030001ll);
+
+  for (size_t off = 0; off < count; off += 32) {
+    const __mmask32 mask = (count - off >= 32) ? ~__mmask32{ 0 } : static_cast<__mmask32>((1u << (count - off)) - 1u);
+
+    const __m512i words = _mm512_maskz_loadu_epi16(mask, src + off * 2);
+    _mm512_mask_storeu_epi16(dst + off * 2, mask, _mm512_shuffle_epi8(words, swap));
+  }
+}
+
+}
+
+#endif
@@ -1,11 +1,16 @@
 #pragma once
+#include "dispatch.hpp"
 #include "matrix.hpp"
 #include "params.hpp"
+#include "sampling_avx2.hpp"
+#include "sampling_avx512.hpp"
 #include "subtle.hpp"
+#include "swar.hpp"
 #include "zq.hpp"
 #include <array>
 #include <numeric>
 #include <span>
+#include <type_traits>
 
 // Sampling from the error distribution
 namespace sampling {
@@ -81,37 +86,203 @@ sample(const uint16_t r)
   return zq::zq_t<D>(((-r0) ^ e) + r0);
 }
 
+// Returns zero-centered CDF used for sampling, in {e}Frodo-n KEM.
+template<size_t n>
+constexpr auto
+cdf_table()
+  requires((n == 640) || (n == 976) || (n == 1344))
+{
+  if constexpr (n == 640) {
+    return Frodo640_Tχ;
+  } else if constexpr (n == 976) {
+    return Frodo976_Tχ;
+  } else {
+    return Frodo1344_Tχ;
+  }
+}
+
+// Given a bit string of length count x 16 -bits ( r ), this routine samples
+// `count` -many elements from the distribution χ of {e}Frodo-n, writing them to
+// destination, following algorithm described in section 7.5 of FrodoKEM
+// specification.
+//
+// Elements are sampled 32 or 16 at a time, using SIMD comparisons, when the
+// active instruction set tier allows it, otherwise four at a time, using SWAR.
+template<size_t n, size_t D, size_t count>
+inline constexpr void
+sample_elements(std::span<const uint8_t, 2 * count> r, zq::zq_t<D>* const e)
+{
+  constexpr auto Tχ = cdf_table<n>();
+  constexpr size_t L = Tχ.size();
+
+#if defined(__x86_64__)
+  if (!std::is_constant_evaluated()) {
+    const auto dst = reinterpret_cast<uint16_t*>(e);
+
+    switch (dispatch::active_tier()) {
+      case dispatch::tier_t::avx512bw:
+        if constexpr (count % sampling_avx512::LANES == 0) {
+          sampling_avx512::sample<L, Tχ, count>(r.data(), dst);
+          return;
+        }
+        [[fallthrough]];
+      case dispatch::tier_t::avx2:
+        if constexpr (count % sampling_avx2::LANES == 0) {
+          sampling_avx2::sample<L, Tχ, count>(r.data(), dst);
+          return;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+
+  size_t moff = 0;
+  size_t boff = 0;
+
+  if constexpr (count % swar::LANES == 0) {
+    // Portable SWAR path, sampling four elements at a time.
+    while (moff < count) {
+      const uint64_t tmp = swar::load_le_bytes(r.data() + boff);
+      swar::store(swar::sample<L, Tχ>(tmp), e + moff);
+
+      moff += swar::LANES;
+      boff += 2 * swar::LANES;
+    }
+  } else {
+    while (moff < count) {
+      const uint16_t tmp = (static_cast<uint16_t>(r[boff + 1]) << 8) | (static_cast<uint16_t>(r[boff + 0]) << 0);
+      e[moff] = sample<D, L, Tχ>(tmp);
+
+      moff += 1;
+      boff += 2;
+    }
+  }
+}
+
 // Given a bit string of length n1 x n2 x 16 -bits ( r ), this routine can be
 // used for sampling an error matrix of dimension n1 x n2 s.t. all elements ∈ Z,
 // following algorithm described in section 7.5 of FrodoKEM specification.
 //
 // - r is a byte array of length n1 x n2 x (16/ 8) -bytes.
-// - e is a matrix of dimension n1 x n2, over Z.
+// - e is a matrix of dimension n1 x n2, over Z, all of whose elements are
+//   overwritten.
+template<size_t n, size_t n1, size_t n2, size_t D, matrix::storage_of<n1, n2, D> matrix_t>
+inline constexpr void
+sample_matrix(std::span<const uint8_t, 16 * n1 * n2 / 8> r, matrix_t& e)
+{
+  sample_elements<n, D, n1 * n2>(r, e.data());
+}
+
+// Given a bit string of length n1 x n2 x 16 -bits ( r ), this routine returns
+// an error matrix of dimension n1 x n2, sampled out of it, see above.
 template<size_t n, size_t n1, size_t n2, size_t D>
 inline constexpr matrix::matrix<n1, n2, D>
 sample_matrix(std::span<const uint8_t, 16 * n1 * n2 / 8> r)
 {
   matrix::matrix<n1, n2, D> e{};
+  sample_matrix<n, n1, n2, D>(r, e);
+  return e;
+}
 
-  size_t moff = 0;
-  size_t boff = 0;
+// A finalized extendable output function ( i.e. SHAKE128 or SHAKE256 ), which
+// can be squeezed any number of times, each call continuing from where the
+// previous one stopped.
+template<typename T>
+concept xof_stream = requires(T& xof, std::span<uint8_t> out) { xof.squeeze(out); };
 
-  while (moff < e.element_count()) {
-    const uint16_t tmp = (static_cast<uint16_t>(r[boff + 1]) << 8) | (static_cast<uint16_t>(r[boff + 0]) << 0);
+// # -of elements sampled from each chunk of output squeezed out of a XOF. It's a
+// multiple of width of all sampling kernels, so that every chunk, but the last
+// one, takes the widest kernel.
+constexpr size_t STREAM_CHUNK = 256;
 
-    if constexpr (n == 640) {
-      e[moff] = sample<D, 13, Frodo640_Tχ>(tmp);
-    } else if constexpr (n == 976) {
-      e[moff] = sample<D, 11, Frodo976_Tχ>(tmp);
-    } else if constexpr (n == 1344) {
-      e[moff] = sample<D, 7, Frodo1344_Tχ>(tmp);
-    }
+// Given a finalized XOF, this routine squeezes next n1 x n2 x 16 -bits of its
+// output, sampling an error matrix of dimension n1 x n2 out of it, producing
+// exactly same matrix as squeezing all of those bytes at once and calling
+// `sample_matrix` on them.
+//
+// Output is squeezed and sampled in chunks of 512 -bytes, each consumed while
+// still hot in L1 cache, so the whole digest is never materialized. Sampled
+// matrix is written to `e`, overwriting all of its elements, so it can as well
+// be an `uninitialized` heap matrix.
+template<size_t n, size_t n1, size_t n2, size_t D, xof_stream xof_t, matrix::storage_of<n1, n2, D> matrix_t>
+inline void
+sample_matrix(xof_t& xof, matrix_t& e)
+{
+  constexpr size_t count = n1 * n2;
+  constexpr size_t tail = count % STREAM_CHUNK;
+
+  std::array<uint8_t, 2 * STREAM_CHUNK> buf{};
+
+  size_t off = 0;
+  for (; off + STREAM_CHUNK <= count; off += STREAM_CHUNK) {
+    xof.squeeze(buf);
+    sample_elements<n, D, STREAM_CHUNK>(buf, e.data() + off);
+  }
 
-    moff += 1;
-    boff += 2;
+  if constexpr (tail > 0) {
+    auto _buf = std::span(buf).template first<2 * tail>();
+
+    xof.squeeze(_buf);
+    sample_elements<n, D, tail>(_buf, e.data() + off);
   }
+}
 
+// Given a finalized XOF, this routine squeezes next n1 x n2 x 16 -bits of its
+// output, returning an error matrix of dimension n1 x n2, sampled out of it.
+template<size_t n, size_t n1, size_t n2, size_t D, xof_stream xof_t>
+inline matrix::matrix<n1, n2, D>
+sample_matrix(xof_t& xof)
+{
+  matrix::matrix<n1, n2, D> e{};
+  sample_matrix<n, n1, n2, D>(xof, e);
   return e;
 }
 
+// A finalized 4-way extendable output function, whose instances are squeezed in
+// lockstep, each call continuing from where the previous one stopped.
+template<typename T>
+concept xof_x4_stream = requires(T& xof, const std::array<uint8_t*, 4>& outs, const size_t len) { xof.squeeze(outs, len); };
+
+// Given a finalized 4-way XOF, this routine squeezes next n1 x n2 x 16 -bits of
+// output of each of its instances, sampling an error matrix of dimension n1 x n2
+// out of each of them, producing exactly same matrices as `sample_matrix` does,
+// with each instance, one by one.
+//
+// Output of all 4 instances is squeezed in lockstep, in chunks of 512 -bytes,
+// each sampled while still hot in L1 cache, so none of the digests is ever
+// materialized.
+template<size_t n, size_t n1, size_t n2, size_t D, xof_x4_stream xof_t, matrix::storage_of<n1, n2, D> matrix_t>
+inline void
+sample_matrix_x4(xof_t& xof, std::span<matrix_t, 4> es)
+{
+  constexpr size_t count = n1 * n2;
+  constexpr size_t tail = count % STREAM_CHUNK;
+
+  std::array<std::array<uint8_t, 2 * STREAM_CHUNK>, 4> bufs{};
+  std::array<uint8_t*, 4> outs{};
+
+  for (size_t j = 0; j < bufs.size(); j++) {
+    outs[j] = bufs[j].data();
+  }
+
+  size_t off = 0;
+  for (; off + STREAM_CHUNK <= count; off += STREAM_CHUNK) {
+    xof.squeeze(outs, 2 * STREAM_CHUNK);
+
+    for (size_t j = 0; j < bufs.size(); j++) {
+      sample_elements<n, D, STREAM_CHUNK>(bufs[j], es[j].data() + off);
+    }
+  }
+
+  if constexpr (tail > 0) {
+    xof.squeeze(outs, 2 * tail);
+
+    for (size_t j = 0; j < bufs.size(); j++) {
+      sample_elements<n, D, tail>(std::span(bufs[j]).template first<2 * tail>(), es[j].data() + off);
+    }
+  }
+}
+
 }
@@ -0,0 +1,54 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX2 kernels for sampling from the error distribution
+//
+// Kernels are compiled for AVX2, irrespective of flags used for compiling rest
+// of the library, so they must only be invoked when `dispatch::active_tier()`
+// says the CPU supports AVX2.
+namespace sampling_avx2 {
+
+// # -of 16 -bit values sampled by a single pass of the kernel.
+constexpr size_t LANES = 16;
+
+// Given `count` -many random little-endian 16 -bit values and a CDF table Tχ,
+// this routine samples an element from the distribution χ, for each of them,
+// exactly as `sampling::sample` does, following algorithm described in section
+// 7.4 of the FrodoKEM specification.
+//
+// Each CDF entry is broadcast and compared against t = r >> 1 of all 16 lanes
+// at once. As all CDF entries and t are < 2^15, signed comparison is exact and
+// it yields -1 in lanes where t > Tχ[z], which is subtracted from the running
+// count. There are no data-dependent branches or memory accesses.
+template<size_t L, std::array<uint16_t, L> Tχ, size_t count>
+__attribute__((target("avx2"))) inline void
+sample(const uint8_t* const __restrict src, uint16_t* const __restrict dst)
+  requires(count % LANES == 0)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi16(1);
+
+  for (size_t off = 0; off < count; off += LANES) {
+    const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + off * 2));
+    const __m256i t = _mm256_srli_epi16(r, 1);
+
+    __m256i e = zero;
+    for (size_t z = 0; z < L - 1; z++) {
+      e = _mm256_sub_epi16(e, _mm256_cmpgt_epi16(t, _mm256_set1_epi16(static_cast<int16_t>(Tχ[z]))));
+    }
+
+    const __m256i r0 = _mm256_and_si256(r, one);
+    const __m256i res = _mm256_add_epi16(_mm256_xor_si256(_mm256_sub_epi16(zero, r0), e), r0);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + off), res);
+  }
+}
+
+}
+
+#endif
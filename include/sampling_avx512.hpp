@@ -0,0 +1,52 @@
+#pragma once
+
+#if defined(__x86_64__)
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// AVX-512BW kernels for sampling from the error distribution
+//
+// Kernels are compiled for AVX-512BW, irrespective of flags used for compiling
+// rest of the library, so they must only be invoked when
+// `dispatch::active_tier()` says the CPU supports AVX-512BW.
+namespace sampling_avx512 {
+
+// # -of 16 -bit values sampled by a single pass of the kernel.
+constexpr size_t LANES = 32;
+
+// Given `count` -many random little-endian 16 -bit values and a CDF table Tχ,
+// this routine samples an element from the distribution χ, for each of them,
+// exactly as `sampling::sample` does, 32 at a time. Outcome of comparing t
+// with each CDF entry lands in a mask register, which only selects lanes of
+// the running count to be incremented, so there are no data-dependent
+// branches or memory accesses.
+template<size_t L, std::array<uint16_t, L> Tχ, size_t count>
+__attribute__((target("avx512f,avx512bw"))) inline void
+sample(const uint8_t* const __restrict src, uint16_t* const __restrict dst)
+  requires(count % LANES == 0)
+{
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi16(1);
+
+  for (size_t off = 0; off < count; off += LANES) {
+    const __m512i r = _mm512_loadu_si512(reinterpret_cast<const void*>(src + off * 2));
+    const __m512i t = _mm512_srli_epi16(r, 1);
+
+    __m512i e = zero;
+    for (size_t z = 0; z < L - 1; z++) {
+      const __mmask32 gt = _mm512_cmpgt_epi16_mask(t, _mm512_set1_epi16(static_cast<int16_t>(Tχ[z])));
+      e = _mm512_mask_add_epi16(e, gt, e, one);
+    }
+
+    const __m512i r0 = _mm512_and_si512(r, one);
+    const __m512i res = _mm512_add_epi16(_mm512_xor_si512(_mm512_sub_epi16(zero, r0), e), r0);
+
+    _mm512_storeu_si512(reinterpret_cast<void*>(dst + off), res);
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+#pragma once
+#include "zq.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Portable SIMD-within-a-register ( SWAR ) arithmetic over Zq
+//
+// Four 16 -bit lanes are packed in an unsigned 64 -bit word s.t. lane l lives
+// in bits [16l, 16l + 16), i.e. lane 0 holds the element with lowest index.
+// Each lane is an element of Zq | q = 2^D and D <= 16, kept modulo 2^16 just
+// like `zq::zq_t` does, so results are bit-identical to scalar arithmetic. No
+// intrinsics are used, only plain 64 -bit integer operations, which makes this
+// the fallback for targets without a vector instruction set tier and a
+// readable reference for the vectorized kernels.
+namespace swar {
+
+// # -of 16 -bit lanes packed in a single 64 -bit word.
+constexpr size_t LANES = 4;
+
+// Whether SWAR kernels should be used for matrix arithmetic ( i.e. additions,
+// subtractions and multiplications ), instead of plain scalar loops, when no
+// vector instruction set tier is active. Compilers auto-vectorize plain scalar
+// loops pretty well when targeting a vector ISA, which is always available on
+// x86-64 ( SSE2 ) and AArch64 ( NEON ), beating SWAR. Define
+// `FRODOKEM_FORCE_SWAR` for using SWAR kernels irrespective of target. Error
+// sampling always uses SWAR, because compilers don't vectorize its chain of
+// constant-time comparisons.
+#if defined(FRODOKEM_FORCE_SWAR)
+constexpr bool PREFERRED = true;
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(__ALTIVEC__) || defined(__wasm_simd128__) || defined(__riscv_vector)
+constexpr bool PREFERRED = false;
+#else
+constexpr bool PREFERRED = true;
+#endif
+
+// Most significant bit of each 16 -bit lane.
+constexpr uint64_t HI_BITS = 0x8000800080008000ul;
+
+// Least significant bit of each 16 -bit lane.
+constexpr uint64_t LO_BITS = 0x0001000100010001ul;
+
+// Lanes 0 and 2, each zero-extended to a 32 -bit slot.
+constexpr uint64_t EVEN_LANES = 0x0000ffff0000fffful;
+
+// Given a 16 -bit value, this routine replicates it over all four lanes.
+inline constexpr uint64_t
+broadcast(const uint16_t v)
+{
+  return static_cast<uint64_t>(v) * LO_BITS;
+}
+
+// Lane-wise addition modulo 2^16. Sum of low 15 bits of each lane can't carry
+// into the next lane, while top bits are summed, without carry, using xor.
+inline constexpr uint64_t
+add(const uint64_t x, const uint64_t y)
+{
+  return ((x & ~HI_BITS) + (y & ~HI_BITS)) ^ ((x ^ y) & HI_BITS);
+}
+
+// Lane-wise subtraction modulo 2^16. Setting top bit of each lane of minuend,
+// before subtracting, stops borrows from crossing lane boundaries.
+inline constexpr uint64_t
+sub(const uint64_t x, const uint64_t y)
+{
+  return ((x | HI_BITS) - (y & ~HI_BITS)) ^ ((x ^ ~y) & HI_BITS);
+}
+
+// Lane-wise multiplication of four lanes with a 16 -bit scalar, modulo 2^16.
+// Even and odd lanes are spread into 32 -bit slots, so that full 32 -bit
+// products don't overflow into neighbouring lanes.
+inline constexpr uint64_t
+mul(const uint64_t x, const uint16_t s)
+{
+  const uint64_t even = ((x & EVEN_LANES) * s) & EVEN_LANES;
+  const uint64_t odd = (((x >> 16) & EVEN_LANES) * s) & EVEN_LANES;
+
+  return even | (odd << 16);
+}
+
+// Accumulator for lazily reduced sum of lane-wise products. Even and odd lanes
+// are kept in separate 32 -bit slots and each product is truncated to 16 -bits
+// before being added, so upto 2^16 products can be accumulated before a slot
+// overflows, saving the cost of reducing after every addition.
+struct acc_t
+{
+  uint64_t even = 0;
+  uint64_t odd = 0;
+};
+
+// Given an accumulator, four lanes packed in a word and a 16 -bit scalar, this
+// routine adds lane-wise product of them to the accumulator.
+inline constexpr void
+mul_acc(acc_t& acc, const uint64_t x, const uint16_t s)
+{
+  acc.even += ((x & EVEN_LANES) * s) & EVEN_LANES;
+  acc.odd += (((x >> 16) & EVEN_LANES) * s) & EVEN_LANES;
+}
+
+// Given an accumulator, this routine reduces it back to four lanes, modulo
+// 2^16, packed in a word.
+inline constexpr uint64_t
+reduce(const acc_t& acc)
+{
+  return (acc.even & EVEN_LANES) | ((acc.odd & EVEN_LANES) << 16);
+}
+
+// Given pointer to four consecutive elements of Zq, this routine packs them in
+// a word.
+template<size_t D>
+inline constexpr uint64_t
+load(const zq::zq_t<D>* const src)
+{
+  static_assert(sizeof(zq::zq_t<D>) == sizeof(uint16_t), "Zq element must be backed by a 16 -bit word");
+
+  if (!std::is_constant_evaluated() && (std::endian::native == std::endian::little)) {
+    uint64_t w;
+    std::memcpy(&w, src, sizeof(w));
+    return w;
+  }
+
+  uint64_t w = 0;
+  for (size_t l = 0; l < LANES; l++) {
+    w |= static_cast<uint64_t>(src[l].to_raw()) << (l * 16);
+  }
+
+  return w;
+}
+
+// Given four lanes packed in a word, this routine unpacks them into four
+// consecutive elements of Zq.
+template<size_t D>
+inline constexpr void
+store(const uint64_t w, zq::zq_t<D>* const dst)
+{
+  if (!std::is_constant_evaluated() && (std::endian::native == std::endian::little)) {
+    std::memcpy(static_cast<void*>(dst), &w, sizeof(w));
+    return;
+  }
+
+  for (size_t l = 0; l < LANES; l++) {
+    dst[l] = zq::zq_t<D>(static_cast<uint16_t>(w >> (l * 16)));
+  }
+}
+
+// Given pointer to eight bytes, this routine interprets them as four
+// little-endian 16 -bit values, packed in a word.
+inline constexpr uint64_t
+load_le_bytes(const uint8_t* const src)
+{
+  if (!std::is_constant_evaluated() && (std::endian::native == std::endian::little)) {
+    uint64_t w;
+    std::memcpy(&w, src, sizeof(w));
+    return w;
+  }
+
+  uint64_t w = 0;
+  for (size_t b = 0; b < 2 * LANES; b++) {
+    w |= static_cast<uint64_t>(src[b]) << (b * 8);
+  }
+
+  return w;
+}
+
+// Given four random 16 -bit values packed in a word and a CDF table Tχ, this
+// routine samples four elements from the distribution χ, exactly as
+// `sampling::sample` does for a single value, following algorithm described in
+// section 7.4 of the FrodoKEM specification.
+//
+// All CDF entries are < 2^15, as is t = r >> 1, so top bit of each lane of
+// (Tχ[z] | 2^15) - t is set iff Tχ[z] >= t, without any borrow crossing lane
+// boundaries. It's a branch-free and table-lookup-free comparison, running in
+// constant-time.
+template<size_t L, std::array<uint16_t, L> Tχ>
+inline constexpr uint64_t
+sample(const uint64_t r)
+{
+  static_assert(std::ranges::all_of(Tχ, [](const uint16_t v) { return v < (1u << 15); }), "CDF entries must be < 2^15");
+
+  const uint64_t t = (r >> 1) & ~HI_BITS;
+  uint64_t e = 0;
+
+  for (size_t z = 0; z < L - 1; z++) {
+    const uint64_t le = ((broadcast(Tχ[z]) | HI_BITS) - t) & HI_BITS;
+    e += (le ^ HI_BITS) >> 15;
+  }
+
+  const uint64_t r0 = r & LO_BITS;
+  return add((r0 * 0xffff) ^ e, r0);
+}
+
+}
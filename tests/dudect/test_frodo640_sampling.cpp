@@ -0,0 +1,73 @@
+#include "sampling.hpp"
+#include <cstdio>
+
+#define DUDECT_IMPLEMENTATION
+#define DUDECT_VISIBLITY_STATIC
+#include "dudect.h"
+
+// Error matrix E'' of {e}Frodo-640, of dimension n̄ x n̄, which is sampled
+// using widest kernel, supported by the active instruction set tier.
+constexpr size_t n = 640;
+constexpr size_t n̄ = 8;
+constexpr size_t D = 15;
+constexpr size_t CHUNK_BYTE_LEN = (n̄ * n̄ * 16) / 8;
+
+uint8_t
+do_one_computation(uint8_t* const data)
+{
+  auto r = std::span<const uint8_t, CHUNK_BYTE_LEN>(data, CHUNK_BYTE_LEN);
+
+  uint8_t ret_val = 0;
+
+  const auto e = sampling::sample_matrix<n, n̄, n̄, D>(r);
+  ret_val ^= static_cast<uint8_t>(e[0].to_raw() ^ e[e.element_count() - 1].to_raw());
+
+  return ret_val;
+}
+
+void
+prepare_inputs(dudect_config_t* const c, uint8_t* const input_data, uint8_t* const classes)
+{
+  randombytes(input_data, c->number_measurements * c->chunk_size);
+
+  for (size_t i = 0; i < c->number_measurements; i++) {
+    classes[i] = randombit();
+    if (classes[i] == 0) {
+      std::memset(input_data + i * c->chunk_size, 0x00, c->chunk_size);
+    }
+  }
+}
+
+dudect_state_t
+test_frodo640_sampling()
+{
+  constexpr size_t chunk_size = CHUNK_BYTE_LEN;
+  constexpr size_t number_measurements = 1e5;
+
+  dudect_config_t config = {
+    chunk_size,
+    number_measurements,
+  };
+  dudect_ctx_t ctx;
+  dudect_init(&ctx, &config);
+
+  dudect_state_t state = DUDECT_NO_LEAKAGE_EVIDENCE_YET;
+  while (state == DUDECT_NO_LEAKAGE_EVIDENCE_YET) {
+    state = dudect_main(&ctx);
+  }
+
+  dudect_free(&ctx);
+
+  printf("Detected timing leakage in \"%s\", defined in file \"%s\"\n", __func__, __FILE_NAME__);
+  return state;
+}
+
+int
+main()
+{
+  if (test_frodo640_sampling() != DUDECT_NO_LEAKAGE_EVIDENCE_YET) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
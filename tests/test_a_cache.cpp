@@ -0,0 +1,268 @@
+#include "a_cache.hpp"
+#include "kem.hpp"
+#include "matrix.hpp"
+#include "prng.hpp"
+#include "test_helper.hpp"
+#include "utils.hpp"
+#include <array>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Test if, rows read from a cached matrix A are same as the ones of matrix A,
+// expanded from same seed, while hits and misses are counted as expected.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_a_cache_hit_miss()
+{
+  std::array<uint8_t, len_seed_A / 8> seed{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  a_cache::cache_t cache{};
+
+  const auto view0 = cache.template get<n, len_seed_A, D, prg>(seed);
+  const auto view1 = cache.template get<n, len_seed_A, D, prg>(seed);
+
+  ASSERT_TRUE(view0);
+  ASSERT_TRUE(view1);
+  EXPECT_EQ(view0.data(), view1.data());
+
+  const auto stats = cache.stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_EQ(stats.bytes, n * n * sizeof(zq::zq_t<D>));
+
+  const auto A = matrix::matrix<n, n, D>::template generate<len_seed_A, prg>(seed);
+
+  for (size_t i = 0; i < n * n; i++) {
+    EXPECT_EQ(view0.data()[i].to_canonical(), A[i].to_canonical());
+  }
+}
+
+TEST(FrodoKEM, ACacheHitMiss)
+{
+  test_a_cache_hit_miss<640, 128, 15>();
+  test_a_cache_hit_miss<976, 128, 16>();
+  test_a_cache_hit_miss<1344, 128, 16>();
+  test_a_cache_hit_miss<640, 128, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, cache evicts least recently used matrix, when it runs out of byte
+// budget, and refuses to cache a matrix, which alone doesn't fit in budget.
+TEST(FrodoKEM, ACacheEviction)
+{
+  constexpr size_t n = 640;
+  constexpr size_t D = 15;
+  constexpr size_t mat_bytes = n * n * sizeof(zq::zq_t<D>);
+
+  std::array<std::array<uint8_t, 16>, 3> seeds{};
+
+  prng::prng_t prng;
+  for (auto& seed : seeds) {
+    prng.read(seed);
+  }
+
+  a_cache::cache_t cache({ .budget_bytes = 2 * mat_bytes });
+
+  EXPECT_TRUE((cache.get<n, 128, D>(seeds[0])));
+  const auto view = cache.get<n, 128, D>(seeds[1]);
+  EXPECT_TRUE(view);
+
+  // Touch first matrix, so that second one becomes least recently used.
+  EXPECT_TRUE((cache.get<n, 128, D>(seeds[0])));
+  EXPECT_TRUE((cache.get<n, 128, D>(seeds[2])));
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.bytes, 2 * mat_bytes);
+
+  // First matrix survived, second one got evicted, yet its view stays valid.
+  EXPECT_TRUE((cache.get<n, 128, D>(seeds[0])));
+  EXPECT_EQ(cache.stats().hits, stats.hits + 1);
+  const auto A1 = matrix::matrix<n, n, D>::generate<128>(seeds[1]);
+  EXPECT_EQ(view.data()[0].to_canonical(), A1[0].to_canonical());
+
+  cache.set_budget(mat_bytes - 1);
+  stats = cache.stats();
+
+  EXPECT_EQ(stats.entries, 0u);
+  EXPECT_EQ(stats.bytes, 0u);
+  EXPECT_FALSE((cache.get<n, 128, D>(seeds[0])));
+  EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+// Test if, many threads looking up same set of matrices, concurrently, all get
+// correct matrices, while each of them is cached only once.
+TEST(FrodoKEM, ACacheConcurrentLookup)
+{
+  constexpr size_t n = 640;
+  constexpr size_t D = 15;
+  constexpr size_t thread_cnt = 8;
+  constexpr size_t rounds = 16;
+
+  std::array<std::array<uint8_t, 16>, 4> seeds{};
+  std::array<uint16_t, seeds.size()> expected{};
+
+  prng::prng_t prng;
+  for (size_t i = 0; i < seeds.size(); i++) {
+    prng.read(seeds[i]);
+    expected[i] = matrix::matrix<n, n, D>::generate<128>(seeds[i])[n * n - 1].to_canonical();
+  }
+
+  a_cache::cache_t cache{};
+  std::array<bool, thread_cnt> ok{};
+  std::vector<std::thread> threads{};
+
+  for (size_t t = 0; t < thread_cnt; t++) {
+    threads.emplace_back([&, t]() {
+      bool res = true;
+
+      for (size_t r = 0; r < rounds; r++) {
+        const size_t i = (t + r) % seeds.size();
+        const auto view = cache.get<n, 128, D>(seeds[i]);
+
+        res &= static_cast<bool>(view) && (view.data()[n * n - 1].to_canonical() == expected[i]);
+      }
+
+      ok[t] = res;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto res : ok) {
+    EXPECT_TRUE(res);
+  }
+
+  const auto stats = cache.stats();
+  EXPECT_EQ(stats.entries, seeds.size());
+  EXPECT_EQ(stats.hits + stats.misses, thread_cnt * rounds);
+}
+
+// Test if, a thread's snapshot of the table is retaken, once some other thread
+// inserts or drops a matrix, while lookups of many caches, alternating in one
+// thread, never mix up their snapshots.
+TEST(FrodoKEM, ACacheSnapshots)
+{
+  constexpr size_t n = 640;
+  constexpr size_t D = 15;
+
+  std::array<uint8_t, 16> seed{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  a_cache::cache_t cache{};
+
+  EXPECT_TRUE((cache.get<n, 128, D>(seed)));
+  EXPECT_TRUE((cache.get<n, 128, D>(seed)));
+  EXPECT_EQ(cache.stats().hits, 1u);
+
+  std::thread([&]() { EXPECT_TRUE((cache.erase<n, 128, D>(seed))); }).join();
+
+  EXPECT_TRUE((cache.get<n, 128, D>(seed)));
+  EXPECT_EQ(cache.stats().misses, 2u);
+
+  std::thread([&]() { cache.clear(); }).join();
+
+  EXPECT_TRUE((cache.get<n, 128, D>(seed)));
+  EXPECT_EQ(cache.stats().misses, 3u);
+  EXPECT_EQ(cache.stats().entries, 1u);
+
+  // More caches than a thread keeps snapshots for, each holding a matrix of its own.
+  std::vector<std::unique_ptr<a_cache::cache_t>> caches{};
+  std::vector<std::array<uint8_t, 16>> seeds(2 * a_cache::internal::SNAPSHOT_SLOTS + 1);
+
+  for (auto& _seed : seeds) {
+    prng.read(_seed);
+
+    caches.emplace_back(std::make_unique<a_cache::cache_t>());
+    EXPECT_TRUE((caches.back()->get<n, 128, D>(_seed)));
+  }
+
+  for (size_t round = 0; round < 2; round++) {
+    for (size_t i = 0; i < caches.size(); i++) {
+      const auto view = caches[i]->get<n, 128, D>(seeds[i]);
+      const auto other = caches[i]->get<n, 128, D>(seeds[(i + 1) % seeds.size()]);
+
+      EXPECT_TRUE(view);
+      EXPECT_TRUE(other);
+      EXPECT_NE(view.data(), other.data());
+    }
+  }
+
+  for (const auto& _cache : caches) {
+    EXPECT_EQ(_cache->stats().entries, 2u);
+    EXPECT_EQ(_cache->stats().misses, 2u);
+    EXPECT_EQ(_cache->stats().hits, 3u);
+  }
+}
+
+// Test if, encapsulating and decapsulating using prepared keys, which read rows
+// of matrix A from a cache, produces exactly same cipher text and shared secret
+// as using serialized keys.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_kem_with_cached_a()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t rounds = 4;
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  a_cache::cache_t cache{};
+
+  const kem::prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(keypair.pkey, cache);
+  const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(keypair.skey, cache);
+
+  EXPECT_TRUE(ppk.a_rows().cached());
+  EXPECT_TRUE(psk.a_rows().cached());
+  EXPECT_EQ(cache.stats().misses, 1u);
+  EXPECT_EQ(cache.stats().hits, 1u);
+
+  for (size_t i = 0; i < rounds; i++) {
+    std::array<uint8_t, len_sec / 8> μ{};
+    std::array<uint8_t, len_salt / 8> salt{};
+
+    prng.read(μ);
+    prng.read(salt);
+
+    std::vector<uint8_t> enc0(ctlen, 0), enc1(ctlen, 0);
+    std::array<uint8_t, len_sec / 8> ss0{}, ss1{}, ss2{};
+
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, std::span<uint8_t, ctlen>(enc0), ss0);
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, std::span<uint8_t, ctlen>(enc1), ss1);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, std::span<uint8_t, ctlen>(enc1), ss2);
+
+    EXPECT_EQ(enc0, enc1);
+    EXPECT_EQ(ss0, ss1);
+    EXPECT_EQ(ss1, ss2);
+  }
+}
+
+TEST(FrodoKEM, KEMWithCachedA)
+{
+  test_kem_with_cached_a<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_kem_with_cached_a<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_kem_with_cached_a<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_kem_with_cached_a<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
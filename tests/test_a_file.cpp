@@ -0,0 +1,201 @@
+#include "a_cache.hpp"
+#include "a_file.hpp"
+#include "kem.hpp"
+#include "matrix.hpp"
+#include "prng.hpp"
+#include "test_helper.hpp"
+#include "utils.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Returns a path, in temporary directory, unique to this process and given tag.
+static std::filesystem::path
+temp_path(const std::string& tag)
+{
+  return std::filesystem::temp_directory_path() / ("frodokem-a-" + tag + "-" + std::to_string(getpid()) + ".bin");
+}
+
+// Test if, matrix A written to a file and mapped back is same as the one
+// expanded from seed, while files of some other matrix A are rejected.
+template<size_t n, size_t len_seed_A, size_t D, gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_a_file_roundtrip()
+{
+  std::array<uint8_t, len_seed_A / 8> seed{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  const auto path = temp_path(std::to_string(n) + "-" + std::to_string(static_cast<uint32_t>(prg)));
+
+  ASSERT_TRUE((a_file::write<n, len_seed_A, D, prg>(path, seed)));
+  EXPECT_EQ(std::filesystem::file_size(path), a_file::file_len(n));
+
+  const auto mapped = a_file::map<n, len_seed_A, D, prg>(path, seed);
+  ASSERT_TRUE(mapped.has_value());
+
+  const auto A = matrix::matrix<n, n, D>::template generate<len_seed_A, prg>(seed);
+  const auto view = mapped->view();
+
+  for (size_t i = 0; i < n * n; i++) {
+    EXPECT_EQ(view.data()[i].to_raw(), A[i].to_raw());
+  }
+
+  EXPECT_TRUE(mapped->verify_checksum());
+  EXPECT_TRUE(mapped->verify());
+
+  // Header must identify exactly same matrix A.
+  auto other_seed = seed;
+  other_seed[0] ^= 1;
+
+  constexpr auto other_prg = (prg == gen_a::prg_t::shake128) ? gen_a::prg_t::aes128 : gen_a::prg_t::shake128;
+
+  EXPECT_FALSE((a_file::map<n, len_seed_A, D, prg>(path, other_seed)));
+  EXPECT_FALSE((a_file::map<n, len_seed_A, D + 1, prg>(path, seed)));
+  EXPECT_FALSE((a_file::map<n, len_seed_A, D, other_prg>(path, seed)));
+  EXPECT_FALSE((a_file::map<n, len_seed_A, D, prg>(temp_path("missing"), seed)));
+
+  std::filesystem::remove(path);
+}
+
+TEST(FrodoKEM, AFileRoundtrip)
+{
+  test_a_file_roundtrip<640, 128, 15>();
+  test_a_file_roundtrip<976, 128, 16>();
+  test_a_file_roundtrip<1344, 128, 16>();
+  test_a_file_roundtrip<640, 128, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, truncated files are rejected, while corrupted elements are caught by
+// both checksum and full verification against seed.
+TEST(FrodoKEM, AFileCorruption)
+{
+  constexpr size_t n = 640;
+  constexpr size_t D = 15;
+
+  std::array<uint8_t, 16> seed{};
+
+  prng::prng_t prng;
+  prng.read(seed);
+
+  const auto path = temp_path("corrupt");
+
+  ASSERT_TRUE((a_file::write<n, 128, D>(path, seed)));
+
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(a_file::HEADER_LEN + n * 2 + 1));
+    file.put(0x5a);
+  }
+
+  const auto mapped = a_file::map<n, 128, D>(path, seed);
+  ASSERT_TRUE(mapped.has_value());
+
+  EXPECT_FALSE(mapped->verify_checksum());
+  EXPECT_FALSE(mapped->verify());
+
+  // Outcomes are memoized and shared by copies.
+  const auto copy = *mapped;
+  EXPECT_FALSE(copy.verify_checksum());
+  EXPECT_FALSE(copy.verify());
+
+  // Loading verifies checksum by default, while a mapping loaded without it can
+  // still be verified later on, evicting it from the cache.
+  a_cache::cache_t cache{};
+  EXPECT_FALSE((a_file::load<n, 128, D>(path, seed, cache)));
+  EXPECT_EQ(cache.stats().entries, 0u);
+
+  const auto loaded = a_file::load<n, 128, D>(path, seed, cache, false);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(cache.stats().entries, 1u);
+  EXPECT_FALSE(loaded->verify());
+  EXPECT_TRUE((cache.erase<n, 128, D>(seed)));
+  EXPECT_FALSE((cache.erase<n, 128, D>(seed)));
+  EXPECT_EQ(cache.stats().entries, 0u);
+  EXPECT_EQ(cache.stats().bytes, 0u);
+
+  std::filesystem::resize_file(path, a_file::file_len(n) - 2);
+  EXPECT_FALSE((a_file::map<n, 128, D>(path, seed)));
+
+  std::filesystem::remove(path);
+}
+
+// Test if, loading matrix A from a file into a cache lets prepared keys read it
+// straight out of the mapping, while encapsulation and decapsulation produce
+// exactly same cipher text and shared secret as using serialized keys.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_kem_with_mapped_a()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t pklen = utils::kem_pub_key_len(n, n̄, len_A, D);
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  // seedA is the prefix of public key.
+  const auto seedA = std::span<const uint8_t, pklen>(keypair.pkey).template subspan<0, len_A / 8>();
+  const auto path = temp_path("kem-" + std::to_string(n));
+
+  ASSERT_TRUE((a_file::write<n, len_A, D, prg>(path, seedA)));
+
+  a_cache::cache_t cache{};
+  const auto loaded = a_file::load<n, len_A, D, prg>(path, seedA, cache);
+  ASSERT_TRUE(loaded.has_value());
+
+  // Loading the same matrix again keeps the cached mapping.
+  EXPECT_FALSE((a_file::load<n, len_A, D, prg>(path, seedA, cache)));
+
+  // The file stays mapped, as long as the cache holds it, even after it's removed.
+  std::filesystem::remove(path);
+
+  const kem::prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(keypair.pkey, cache);
+  const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(keypair.skey, cache);
+
+  EXPECT_TRUE(ppk.a_rows().cached());
+  EXPECT_TRUE(psk.a_rows().cached());
+  EXPECT_EQ(cache.stats().misses, 0u);
+  EXPECT_EQ(cache.stats().hits, 2u);
+  EXPECT_TRUE(loaded->verify());
+
+  std::array<uint8_t, len_sec / 8> μ{};
+  std::array<uint8_t, len_salt / 8> salt{};
+
+  prng.read(μ);
+  prng.read(salt);
+
+  std::vector<uint8_t> enc0(ctlen, 0), enc1(ctlen, 0);
+  std::array<uint8_t, len_sec / 8> ss0{}, ss1{}, ss2{};
+
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, std::span<uint8_t, ctlen>(enc0), ss0);
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, std::span<uint8_t, ctlen>(enc1), ss1);
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, std::span<uint8_t, ctlen>(enc1), ss2);
+
+  EXPECT_EQ(enc0, enc1);
+  EXPECT_EQ(ss0, ss1);
+  EXPECT_EQ(ss1, ss2);
+}
+
+TEST(FrodoKEM, KEMWithMappedA)
+{
+  test_kem_with_mapped_a<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_kem_with_mapped_a<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_kem_with_mapped_a<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_kem_with_mapped_a<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
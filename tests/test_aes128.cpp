@@ -0,0 +1,119 @@
+#include "aes128.hpp"
+#include "aes128_aesni.hpp"
+#include "dispatch.hpp"
+#include "prng.hpp"
+#include "utils.hpp"
+#include <array>
+#include <gtest/gtest.h>
+
+// Multiplies two elements of GF(2^8), reducing by x^8 + x^4 + x^3 + x + 1.
+static constexpr uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+  uint8_t res = 0;
+  while (b != 0) {
+    res ^= (b & 1) ? a : 0;
+    a = static_cast<uint8_t>((a << 1) ^ ((a & 0x80) ? 0x1b : 0));
+    b >>= 1;
+  }
+
+  return res;
+}
+
+// Computes AES S-box entry for given byte, as multiplicative inverse in
+// GF(2^8), followed by affine transformation, following section 5.1.1 of FIPS
+// 197.
+static constexpr uint8_t
+sbox_ref(const uint8_t v)
+{
+  uint8_t inv = 0;
+  for (uint32_t c = 1; c < 256; c++) {
+    inv = (gf_mul(v, static_cast<uint8_t>(c)) == 1) ? static_cast<uint8_t>(c) : inv;
+  }
+
+  uint8_t res = 0x63;
+  for (size_t i = 0; i < 5; i++) {
+    res ^= static_cast<uint8_t>((inv << i) | (inv >> ((8 - i) % 8)));
+  }
+
+  return res;
+}
+
+// Test if, bitsliced AES S-box circuit agrees with its definition, for every
+// possible byte, at every byte position of bitsliced state.
+TEST(FrodoKEM, AES128SBox)
+{
+  for (uint32_t v = 0; v < 256; v++) {
+    std::array<uint8_t, aes128::PAR_BLOCKS * aes128::BLOCK_LEN> bytes{};
+    bytes.fill(static_cast<uint8_t>(v));
+
+    aes128::planes_t q{};
+    aes128::bitslice(bytes.data(), q);
+    aes128::sub_bytes(q);
+    aes128::unbitslice(q, bytes.data());
+
+    for (const auto b : bytes) {
+      EXPECT_EQ(b, sbox_ref(static_cast<uint8_t>(v)));
+    }
+  }
+}
+
+// Test if, bitsliced AES-128 encrypts four different blocks correctly, using
+// example vector from appendix C.1 of FIPS 197 and ciphertexts computed using
+// OpenSSL, for rest of the blocks.
+TEST(FrodoKEM, AES128Encrypt)
+{
+  constexpr size_t len = aes128::PAR_BLOCKS * aes128::BLOCK_LEN;
+  constexpr std::array<uint8_t, aes128::KEY_LEN> key = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+  const auto pt = frodo_utils::from_hex<len>("00112233445566778899aabbccddeeff"
+                                             "03152735435d6f7d8395a7b5c3cdffed"
+                                             "06162a3a4e5e6a7a8696baaadecefaea"
+                                             "091b293f495b6967998bb9afd9cbf9e7");
+  const auto expected = frodo_utils::from_hex<len>("69c4e0d86a7b0430d8cdb78070b4c55a"
+                                                   "0a912dc0e9ec4e95a4b4bff89eee8269"
+                                                   "1a34cbb78878e6960a96a4a11a139e00"
+                                                   "12f2d6526d3136692abfa353c8f38ee8");
+
+  // Key expansion is usable at compile-time too.
+  constexpr auto rk = aes128::expand_key(key);
+  static_assert(rk.bytes[rk.bytes.size() - 1] == 0xc5, "Last round key byte must match FIPS 197 appendix C.1");
+
+  std::array<uint8_t, len> ct{};
+  aes128::encrypt(rk, pt.data(), ct.data());
+
+  EXPECT_EQ(ct, expected);
+}
+
+#if defined(__x86_64__)
+// Test if, AES-NI kernel produces same cipher texts as bitsliced software
+// implementation, for random keys and blocks.
+TEST(FrodoKEM, AES128AESNIMatchesBitsliced)
+{
+  if (!dispatch::detect_aesni()) {
+    GTEST_SKIP() << "AES-NI isn't supported by this CPU";
+  }
+
+  constexpr size_t rounds = 1ul << 8;
+  constexpr size_t len = aes128_aesni::PAR_BLOCKS * aes128::BLOCK_LEN;
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < rounds; i++) {
+    std::array<uint8_t, aes128::KEY_LEN> key{};
+    std::array<uint8_t, len> pt{}, ct0{}, ct1{};
+
+    prng.read(key);
+    prng.read(pt);
+
+    const auto rk = aes128::expand_key(key);
+
+    aes128_aesni::encrypt(rk, pt.data(), ct0.data());
+    for (size_t off = 0; off < len; off += aes128::PAR_BLOCKS * aes128::BLOCK_LEN) {
+      aes128::encrypt(rk, pt.data() + off, ct1.data() + off);
+    }
+
+    EXPECT_EQ(ct0, ct1);
+  }
+}
+#endif
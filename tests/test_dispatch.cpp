@@ -0,0 +1,407 @@
+#include "aes128.hpp"
+#include "dispatch.hpp"
+#include "gen_a.hpp"
+#include "kem.hpp"
+#include "matmul.hpp"
+#include "matrix.hpp"
+#include "prng.hpp"
+#include "sampling.hpp"
+#include "shake256.hpp"
+#include "test_helper.hpp"
+#include "utils.hpp"
+#include <array>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Test if, each instruction set tier can be parsed back from its name and
+// forcing a tier never activates one, which isn't supported by this CPU.
+TEST(FrodoKEM, DispatchTierSelection)
+{
+  using dispatch::tier_t;
+
+  for (const auto tier : { tier_t::scalar, tier_t::avx2, tier_t::avx512bw }) {
+    EXPECT_EQ(dispatch::parse_tier(dispatch::tier_name(tier)), tier);
+
+    const auto effective = dispatch::force_tier(tier);
+    EXPECT_LE(effective, tier);
+    EXPECT_LE(effective, dispatch::detect_tier());
+    EXPECT_EQ(dispatch::active_tier(), effective);
+  }
+
+  EXPECT_FALSE(dispatch::parse_tier("sse2").has_value());
+  dispatch::reset_tier();
+}
+
+// Test if, rows of pseudorandom matrix A, generated in batches, using
+// multi-lane SHAKE128 kernels of each instruction set tier supported by this
+// CPU, match exactly with the ones generated one row at a time. An odd # -of
+// rows is requested, so that both multi-lane kernels and the single row
+// fallback get exercised.
+template<const size_t n, const size_t len_seed_A, const size_t D>
+void
+test_gen_a_across_tiers()
+{
+  constexpr size_t count = 13;
+  constexpr size_t ridx = 1021;
+
+  std::array<uint8_t, (len_seed_A + 7) / 8> seed{};
+  prng::prng_t prng;
+  prng.read(seed);
+
+  std::vector<zq::zq_t<D>> expected(count * n);
+  for (size_t r = 0; r < count; r++) {
+    gen_a::generate_row<n, len_seed_A, D>(seed, ridx + r, std::span<zq::zq_t<D>, n>(expected.data() + r * n, n));
+  }
+
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    std::vector<zq::zq_t<D>> computed(count * n);
+    gen_a::generate_rows<n, len_seed_A, D, count>(seed, ridx, std::span<zq::zq_t<D>, count * n>(computed));
+
+    EXPECT_EQ(computed, expected);
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, GenARowsAcrossDispatchTiers)
+{
+  test_gen_a_across_tiers<640, 128, 15>();
+  test_gen_a_across_tiers<976, 128, 16>();
+  test_gen_a_across_tiers<1344, 128, 16>();
+}
+
+// Test if, rows of pseudorandom matrix A, generated using AES128, with AES-NI
+// ( if supported by this CPU ), match exactly with the ones generated using
+// bitsliced software AES, which is what scalar tier uses. For n = 976, # -of
+// blocks isn't a multiple of 8, so that the partial block group also gets
+// exercised.
+template<const size_t n, const size_t D>
+void
+test_gen_a_aes_across_tiers()
+{
+  constexpr size_t count = 13;
+  constexpr size_t ridx = 1021;
+
+  std::array<uint8_t, aes128::KEY_LEN> seed{};
+  prng::prng_t prng;
+  prng.read(seed);
+
+  const gen_a::row_generator_t<n, aes128::KEY_LEN * 8, D, gen_a::prg_t::aes128> rowgen(seed);
+
+  dispatch::force_tier(dispatch::tier_t::scalar);
+  EXPECT_FALSE(dispatch::use_aesni());
+
+  std::vector<zq::zq_t<D>> expected(count * n);
+  rowgen.template generate<count>(ridx, std::span<zq::zq_t<D>, count * n>(expected));
+
+  for (const auto tier : { dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    std::vector<zq::zq_t<D>> computed(count * n);
+    rowgen.template generate<count>(ridx, std::span<zq::zq_t<D>, count * n>(computed));
+
+    EXPECT_EQ(computed, expected);
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, GenARowsAESAcrossDispatchTiers)
+{
+  test_gen_a_aes_across_tiers<640, 15>();
+  test_gen_a_aes_across_tiers<976, 16>();
+  test_gen_a_aes_across_tiers<1344, 16>();
+}
+
+// Test if, sampling an error matrix, on each supported instruction set tier,
+// produces exactly same result as the scalar sampler, for every possible 16 -bit
+// random value, while odd shaped matrices fall back to SWAR or scalar path.
+template<size_t n, size_t D>
+void
+test_sampling_across_tiers()
+{
+  constexpr auto Tχ = sampling::cdf_table<n>();
+  constexpr size_t count = 1ul << 16;
+
+  std::vector<uint8_t> r(2 * count);
+  for (size_t i = 0; i < count; i++) {
+    r[2 * i + 0] = static_cast<uint8_t>(i >> 0);
+    r[2 * i + 1] = static_cast<uint8_t>(i >> 8);
+  }
+
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    const auto e = sampling::sample_matrix<n, 256, 256, D>(std::span<const uint8_t, 2 * count>(r));
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(e[i].to_raw(), (sampling::sample<D, Tχ.size(), Tχ>(static_cast<uint16_t>(i))).to_raw());
+    }
+
+    const auto e_odd = sampling::sample_matrix<n, 3, 5, D>(std::span<const uint8_t, 2 * 3 * 5>(r.data() + 2 * 1021, 2 * 3 * 5));
+    for (size_t i = 0; i < 3 * 5; i++) {
+      EXPECT_EQ(e_odd[i].to_raw(), (sampling::sample<D, Tχ.size(), Tχ>(static_cast<uint16_t>(1021 + i))).to_raw());
+    }
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, ErrorSamplingAcrossDispatchTiers)
+{
+  test_sampling_across_tiers<640, 15>();
+  test_sampling_across_tiers<976, 16>();
+  test_sampling_across_tiers<1344, 16>();
+}
+
+// Test if, sampling error matrices straight out of a XOF, in chunks, produces
+// exactly same matrices as squeezing whole digest first and sampling from it,
+// on each supported instruction set tier.
+template<size_t n, size_t n̄, size_t D>
+void
+test_streaming_sampling_across_tiers()
+{
+  constexpr size_t dig_len = 2 * (2 * n * n̄ + n̄ * n̄ + 3 * 5);
+
+  std::array<uint8_t, 32> seed{};
+  prng::prng_t prng;
+  prng.read(seed);
+
+  std::vector<uint8_t> dig(dig_len);
+  {
+    shake256::shake256_t hasher;
+
+    hasher.absorb(seed);
+    hasher.finalize();
+    hasher.squeeze(dig);
+  }
+
+  const std::span<const uint8_t, dig_len> _dig{ dig };
+
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    shake256::shake256_t hasher;
+
+    hasher.absorb(seed);
+    hasher.finalize();
+
+    const auto S = sampling::sample_matrix<n, n̄, n, D>(hasher);
+    const auto E = sampling::sample_matrix<n, n, n̄, D>(hasher);
+    const auto E_dprime = sampling::sample_matrix<n, n̄, n̄, D>(hasher);
+    const auto E_odd = sampling::sample_matrix<n, 3, 5, D>(hasher);
+
+    EXPECT_EQ(S, (sampling::sample_matrix<n, n̄, n, D>(_dig.template subspan<0, 2 * n * n̄>())));
+    EXPECT_EQ(E, (sampling::sample_matrix<n, n, n̄, D>(_dig.template subspan<2 * n * n̄, 2 * n * n̄>())));
+    EXPECT_EQ(E_dprime, (sampling::sample_matrix<n, n̄, n̄, D>(_dig.template subspan<4 * n * n̄, 2 * n̄ * n̄>())));
+    EXPECT_EQ(E_odd, (sampling::sample_matrix<n, 3, 5, D>(_dig.template subspan<4 * n * n̄ + 2 * n̄ * n̄, 2 * 3 * 5>())));
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, StreamingErrorSamplingAcrossDispatchTiers)
+{
+  test_streaming_sampling_across_tiers<640, 8, 15>();
+  test_streaming_sampling_across_tiers<976, 8, 16>();
+  test_streaming_sampling_across_tiers<1344, 8, 16>();
+}
+
+// Test if, 4 XOF instances, absorbed piece by piece and squeezed in lockstep,
+// produce exactly same output as each of them would, on its own, while error
+// matrices sampled out of them, in lockstep, match ones sampled out of each
+// XOF, one by one, on each supported instruction set tier.
+template<size_t n, size_t n̄, size_t D>
+void
+test_lockstep_sampling_across_tiers()
+{
+  constexpr size_t lanes = 4;
+  constexpr size_t msg_len = 401;
+
+  std::array<std::array<uint8_t, msg_len>, lanes> msgs{};
+  prng::prng_t prng;
+
+  for (auto& msg : msgs) {
+    prng.read(msg);
+  }
+
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    kem::internal::xof_x4_t<n> hasher;
+
+    // Pieces straddle block boundaries of both SHAKE128 and SHAKE256.
+    for (const auto& [off, len] : std::array<std::pair<size_t, size_t>, 4>{ { { 0, 1 }, { 1, 0 }, { 1, 200 }, { 201, 200 } } }) {
+      std::array<const uint8_t*, lanes> _msgs{};
+      for (size_t j = 0; j < lanes; j++) {
+        _msgs[j] = msgs[j].data() + off;
+      }
+
+      hasher.absorb(_msgs, len);
+    }
+    hasher.finalize();
+
+    std::array<std::array<uint8_t, 7>, lanes> heads{};
+    std::array<uint8_t*, lanes> outs{};
+
+    for (size_t j = 0; j < lanes; j++) {
+      outs[j] = heads[j].data();
+    }
+    hasher.squeeze(outs, heads[0].size());
+
+    std::array<matrix::matrix<n̄, n, D>, lanes> S{};
+    std::array<matrix::matrix<3, 5, D>, lanes> E_odd{};
+
+    sampling::sample_matrix_x4<n, n̄, n, D>(hasher, std::span(S));
+    sampling::sample_matrix_x4<n, 3, 5, D>(hasher, std::span(E_odd));
+
+    for (size_t j = 0; j < lanes; j++) {
+      kem::internal::xof_t<n> expected;
+
+      expected.absorb(msgs[j]);
+      expected.finalize();
+
+      std::array<uint8_t, heads[0].size()> head{};
+      expected.squeeze(head);
+
+      EXPECT_EQ(heads[j], head);
+      EXPECT_EQ(S[j], (sampling::sample_matrix<n, n̄, n, D>(expected)));
+      EXPECT_EQ(E_odd[j], (sampling::sample_matrix<n, 3, 5, D>(expected)));
+    }
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, LockstepErrorSamplingAcrossDispatchTiers)
+{
+  test_lockstep_sampling_across_tiers<640, 8, 15>();
+  test_lockstep_sampling_across_tiers<976, 8, 16>();
+  test_lockstep_sampling_across_tiers<1344, 8, 16>();
+}
+
+// Test if, multiplying with S, consumed in its transposed form, produces same
+// result as multiplying with explicitly transposed S, on each supported
+// instruction set tier, both for even and odd number of rows.
+template<size_t n, size_t n̄, size_t D>
+void
+test_mul_st_across_tiers()
+{
+  prng::prng_t prng;
+
+  const auto S_transposed = matrix::matrix<n̄, n, D>::random(prng);
+  const auto X = matrix::matrix<n̄, n, D>::random(prng);
+  const auto X_odd = matrix::matrix<3, n, D>::random(prng);
+
+  const auto S = S_transposed.transpose();
+
+  for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) != tier) {
+      continue;
+    }
+
+    EXPECT_EQ((matmul::mul_st<n̄, n, n̄, D>(X, S_transposed)), X * S);
+    EXPECT_EQ((matmul::mul_st<3, n, n̄, D>(X_odd, S_transposed)), X_odd * S);
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, MatrixMulSTransposedAcrossDispatchTiers)
+{
+  test_mul_st_across_tiers<640, 8, 15>();
+  test_mul_st_across_tiers<976, 8, 16>();
+  test_mul_st_across_tiers<1344, 8, 16>();
+}
+
+// Test if, KEM keypair, cipher text and shared secret, computed using kernels of
+// each instruction set tier supported by this CPU, match exactly with the ones
+// computed using scalar kernels.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_kem_across_tiers()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  std::array<uint8_t, len_sec / 8> μ{};
+  std::array<uint8_t, len_salt / 8> salt{};
+
+  prng::prng_t prng;
+
+  const auto seeds = random_keygen_input<len_A, len_sec, len_SE>(prng);
+  prng.read(μ);
+  prng.read(salt);
+
+  // Keypair, cipher text and two shared secrets, one of them from decapsulating
+  // a tampered cipher text.
+  auto run = [&]() {
+    const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(seeds);
+
+    std::vector<uint8_t> enc(ctlen, 0);
+    std::vector<uint8_t> ss(3 * (len_sec / 8), 0);
+
+    std::span<uint8_t, ctlen> _enc{ enc };
+    std::span<uint8_t, len_sec / 8> _ss0{ ss.data(), len_sec / 8 };
+    std::span<uint8_t, len_sec / 8> _ss1{ ss.data() + len_sec / 8, len_sec / 8 };
+    std::span<uint8_t, len_sec / 8> _ss2{ ss.data() + 2 * (len_sec / 8), len_sec / 8 };
+
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, _enc, _ss0);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, _enc, _ss1);
+
+    enc[0] ^= 1;
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, _enc, _ss2);
+    enc[0] ^= 1;
+
+    EXPECT_TRUE(std::ranges::equal(_ss0, _ss1));
+    EXPECT_FALSE(std::ranges::equal(_ss0, _ss2));
+
+    std::vector<uint8_t> res{};
+    res.insert(res.end(), keypair.pkey.begin(), keypair.pkey.end());
+    res.insert(res.end(), keypair.skey.begin(), keypair.skey.end());
+    res.insert(res.end(), enc.begin(), enc.end());
+    res.insert(res.end(), ss.begin(), ss.end());
+    return res;
+  };
+
+  dispatch::force_tier(dispatch::tier_t::scalar);
+  const auto expected = run();
+
+  for (const auto tier : { dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+    if (dispatch::force_tier(tier) == tier) {
+      EXPECT_EQ(run(), expected);
+    }
+  }
+
+  dispatch::reset_tier();
+}
+
+TEST(FrodoKEM, KEMAcrossDispatchTiers)
+{
+  test_kem_across_tiers<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_kem_across_tiers<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_kem_across_tiers<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_kem_across_tiers<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+  test_kem_across_tiers<976, 8, 128, 192, 384, 384, 3, 16, gen_a::prg_t::aes128>();
+  test_kem_across_tiers<1344, 8, 128, 256, 512, 512, 4, 16, gen_a::prg_t::aes128>();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "gen_a.hpp"
+#include "kem.hpp"
+#include "prng.hpp"
+
+// Given a PRNG, this routine samples seeds ( s, seedSE, z ), which a Frodo KEM
+// keypair can be generated from.
+template<const size_t len_A, const size_t len_sec, const size_t len_SE>
+inline kem::keygen_input_t<len_sec, len_SE, len_A>
+random_keygen_input(prng::prng_t& prng)
+{
+  kem::keygen_input_t<len_sec, len_SE, len_A> seeds{};
+
+  prng.read(seeds.s);
+  prng.read(seeds.seedSE);
+  prng.read(seeds.z);
+
+  return seeds;
+}
+
+// Given seeds ( s, seedSE, z ), this routine generates a Frodo KEM keypair from
+// them.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline kem::keypair_t<n, n̄, len_sec, len_A, D>
+make_keypair(const kem::keygen_input_t<len_sec, len_SE, len_A>& seeds)
+{
+  kem::keypair_t<n, n̄, len_sec, len_A, D> keypair{};
+  kem::keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(seeds.s, seeds.seedSE, seeds.z, keypair.pkey, keypair.skey);
+
+  return keypair;
+}
+
+// Given a PRNG, this routine generates a random Frodo KEM keypair.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+inline kem::keypair_t<n, n̄, len_sec, len_A, D>
+make_keypair(prng::prng_t& prng)
+{
+  return make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(random_keygen_input<len_A, len_sec, len_SE>(prng));
+}
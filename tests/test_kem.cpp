@@ -1,7 +1,12 @@
+#include "dispatch.hpp"
+#include "gen_a.hpp"
 #include "kem.hpp"
 #include "prng.hpp"
+#include "test_helper.hpp"
 #include "utils.hpp"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <gtest/gtest.h>
 #include <span>
 #include <vector>
@@ -13,7 +18,15 @@
 // - decapsulating shared secret, using private key
 //
 // works as expected.
-template<const size_t n, const size_t n̄, const size_t len_A, const size_t len_sec, const size_t len_SE, const size_t len_salt, const size_t B, const size_t D>
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
 void
 test_kem()
 {
@@ -55,9 +68,9 @@ test_kem()
 
   using namespace kem;
 
-  keygen<n, n̄, len_sec, len_SE, len_A, B, D>(_s, _seedSE, _z, _pkey, _skey);
-  encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D>(_μ, _salt, _pkey, _enc, _ss0);
-  decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D>(_skey, _enc, _ss1);
+  keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(_s, _seedSE, _z, _pkey, _skey);
+  encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(_μ, _salt, _pkey, _enc, _ss0);
+  decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(_skey, _enc, _ss1);
 
   EXPECT_EQ(ss0, ss1);
 }
@@ -71,3 +84,637 @@ TEST(FrodoKEM, KeygenEncapsDecaps)
   test_kem<1344, 8, 128, 256, 256, 0, 4, 16>();
   test_kem<1344, 8, 128, 256, 512, 512, 4, 16>();
 }
+
+TEST(FrodoKEM, KeygenEncapsDecapsAES)
+{
+  constexpr auto aes = gen_a::prg_t::aes128;
+
+  test_kem<640, 8, 128, 128, 128, 0, 2, 15, aes>();
+  test_kem<640, 8, 128, 128, 256, 256, 2, 15, aes>();
+  test_kem<976, 8, 128, 192, 192, 0, 3, 16, aes>();
+  test_kem<976, 8, 128, 192, 384, 384, 3, 16, aes>();
+  test_kem<1344, 8, 128, 256, 256, 0, 4, 16, aes>();
+  test_kem<1344, 8, 128, 256, 512, 512, 4, 16, aes>();
+}
+
+// Test if, encapsulating using a prepared public key produces exactly same cipher
+// text and shared secret as encapsulating using serialized public key, while
+// the prepared key is shared by many encapsulations.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_encaps_with_prepared_public_key()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t rounds = 4;
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  const kem::prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(keypair.pkey);
+
+  for (size_t i = 0; i < rounds; i++) {
+    std::array<uint8_t, len_sec / 8> μ{};
+    std::array<uint8_t, len_salt / 8> salt{};
+
+    prng.read(μ);
+    prng.read(salt);
+
+    std::vector<uint8_t> enc0(ctlen, 0), enc1(ctlen, 0);
+    std::array<uint8_t, len_sec / 8> ss0{}, ss1{}, ss2{};
+
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, std::span<uint8_t, ctlen>(enc0), ss0);
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, std::span<uint8_t, ctlen>(enc1), ss1);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, std::span<uint8_t, ctlen>(enc1), ss2);
+
+    EXPECT_EQ(enc0, enc1);
+    EXPECT_EQ(ss0, ss1);
+    EXPECT_EQ(ss1, ss2);
+  }
+}
+
+TEST(FrodoKEM, EncapsWithPreparedPublicKey)
+{
+  test_encaps_with_prepared_public_key<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_encaps_with_prepared_public_key<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_encaps_with_prepared_public_key<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_encaps_with_prepared_public_key<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_encaps_with_prepared_public_key<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, encapsulating a batch of inputs to a public key, in a single pass
+// over matrix A, produces exactly same cipher texts and shared secrets as
+// encapsulating them one by one, for various batch sizes.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_batch_encaps()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  const kem::prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(keypair.pkey);
+
+  for (const size_t count : { 0ul, 1ul, 3ul, 8ul }) {
+    std::vector<kem::encaps_input_t<len_sec, len_salt>> inputs(count);
+    std::vector<kem::encaps_output_t<n, n̄, len_sec, len_salt, D>> outputs0(count), outputs1(count);
+
+    for (auto& input : inputs) {
+      prng.read(input.μ);
+      prng.read(input.salt);
+    }
+
+    const auto _inputs = std::span<const kem::encaps_input_t<len_sec, len_salt>>(inputs);
+
+    EXPECT_EQ((kem::batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(ppk, _inputs, std::span(outputs0))), count);
+    EXPECT_EQ((kem::batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.pkey, _inputs, std::span(outputs1))), count);
+
+    // Mismatching lengths only process the shorter one.
+    if (count > 0) {
+      std::vector<kem::encaps_output_t<n, n̄, len_sec, len_salt, D>> outputs2(count);
+
+      EXPECT_EQ((kem::batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(ppk, _inputs, std::span(outputs2).first(count - 1))), count - 1);
+      EXPECT_EQ((kem::batch_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(ppk, _inputs.first(count - 1), std::span(outputs2))), count - 1);
+      EXPECT_EQ(outputs2.back().enc, decltype(outputs2.back().enc){});
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      std::array<uint8_t, ctlen> enc{};
+      std::array<uint8_t, len_sec / 8> ss0{}, ss1{};
+
+      kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(inputs[i].μ, inputs[i].salt, ppk, enc, ss0);
+      kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, outputs0[i].enc, ss1);
+
+      EXPECT_EQ(outputs0[i].enc, enc);
+      EXPECT_EQ(outputs0[i].ss, ss0);
+      EXPECT_EQ(outputs1[i].enc, enc);
+      EXPECT_EQ(outputs1[i].ss, ss0);
+      EXPECT_EQ(ss1, ss0);
+    }
+  }
+}
+
+TEST(FrodoKEM, BatchEncaps)
+{
+  test_batch_encaps<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_batch_encaps<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_batch_encaps<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_batch_encaps<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_batch_encaps<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, encapsulating to a batch of distinct public keys, 4 at a time, in
+// lockstep, produces exactly same cipher texts and shared secrets as
+// encapsulating to them one by one, for various batch sizes and on all
+// supported instruction set tiers.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_multi_encaps()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t pklen = utils::kem_pub_key_len(n, n̄, len_A, D);
+
+  using keypair_t = kem::keypair_t<n, n̄, len_sec, len_A, D>;
+  using encaps_input_t = kem::encaps_input_t<len_sec, len_salt>;
+  using encaps_output_t = kem::encaps_output_t<n, n̄, len_sec, len_salt, D>;
+
+  prng::prng_t prng;
+
+  for (const size_t count : { 0ul, 1ul, 4ul, 6ul }) {
+    std::vector<keypair_t> keypairs(count);
+    std::vector<std::span<const uint8_t, pklen>> pkeys{};
+    std::vector<encaps_input_t> inputs(count);
+    std::vector<encaps_output_t> expected(count);
+
+    for (size_t i = 0; i < count; i++) {
+      keypairs[i] = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+      pkeys.emplace_back(keypairs[i].pkey);
+
+      prng.read(inputs[i].μ);
+      prng.read(inputs[i].salt);
+
+      kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(inputs[i].μ, inputs[i].salt, pkeys[i], expected[i].enc, expected[i].ss);
+    }
+
+    for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+      if (dispatch::force_tier(tier) != tier) {
+        continue;
+      }
+
+      std::vector<encaps_output_t> computed(count);
+      EXPECT_EQ((kem::multi_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(
+                  std::span<const std::span<const uint8_t, pklen>>(pkeys), std::span<const encaps_input_t>(inputs), std::span(computed))),
+                count);
+
+      for (size_t i = 0; i < count; i++) {
+        std::array<uint8_t, len_sec / 8> ss{};
+        kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypairs[i].skey, computed[i].enc, ss);
+
+        EXPECT_EQ(computed[i].enc, expected[i].enc);
+        EXPECT_EQ(computed[i].ss, expected[i].ss);
+        EXPECT_EQ(ss, expected[i].ss);
+      }
+
+      // Same, carving intermediate values out of a caller-owned workspace.
+      if (count >= 4) {
+        constexpr size_t wslen = kem::encaps_x4_workspace_len<n, n̄, D>();
+        std::vector<uint8_t> workspace(wslen, 0xa5);
+        std::vector<encaps_output_t> computed_ws(4);
+
+        kem::encaps_x4<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(std::span<const std::span<const uint8_t, pklen>>(pkeys).template first<4>(),
+                                                                          std::span<const encaps_input_t>(inputs).template first<4>(),
+                                                                          std::span(computed_ws).template first<4>(),
+                                                                          std::span<uint8_t, wslen>(workspace));
+
+        for (size_t i = 0; i < 4; i++) {
+          EXPECT_EQ(computed_ws[i].enc, expected[i].enc);
+          EXPECT_EQ(computed_ws[i].ss, expected[i].ss);
+        }
+      }
+    }
+
+    dispatch::reset_tier();
+
+    // Mismatching lengths only process the shortest one.
+    if (count > 0) {
+      const auto pkeys_span = std::span<const std::span<const uint8_t, pklen>>(pkeys);
+      const auto inputs_span = std::span<const encaps_input_t>(inputs);
+      std::vector<encaps_output_t> computed(count);
+
+      EXPECT_EQ((kem::multi_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(pkeys_span.first(count - 1), inputs_span, std::span(computed))), count - 1);
+      EXPECT_EQ((kem::multi_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(pkeys_span, inputs_span.first(count - 1), std::span(computed))), count - 1);
+      EXPECT_EQ((kem::multi_encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(pkeys_span, inputs_span, std::span(computed).first(count - 1))), count - 1);
+
+      for (size_t i = 0; i + 1 < count; i++) {
+        EXPECT_EQ(computed[i].enc, expected[i].enc);
+        EXPECT_EQ(computed[i].ss, expected[i].ss);
+      }
+      EXPECT_EQ(computed.back().ss, encaps_output_t{}.ss);
+    }
+  }
+}
+
+TEST(FrodoKEM, MultiEncaps)
+{
+  test_multi_encaps<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_multi_encaps<976, 8, 128, 192, 192, 0, 3, 16>();
+  test_multi_encaps<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_multi_encaps<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_multi_encaps<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_multi_encaps<640, 8, 128, 128, 128, 0, 2, 15, gen_a::prg_t::aes128>();
+  test_multi_encaps<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, generating a batch of keypairs, 4 at a time, in lockstep, produces
+// exactly same public and secret keys as generating them one by one, for
+// various batch sizes and on all supported instruction set tiers.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_batch_keygen()
+{
+  using keygen_input_t = kem::keygen_input_t<len_sec, len_SE, len_A>;
+  using keypair_t = kem::keypair_t<n, n̄, len_sec, len_A, D>;
+
+  prng::prng_t prng;
+
+  for (const size_t count : { 0ul, 1ul, 4ul, 7ul }) {
+    std::vector<keygen_input_t> inputs(count);
+    std::vector<keypair_t> expected(count);
+
+    for (size_t i = 0; i < count; i++) {
+      inputs[i] = random_keygen_input<len_A, len_sec, len_SE>(prng);
+      expected[i] = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(inputs[i]);
+    }
+
+    for (const auto tier : { dispatch::tier_t::scalar, dispatch::tier_t::avx2, dispatch::tier_t::avx512bw }) {
+      if (dispatch::force_tier(tier) != tier) {
+        continue;
+      }
+
+      std::vector<keypair_t> computed(count);
+      EXPECT_EQ((kem::batch_keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(std::span<const keygen_input_t>(inputs), std::span(computed))), count);
+
+      for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(computed[i].pkey, expected[i].pkey);
+        EXPECT_EQ(computed[i].skey, expected[i].skey);
+      }
+
+      // Same, carving intermediate values out of a caller-owned workspace.
+      if (count >= 4) {
+        constexpr size_t wslen = kem::keygen_x4_workspace_len<n, n̄, D>();
+        std::vector<uint8_t> workspace(wslen, 0xa5);
+        std::vector<keypair_t> computed_ws(4);
+
+        kem::keygen_x4<n, n̄, len_sec, len_SE, len_A, B, D, prg>(
+          std::span<const keygen_input_t>(inputs).template first<4>(), std::span(computed_ws).template first<4>(), std::span<uint8_t, wslen>(workspace));
+
+        for (size_t i = 0; i < 4; i++) {
+          EXPECT_EQ(computed_ws[i].pkey, expected[i].pkey);
+          EXPECT_EQ(computed_ws[i].skey, expected[i].skey);
+        }
+      }
+    }
+
+    dispatch::reset_tier();
+
+    // Mismatching lengths only process the shorter one.
+    if (count > 0) {
+      std::vector<keypair_t> computed(count);
+
+      EXPECT_EQ((kem::batch_keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(std::span<const keygen_input_t>(inputs), std::span(computed).first(count - 1))), count - 1);
+      EXPECT_EQ((kem::batch_keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(std::span<const keygen_input_t>(inputs).first(count - 1), std::span(computed))), count - 1);
+
+      for (size_t i = 0; i + 1 < count; i++) {
+        EXPECT_EQ(computed[i].pkey, expected[i].pkey);
+        EXPECT_EQ(computed[i].skey, expected[i].skey);
+      }
+      EXPECT_EQ(computed.back().pkey, keypair_t{}.pkey);
+    }
+  }
+}
+
+TEST(FrodoKEM, BatchKeygen)
+{
+  test_batch_keygen<640, 8, 128, 128, 256, 2, 15>();
+  test_batch_keygen<976, 8, 128, 192, 384, 3, 16>();
+  test_batch_keygen<1344, 8, 128, 256, 512, 4, 16>();
+  test_batch_keygen<640, 8, 128, 128, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, decapsulating using a prepared secret key recovers exactly same
+// shared secret as decapsulating using serialized secret key, both for valid
+// and tampered cipher texts, while the prepared key is shared by many
+// decapsulations.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_decaps_with_prepared_secret_key()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t rounds = 4;
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(keypair.skey);
+
+  for (size_t i = 0; i < rounds; i++) {
+    std::array<uint8_t, len_sec / 8> μ{};
+    std::array<uint8_t, len_salt / 8> salt{};
+
+    prng.read(μ);
+    prng.read(salt);
+
+    std::vector<uint8_t> enc(ctlen, 0);
+    std::span<uint8_t, ctlen> _enc{ enc };
+    std::array<uint8_t, len_sec / 8> ss0{}, ss1{}, ss2{};
+
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, _enc, ss0);
+
+    // Tamper with cipher text, every other round, exercising implicit rejection.
+    enc[i % ctlen] ^= static_cast<uint8_t>(i & 1);
+
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, _enc, ss1);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, _enc, ss2);
+
+    EXPECT_EQ(ss1, ss2);
+    EXPECT_EQ(ss0 == ss2, (i & 1) == 0);
+  }
+}
+
+TEST(FrodoKEM, DecapsWithPreparedSecretKey)
+{
+  test_decaps_with_prepared_secret_key<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_decaps_with_prepared_secret_key<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_decaps_with_prepared_secret_key<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_decaps_with_prepared_secret_key<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_decaps_with_prepared_secret_key<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, decapsulating a batch of cipher texts, some of them tampered with,
+// in a single pass over matrix A, recovers exactly same shared secrets as
+// decapsulating them one by one, for various batch sizes.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_batch_decaps()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+
+  const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(keypair.skey);
+
+  for (const size_t count : { 0ul, 1ul, 3ul, 8ul }) {
+    std::vector<std::array<uint8_t, ctlen>> encs(count);
+    std::vector<std::array<uint8_t, len_sec / 8>> sss0(count), sss1(count), sss2(count);
+
+    for (size_t i = 0; i < count; i++) {
+      std::array<uint8_t, len_sec / 8> μ{};
+      std::array<uint8_t, len_salt / 8> salt{};
+
+      prng.read(μ);
+      prng.read(salt);
+
+      kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, encs[i], sss0[i]);
+
+      // Tamper with every other cipher text, exercising implicit rejection.
+      encs[i][(i * 97) % ctlen] ^= static_cast<uint8_t>(i & 1);
+    }
+
+    std::vector<std::span<const uint8_t, ctlen>> _encs(encs.begin(), encs.end());
+    std::vector<std::span<uint8_t, len_sec / 8>> _sss1(sss1.begin(), sss1.end());
+    std::vector<std::span<uint8_t, len_sec / 8>> _sss2(sss2.begin(), sss2.end());
+
+    EXPECT_EQ((kem::batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, _encs, _sss1)), count);
+    EXPECT_EQ((kem::batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, _encs, _sss2)), count);
+
+    // Mismatching lengths only process the shorter one.
+    if (count > 0) {
+      std::vector<std::array<uint8_t, len_sec / 8>> sss3(count);
+      std::vector<std::span<uint8_t, len_sec / 8>> _sss3(sss3.begin(), sss3.end());
+
+      const auto encs_span = std::span<const std::span<const uint8_t, ctlen>>(_encs);
+      const auto sss_span = std::span<const std::span<uint8_t, len_sec / 8>>(_sss3);
+
+      EXPECT_EQ((kem::batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, encs_span, sss_span.first(count - 1))), count - 1);
+      EXPECT_EQ((kem::batch_decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, encs_span.first(count - 1), sss_span)), count - 1);
+      EXPECT_EQ(sss3.back(), (std::array<uint8_t, len_sec / 8>{}));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      std::array<uint8_t, len_sec / 8> ss{};
+      kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, encs[i], ss);
+
+      EXPECT_EQ(sss1[i], ss);
+      EXPECT_EQ(sss2[i], ss);
+      EXPECT_EQ(sss0[i] == ss, (i & 1) == 0);
+    }
+  }
+}
+
+TEST(FrodoKEM, BatchDecaps)
+{
+  test_batch_decaps<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_batch_decaps<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_batch_decaps<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_batch_decaps<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_batch_decaps<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, generating keypairs, encapsulating and decapsulating using a single,
+// caller-owned workspace, reused across all calls, produces exactly same keys,
+// cipher texts and shared secrets as keeping intermediate matrices on stack.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_kem_with_workspace()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t rounds = 4;
+  constexpr size_t pklen = utils::kem_pub_key_len(n, n̄, len_A, D);
+  constexpr size_t sklen = utils::kem_sec_key_len(n, n̄, len_sec, len_A, D);
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+
+  constexpr size_t kg_wslen = kem::keygen_workspace_len<n, n̄, D>();
+  constexpr size_t enc_wslen = kem::encaps_workspace_len<n, n̄, D>();
+  constexpr size_t dec_wslen = kem::decaps_workspace_len<n, n̄, len_sec, len_A, D, prg>();
+
+  // Heap allocations are aligned to `alignof(std::max_align_t)`. Workspace is
+  // dirty, to begin with, as it'd be, when reused.
+  std::vector<uint8_t> workspace(std::max({ kg_wslen, enc_wslen, dec_wslen }), 0xa5);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(workspace.data()) % kem::WORKSPACE_ALIGNMENT, 0u);
+
+  const auto kg_ws = std::span(workspace).template first<kg_wslen>();
+  const auto enc_ws = std::span(workspace).template first<enc_wslen>();
+  const auto dec_ws = std::span(workspace).template first<dec_wslen>();
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < rounds; i++) {
+    const auto seeds = random_keygen_input<len_A, len_sec, len_SE>(prng);
+
+    std::array<uint8_t, len_sec / 8> μ{};
+    std::array<uint8_t, len_salt / 8> salt{};
+
+    prng.read(μ);
+    prng.read(salt);
+
+    std::vector<uint8_t> pkey1(pklen, 0);
+    std::vector<uint8_t> skey1(sklen, 0);
+    std::vector<uint8_t> enc0(ctlen, 0), enc1(ctlen, 0), enc2(ctlen, 0);
+    std::array<uint8_t, len_sec / 8> ss0{}, ss1{}, ss2{}, ss3{}, ss4{}, ss5{};
+
+    std::span<uint8_t, pklen> _pkey1{ pkey1 };
+    std::span<uint8_t, sklen> _skey1{ skey1 };
+    std::span<uint8_t, ctlen> _enc0{ enc0 }, _enc1{ enc1 }, _enc2{ enc2 };
+
+    const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(seeds);
+    kem::keygen<n, n̄, len_sec, len_SE, len_A, B, D, prg>(seeds.s, seeds.seedSE, seeds.z, _pkey1, _skey1, kg_ws);
+
+    EXPECT_TRUE(std::ranges::equal(keypair.pkey, pkey1));
+    EXPECT_TRUE(std::ranges::equal(keypair.skey, skey1));
+
+    const kem::prepared_public_key<n, n̄, len_sec, len_A, D, prg> ppk(_pkey1);
+
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, _enc0, ss0);
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, _pkey1, _enc1, ss1, enc_ws);
+    kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, ppk, _enc2, ss2, enc_ws);
+
+    EXPECT_EQ(enc0, enc1);
+    EXPECT_EQ(enc0, enc2);
+    EXPECT_EQ(ss0, ss1);
+    EXPECT_EQ(ss0, ss2);
+
+    // Tamper with cipher text, every other round, exercising implicit rejection.
+    enc1[i % ctlen] ^= static_cast<uint8_t>(i & 1);
+
+    const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(_skey1);
+
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(keypair.skey, _enc1, ss3);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(_skey1, _enc1, ss4, dec_ws);
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, _enc1, ss5, dec_ws);
+
+    EXPECT_EQ(ss3, ss4);
+    EXPECT_EQ(ss3, ss5);
+    EXPECT_EQ(ss0 == ss3, (i & 1) == 0);
+  }
+}
+
+TEST(FrodoKEM, KEMWithWorkspace)
+{
+  test_kem_with_workspace<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_kem_with_workspace<640, 8, 128, 128, 256, 256, 2, 15>();
+  test_kem_with_workspace<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_kem_with_workspace<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_kem_with_workspace<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
+
+// Test if, flipping any single bit of packed matrix C, in cipher text, gets
+// decapsulation to implicitly reject it, no matter which element of C or which
+// of its bits it touches, as re-encrypted C' is compared in packed form.
+template<const size_t n,
+         const size_t n̄,
+         const size_t len_A,
+         const size_t len_sec,
+         const size_t len_SE,
+         const size_t len_salt,
+         const size_t B,
+         const size_t D,
+         const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_decaps_rejects_tampered_c()
+{
+  namespace utils = frodo_utils;
+
+  constexpr size_t ctlen = utils::kem_cipher_text_len(n, n̄, len_salt, D);
+  constexpr size_t c_off = (n̄ * n * D) / 8;
+  constexpr size_t c_len = (n̄ * n̄ * D) / 8;
+
+  std::array<uint8_t, len_sec / 8> μ{};
+  std::array<uint8_t, len_salt / 8> salt{};
+
+  prng::prng_t prng;
+
+  const auto keypair = make_keypair<n, n̄, len_A, len_sec, len_SE, B, D, prg>(prng);
+  prng.read(μ);
+  prng.read(salt);
+
+  std::vector<uint8_t> enc(ctlen, 0);
+  std::array<uint8_t, len_sec / 8> ss0{}, ss1{};
+
+  std::span<uint8_t, ctlen> _enc{ enc };
+
+  kem::encaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(μ, salt, keypair.pkey, _enc, ss0);
+
+  const kem::prepared_secret_key<n, n̄, len_sec, len_A, D, prg> psk(keypair.skey);
+
+  kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, _enc, ss1);
+  EXPECT_EQ(ss0, ss1);
+
+  // Touches every byte of C, each time at a different bit position.
+  for (size_t i = 0; i < c_len; i++) {
+    const auto bit = static_cast<uint8_t>(1u << (i % 8));
+
+    enc[c_off + i] ^= bit;
+    kem::decaps<n, n̄, len_sec, len_SE, len_A, len_salt, B, D, prg>(psk, _enc, ss1);
+    enc[c_off + i] ^= bit;
+
+    EXPECT_NE(ss0, ss1);
+  }
+}
+
+TEST(FrodoKEM, DecapsRejectsTamperedC)
+{
+  test_decaps_rejects_tampered_c<640, 8, 128, 128, 128, 0, 2, 15>();
+  test_decaps_rejects_tampered_c<976, 8, 128, 192, 384, 384, 3, 16>();
+  test_decaps_rejects_tampered_c<1344, 8, 128, 256, 512, 512, 4, 16>();
+  test_decaps_rejects_tampered_c<640, 8, 128, 128, 256, 256, 2, 15, gen_a::prg_t::aes128>();
+}
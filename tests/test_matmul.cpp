@@ -0,0 +1,124 @@
+#include "gen_a.hpp"
+#include "matmul.hpp"
+#include "matrix.hpp"
+#include "packing.hpp"
+#include "prng.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Test if, computing B = A * S + E, while streaming rows of A and consuming S in
+// its transposed form, produces same result as materializing full n x n matrix
+// A and then multiplying, both when B is returned and when it's packed as it's
+// computed.
+template<const size_t n, const size_t n̄, const size_t len_seed_A, const size_t D, const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_a_mul_s_add_e()
+{
+  prng::prng_t prng;
+
+  std::array<uint8_t, (len_seed_A + 7) / 8> seed{};
+  prng.read(seed);
+
+  auto S_transposed = matrix::matrix<n̄, n, D>::random(prng);
+  auto E = matrix::matrix<n, n̄, D>::random(prng);
+
+  auto A = matrix::matrix<n, n, D>::template generate<len_seed_A, prg>(seed);
+  auto expected = A * S_transposed.transpose() + E;
+  auto computed = matmul::a_mul_st_add_e<n, n̄, len_seed_A, D, prg>(seed, S_transposed, E);
+
+  EXPECT_EQ(expected, computed);
+
+  std::vector<uint8_t> expected_bytes((n * n̄ * D) / 8, 0);
+  std::vector<uint8_t> computed_bytes((n * n̄ * D) / 8, 0);
+  std::array<zq::zq_t<D>, matmul::A_ROWS_PER_BLOCK * n> a_rows{};
+
+  packing::pack(computed, std::span<uint8_t, (n * n̄ * D) / 8>(expected_bytes));
+  matmul::a_mul_st_add_e<n, n̄, len_seed_A, D, prg>(seed, S_transposed, E, std::span<uint8_t, (n * n̄ * D) / 8>(computed_bytes), a_rows);
+
+  EXPECT_EQ(expected_bytes, computed_bytes);
+}
+
+TEST(FrodoKEM, MatrixStreamingASPlusE)
+{
+  test_a_mul_s_add_e<640, 8, 128, 15>();
+  test_a_mul_s_add_e<976, 8, 128, 16>();
+  test_a_mul_s_add_e<1344, 8, 128, 16>();
+  test_a_mul_s_add_e<640, 8, 128, 15, gen_a::prg_t::aes128>();
+  test_a_mul_s_add_e<976, 8, 128, 16, gen_a::prg_t::aes128>();
+  test_a_mul_s_add_e<1344, 8, 128, 16, gen_a::prg_t::aes128>();
+}
+
+// Test if, computing B' = S' * A + E', while streaming rows of A and
+// accumulating them into all rows of B', produces same result as materializing
+// full n x n matrix A and then multiplying.
+template<const size_t n, const size_t n̄, const size_t len_seed_A, const size_t D, const gen_a::prg_t prg = gen_a::prg_t::shake128>
+void
+test_s_mul_a_add_e()
+{
+  prng::prng_t prng;
+
+  std::array<uint8_t, (len_seed_A + 7) / 8> seed{};
+  prng.read(seed);
+
+  auto S_prime = matrix::matrix<n̄, n, D>::random(prng);
+  auto E_prime = matrix::matrix<n̄, n, D>::random(prng);
+
+  auto A = matrix::matrix<n, n, D>::template generate<len_seed_A, prg>(seed);
+  auto expected = S_prime * A + E_prime;
+  auto computed = matmul::s_mul_a_add_e<n, n̄, len_seed_A, D, prg>(seed, S_prime, E_prime);
+
+  EXPECT_EQ(expected, computed);
+}
+
+TEST(FrodoKEM, MatrixStreamingSAPlusE)
+{
+  test_s_mul_a_add_e<640, 8, 128, 15>();
+  test_s_mul_a_add_e<976, 8, 128, 16>();
+  test_s_mul_a_add_e<1344, 8, 128, 16>();
+  test_s_mul_a_add_e<640, 8, 128, 15, gen_a::prg_t::aes128>();
+  test_s_mul_a_add_e<976, 8, 128, 16, gen_a::prg_t::aes128>();
+  test_s_mul_a_add_e<1344, 8, 128, 16, gen_a::prg_t::aes128>();
+}
+
+// Test if, multiplying with a matrix, which is read straight out of its packed
+// form ( i.e. B' * S and S' * B ), produces same result as unpacking it first,
+// while constant-time comparison against packed form agrees with unpacked one.
+template<const size_t n, const size_t n̄, const size_t D>
+void
+test_mul_packed()
+{
+  prng::prng_t prng;
+
+  auto S_transposed = matrix::matrix<n̄, n, D>::random(prng);
+  auto S_prime = matrix::matrix<n̄, n, D>::random(prng);
+  auto B_prime = matrix::matrix<n̄, n, D>::random(prng);
+  auto B_mat = matrix::matrix<n, n̄, D>::random(prng);
+
+  std::vector<uint8_t> B_prime_bytes((n̄ * n * D) / 8, 0);
+  std::vector<uint8_t> B_mat_bytes((n * n̄ * D) / 8, 0);
+
+  const auto _B_prime_bytes = std::span<uint8_t, (n̄ * n * D) / 8>(B_prime_bytes);
+  const auto _B_mat_bytes = std::span<uint8_t, (n * n̄ * D) / 8>(B_mat_bytes);
+
+  packing::pack(B_prime, _B_prime_bytes);
+  packing::pack(B_mat, _B_mat_bytes);
+
+  const packing::packed_t<n̄, n, D> B_prime_packed{ _B_prime_bytes };
+  const packing::packed_t<n, n̄, D> B_mat_packed{ _B_mat_bytes };
+
+  EXPECT_EQ((matmul::mul_packed_st<n̄, n, n̄, D>(B_prime_packed, S_transposed)), (matmul::mul_st<n̄, n, n̄, D>(B_prime, S_transposed)));
+  EXPECT_EQ((matmul::mul_packed<n̄, n, n̄, D>(S_prime, B_mat_packed)), (matrix::matrix<n̄, n̄, D>(S_prime * B_mat)));
+
+  EXPECT_EQ(B_prime_packed.ct_equal(B_prime), -1u);
+  B_prime[n - 1] = B_prime[n - 1] + zq::zq_t<D>(1);
+  EXPECT_EQ(B_prime_packed.ct_equal(B_prime), 0u);
+}
+
+TEST(FrodoKEM, MatrixMulPacked)
+{
+  test_mul_packed<640, 8, 15>();
+  test_mul_packed<976, 8, 16>();
+  test_mul_packed<1344, 8, 16>();
+}
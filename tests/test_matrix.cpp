@@ -1,7 +1,15 @@
 #include "matrix.hpp"
+#include "packing.hpp"
 #include "prng.hpp"
 #include "zq.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
 
 // Test if, given a matrix of dimension m x n, it can correctly be transposed
 // into a matrix of dimension n x m.
@@ -50,3 +58,158 @@ TEST(FrodoKEM, MatrixAddSub)
   test_matrix_add_sub<8, 8, 15>();
   test_matrix_add_sub<8, 8, 16>();
 }
+
+// Test if, a fused matrix expression, evaluated row by row straight into the
+// destination matrix, produces same result as evaluating each operation into
+// its own matrix, element by element, while expressions bound to `auto`
+// variables keep temporaries alive.
+template<const size_t m, const size_t n, const size_t D>
+void
+test_matrix_expression()
+{
+  prng::prng_t prng;
+
+  auto S_prime = matrix::matrix<m, n, D>::random(prng);
+  auto B_mat = matrix::matrix<n, m, D>::random(prng);
+  auto E_dprime = matrix::matrix<m, m, D>::random(prng);
+  auto M = matrix::matrix<m, m, D>::random(prng);
+
+  matrix::matrix<m, m, D> expected{};
+  for (size_t i = 0; i < m; i++) {
+    for (size_t j = 0; j < m; j++) {
+      zq::zq_t<D> acc = E_dprime[{ i, j }] - M[{ i, j }];
+
+      for (size_t k = 0; k < n; k++) {
+        acc += S_prime[{ i, k }] * B_mat[{ k, j }];
+      }
+
+      expected[{ i, j }] = acc;
+    }
+  }
+
+  const matrix::matrix<m, m, D> fused = S_prime * B_mat + E_dprime - M;
+  EXPECT_EQ(fused, expected);
+
+  const matrix::matrix<m, m, D> negated = M - (S_prime * B_mat + E_dprime);
+  EXPECT_EQ(negated + expected, (matrix::matrix<m, m, D>{}));
+
+  const auto lazy = S_prime * B_mat.transpose().transpose() + (E_dprime - M);
+  EXPECT_EQ(lazy, expected);
+}
+
+TEST(FrodoKEM, MatrixExpression)
+{
+  test_matrix_expression<8, 640, 15>();
+  test_matrix_expression<8, 976, 16>();
+  test_matrix_expression<8, 1344, 16>();
+}
+
+// Memory resource, counting allocations it serves from upstream resource.
+struct counting_resource_t : std::pmr::memory_resource
+{
+  size_t allocations = 0;
+  size_t live = 0;
+
+private:
+  void* do_allocate(const size_t bytes, const size_t alignment) override
+  {
+    allocations++;
+    live++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* const ptr, const size_t bytes, const size_t alignment) override
+  {
+    live--;
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Test if, a heap matrix generated, deserialized, unpacked or evaluated from an
+// expression, into uninitialized, 64 -bytes aligned storage, holds exactly same
+// elements as a matrix, while moving it keeps its storage and copying it doesn't.
+template<const size_t m, const size_t n, const size_t D>
+void
+test_heap_matrix()
+{
+  prng::prng_t prng;
+  counting_resource_t res{};
+
+  std::array<uint8_t, 16> seed{};
+  prng.read(seed);
+
+  const auto A = matrix::heap_matrix<n, n, D>::template generate<128>(seed, &res);
+  const auto A_ = matrix::matrix<n, n, D>::template generate<128>(seed);
+
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(A.data()) % matrix::HEAP_ALIGNMENT, 0u);
+  EXPECT_EQ(A.resource(), &res);
+  EXPECT_EQ(res.allocations, 1u);
+  EXPECT_TRUE(std::equal(A.data(), A.data() + n * n, A_.data()));
+
+  // Moving transfers storage, without allocating.
+  auto S_prime = matrix::heap_matrix<m, n, D>::random(prng, &res);
+  const auto ptr = S_prime.data();
+
+  auto S_moved = std::move(S_prime);
+  EXPECT_EQ(S_moved.data(), ptr);
+  EXPECT_EQ(res.allocations, 2u);
+
+  // Copying allocates, from default resource, unless asked otherwise.
+  const auto S_copy = S_moved;
+  const matrix::heap_matrix<m, n, D> S_copy_(S_moved, &res);
+
+  EXPECT_EQ(S_copy.resource(), std::pmr::get_default_resource());
+  EXPECT_EQ(S_copy_.resource(), &res);
+  EXPECT_EQ(res.allocations, 3u);
+  EXPECT_NE(S_copy.data(), S_moved.data());
+  EXPECT_EQ(S_copy, S_moved);
+  EXPECT_EQ(S_copy_.ct_equal(S_moved), -1u);
+
+  // Move assignment across memory resources copies elements.
+  matrix::heap_matrix<m, n, D> S_other{};
+  const auto other_ptr = S_other.data();
+
+  EXPECT_EQ(S_other, (matrix::heap_matrix<m, n, D>{}));
+  S_other = std::move(S_moved);
+  EXPECT_EQ(S_other.data(), other_ptr);
+  EXPECT_EQ(S_other, S_copy);
+
+  // Serialization round trip.
+  std::vector<uint8_t> bytes(m * n * 2, 0);
+  auto _bytes = std::span<uint8_t, m * n * 2>(bytes);
+
+  S_copy.write_as_le_bytes(_bytes);
+  EXPECT_EQ((matrix::heap_matrix<m, n, D>::read_from_le_bytes(_bytes)), S_copy);
+
+  // Unpacking into uninitialized storage.
+  std::vector<uint8_t> packed((m * n * D + 7) / 8, 0);
+  auto _packed = std::span<uint8_t, (m * n * D + 7) / 8>(packed);
+
+  const matrix::matrix<m, n, D> S_stack = S_copy;
+  packing::pack(S_stack, _packed);
+
+  matrix::heap_matrix<m, n, D> S_unpacked(matrix::uninitialized, &res);
+  packing::unpack<m, n, D>(_packed, S_unpacked);
+  EXPECT_EQ((matrix::matrix<m, n, D>(S_unpacked)), (packing::unpack<m, n, D>(_packed)));
+
+  // Matrix expressions mixing heap and inline matrices.
+  const auto B_mat = matrix::heap_matrix<n, m, D>::random(prng);
+  const auto E_dprime = matrix::matrix<m, m, D>::random(prng);
+
+  const matrix::matrix<m, m, D> expected = S_stack * matrix::matrix<n, m, D>(B_mat) + E_dprime;
+  const matrix::matrix<m, m, D> mixed = S_copy * B_mat + E_dprime;
+  const matrix::heap_matrix<m, m, D> on_heap(E_dprime + S_copy * B_mat, &res);
+
+  EXPECT_EQ(mixed, expected);
+  EXPECT_EQ((matrix::matrix<m, m, D>(on_heap)), expected);
+  EXPECT_EQ(res.live, 5u);
+}
+
+TEST(FrodoKEM, HeapMatrix)
+{
+  test_heap_matrix<8, 640, 15>();
+  test_heap_matrix<8, 976, 16>();
+  test_heap_matrix<8, 1344, 16>();
+}
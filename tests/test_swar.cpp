@@ -0,0 +1,97 @@
+#include "prng.hpp"
+#include "sampling.hpp"
+#include "swar.hpp"
+#include "zq.hpp"
+#include <array>
+#include <gtest/gtest.h>
+
+// Test if, lane-wise SWAR addition, subtraction and multiplication ( eager and
+// lazily reduced ) produce exactly same results as scalar Zq arithmetic.
+template<const size_t D>
+void
+test_swar_arithmetic()
+{
+  constexpr size_t rounds = 1ul << 12;
+  using zq_t = zq::zq_t<D>;
+
+  prng::prng_t prng;
+
+  for (size_t i = 0; i < rounds; i++) {
+    std::array<zq_t, swar::LANES> x{}, y{}, res{};
+    std::array<zq_t, swar::LANES> prod_sum{};
+
+    for (size_t l = 0; l < swar::LANES; l++) {
+      x[l] = zq_t::random_value(prng);
+      y[l] = zq_t::random_value(prng);
+    }
+
+    const auto s = zq_t::random_value(prng);
+    const auto wx = swar::load(x.data());
+    const auto wy = swar::load(y.data());
+
+    swar::store(swar::add(wx, wy), res.data());
+    for (size_t l = 0; l < swar::LANES; l++) {
+      EXPECT_EQ(res[l].to_raw(), (x[l] + y[l]).to_raw());
+    }
+
+    swar::store(swar::sub(wx, wy), res.data());
+    for (size_t l = 0; l < swar::LANES; l++) {
+      EXPECT_EQ(res[l].to_raw(), (x[l] - y[l]).to_raw());
+    }
+
+    swar::store(swar::mul(wx, s.to_raw()), res.data());
+    for (size_t l = 0; l < swar::LANES; l++) {
+      EXPECT_EQ(res[l].to_raw(), (x[l] * s).to_raw());
+    }
+
+    // Accumulate many products, without reducing in between.
+    swar::acc_t acc{};
+    for (size_t k = 0; k < 1344; k++) {
+      const auto t = zq_t::random_value(prng);
+
+      swar::mul_acc(acc, wx, t.to_raw());
+      for (size_t l = 0; l < swar::LANES; l++) {
+        prod_sum[l] += x[l] * t;
+      }
+    }
+
+    swar::store(swar::reduce(acc), res.data());
+    for (size_t l = 0; l < swar::LANES; l++) {
+      EXPECT_EQ(res[l].to_raw(), prod_sum[l].to_raw());
+    }
+  }
+}
+
+TEST(FrodoKEM, SWARArithmetic)
+{
+  test_swar_arithmetic<15>();
+  test_swar_arithmetic<16>();
+}
+
+// Test if, SWAR error sampler produces exactly same result as the scalar one,
+// for every possible 16 -bit random input.
+template<const size_t D, const size_t L, std::array<uint16_t, L> Tχ>
+void
+test_swar_sample()
+{
+  for (uint32_t r = 0; r < (1u << 16); r += swar::LANES) {
+    std::array<zq::zq_t<D>, swar::LANES> res{};
+
+    uint64_t w = 0;
+    for (size_t l = 0; l < swar::LANES; l++) {
+      w |= static_cast<uint64_t>(r + l) << (l * 16);
+    }
+
+    swar::store(swar::sample<L, Tχ>(w), res.data());
+    for (size_t l = 0; l < swar::LANES; l++) {
+      EXPECT_EQ(res[l].to_raw(), (sampling::sample<D, L, Tχ>(static_cast<uint16_t>(r + l))).to_raw());
+    }
+  }
+}
+
+TEST(FrodoKEM, SWARErrorSampling)
+{
+  test_swar_sample<15, 13, sampling::Frodo640_Tχ>();
+  test_swar_sample<16, 11, sampling::Frodo976_Tχ>();
+  test_swar_sample<16, 7, sampling::Frodo1344_Tχ>();
+}